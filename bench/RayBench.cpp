@@ -0,0 +1,132 @@
+#include "CpuRenderer.h"
+#include "Scene.h"
+#include "WideBvh.h"
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Ray throughput of the CPU renderer on every built-in scene with every SIMD level the machine supports, written as
+// JSON like renderer_bench. Every frame traces the primary rays plus the ambient occlusion rays of each hit.
+namespace {
+	constexpr uint32_t         WIDTH{1280};
+	constexpr uint32_t         HEIGHT{720};
+	constexpr uint32_t         DEFAULT_FRAME_COUNT{10};
+	constexpr std::string_view USAGE{
+	        "Usage: ray_bench [options]\n"
+	        "  --frames <n>       frames per case (default 10)\n"
+	        "  --output <file>    JSON results (default ray_bench.json)\n"
+	};
+
+	uint32_t ParseUnsigned(std::string_view option, std::string_view value) {
+		uint32_t result{};
+		const auto [end, errorCode]{std::from_chars(value.data(), value.data() + value.size(), result)};
+
+		if (errorCode != std::errc{} || end != value.data() + value.size() || result == 0)
+			throw std::invalid_argument{std::string{option} + " expects a positive integer, got " + std::string{value}};
+
+		return result;
+	}
+}// namespace
+
+int main(int argc, char **argv) {
+	uint32_t              frameCount{DEFAULT_FRAME_COUNT};
+	std::filesystem::path outputPath{"ray_bench.json"};
+
+	try {
+		for (int i{1}; i < argc; ++i) {
+			const std::string_view option{argv[i]};
+
+			if (option == "--help" || option == "-h") {
+				std::cout << USAGE;
+				return EXIT_SUCCESS;
+			}
+
+			if (i + 1 >= argc)
+				throw std::invalid_argument{"Unknown option or missing value: " + std::string{option}};
+
+			const std::string_view value{argv[++i]};
+			if (option == "--frames") {
+				frameCount = ParseUnsigned(option, value);
+			} else if (option == "--output") {
+				outputPath = value;
+			} else {
+				throw std::invalid_argument{"Unknown option: " + std::string{option}};
+			}
+		}
+	} catch (const std::invalid_argument &exception) {
+		std::cerr << exception.what() << '\n' << USAGE;
+		return EXIT_FAILURE;
+	}
+
+	std::ofstream file{outputPath, std::ios::trunc};
+	if (!file.is_open()) {
+		std::cerr << "Failed to open " << outputPath.string() << '\n';
+		return EXIT_FAILURE;
+	}
+
+	CpuRenderer     renderer{};
+	const SimdLevel supportedLevel{WideBvh::DetectSimdLevel()};
+	bool            firstCase{true};
+
+	file << "{\n  \"cases\": [\n";
+
+	for (const std::string_view sceneName: Scene::NAMES) {
+		renderer.SetScene(Scene::Create(sceneName));
+
+		for (size_t level{0}; level <= static_cast<size_t>(supportedLevel); ++level) {
+			const std::string_view levelName{WideBvh::SIMD_LEVEL_NAMES[level]};
+			renderer.SetSimdLevel(static_cast<SimdLevel>(level));
+
+			std::cout << "Running " << sceneName << '_' << levelName << " for " << frameCount << " frames\n";
+
+			uint64_t rayCount{0};
+			double   milliseconds{0.0};
+			for (uint32_t frame{0}; frame < frameCount; ++frame) {
+				static_cast<void>(renderer.Render(WIDTH, HEIGHT));
+
+				rayCount += renderer.GetStatistics().rayCount;
+				milliseconds += renderer.GetStatistics().renderMilliseconds;
+			}
+
+			const CpuRenderStatistics &statistics{renderer.GetStatistics()};
+			const double               megaraysPerSecond{
+			        milliseconds > 0.0 ? static_cast<double>(rayCount) / milliseconds / 1000.0 : 0.0
+			};
+
+			std::cout << "  " << megaraysPerSecond << " Mrays/s\n";
+
+			file << (firstCase ? "" : ",\n") << "    {\n"
+			     << "      \"scene\": \"" << sceneName << "\",\n"
+			     << "      \"simd\": \"" << levelName << "\",\n"
+			     << "      \"width\": " << WIDTH << ",\n"
+			     << "      \"height\": " << HEIGHT << ",\n"
+			     << "      \"frames\": " << frameCount << ",\n"
+			     << "      \"rays\": " << rayCount << ",\n"
+			     << "      \"ms\": " << milliseconds << ",\n"
+			     << "      \"mrays_per_s\": " << megaraysPerSecond << ",\n"
+			     << "      \"bvh\": {\"triangles\": " << statistics.bvh.triangleCount
+			     << ", \"binary_nodes\": " << statistics.bvh.nodeCount
+			     << ", \"wide_nodes\": " << statistics.wideBvh.nodeCount
+			     << ", \"blocks\": " << statistics.wideBvh.blockCount
+			     << ", \"block_occupancy\": " << statistics.wideBvh.blockOccupancy
+			     << ", \"build_ms\": " << statistics.bvh.buildMilliseconds + statistics.wideBvh.buildMilliseconds
+			     << "},\n"
+			     << "      \"tiles\": {\"count\": " << statistics.tiles.tileCount
+			     << ", \"stolen\": " << statistics.tiles.stolenCount
+			     << ", \"imbalance\": " << statistics.tiles.imbalance << "}\n"
+			     << "    }";
+			firstCase = false;
+		}
+	}
+
+	file << "\n  ],\n  \"threads\": " << renderer.GetThreadCount() << "\n}\n";
+
+	std::cout << "Wrote " << outputPath.string() << '\n';
+
+	return EXIT_SUCCESS;
+}
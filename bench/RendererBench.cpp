@@ -0,0 +1,230 @@
+#include "Application.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Runs every built-in scene headlessly at fixed resolutions with every GPU renderer and writes the results as JSON, so
+// numbers from different commits can be diffed directly. Every case starts from an empty pipeline cache of its own, so
+// the pipeline numbers are always cold compiles no matter which cases or runs came before.
+namespace {
+	struct BenchCase {
+		std::string_view scene{};
+		uint32_t         width{};
+		uint32_t         height{};
+		// Moves the instances every frame, so the TLAS is refitted and periodically rebuilt
+		bool animate{false};
+	};
+
+	constexpr std::array<BenchCase, 7> BENCH_CASES{
+	        BenchCase{"quad", 1280, 720},
+	        BenchCase{"quad", 1920, 1080},
+	        BenchCase{"instances", 1280, 720},
+	        BenchCase{"instances", 1920, 1080},
+	        BenchCase{"instances", 1280, 720, true},
+	        BenchCase{"mesh", 1280, 720},
+	        BenchCase{"mesh", 1920, 1080}
+	};
+
+	constexpr uint32_t         DEFAULT_FRAME_COUNT{300};
+	constexpr std::string_view USAGE{
+	        "Usage: renderer_bench [options]\n"
+	        "  --frames <n>       frames per case (default 300)\n"
+	        "  --output <file>    JSON results (default renderer_bench.json)\n"
+	        "  --shader-dir <dir> load .spv files from <dir> instead of the embedded ones\n"
+	        "  --device <name>    Vulkan device name substring or UUID, e.g. llvmpipe\n"
+	        "  --renderer <name>  only run raster or rt, devices without ray tracing need raster\n"
+	};
+
+	void WriteTiming(std::ostream &ostream, const TimingStatistics &timing) {
+		ostream << "{\"samples\": " << timing.sampleCount << ", \"mean_ms\": " << timing.meanMilliseconds
+		        << ", \"p50_ms\": " << timing.p50Milliseconds << ", \"p95_ms\": " << timing.p95Milliseconds
+		        << ", \"p99_ms\": " << timing.p99Milliseconds << ", \"max_ms\": " << timing.maxMilliseconds << '}';
+	}
+
+	void WriteCase(
+	        std::ostream &ostream, const BenchCase &benchCase, std::string_view renderer, uint32_t frameCount,
+	        const RunMetrics &metrics
+	) {
+		const double uploadSeconds{metrics.uploadMilliseconds / 1000.0};
+		const double uploadMegabytesPerSecond{
+		        uploadSeconds > 0.0 ? static_cast<double>(metrics.uploadBytes) / (1024.0 * 1024.0) / uploadSeconds : 0.0
+		};
+
+		ostream << "    {\n"
+		        << "      \"scene\": \"" << benchCase.scene << "\",\n"
+		        << "      \"renderer\": \"" << renderer << "\",\n"
+		        << "      \"animated\": " << (benchCase.animate ? "true" : "false") << ",\n"
+		        << "      \"width\": " << benchCase.width << ",\n"
+		        << "      \"height\": " << benchCase.height << ",\n"
+		        << "      \"frames\": " << frameCount << ",\n"
+		        << "      \"timers\": {";
+
+		for (size_t i{0}; i < metrics.timings.size(); ++i) {
+			ostream << (i == 0 ? "\n" : ",\n") << "        \"" << metrics.timings[i].name << "\": ";
+			WriteTiming(ostream, metrics.timings[i]);
+		}
+
+		ostream << "\n      },\n"
+		        << "      \"upload\": {\"bytes\": " << metrics.uploadBytes << ", \"ms\": " << metrics.uploadMilliseconds
+		        << ", \"mib_per_s\": " << uploadMegabytesPerSecond << "},\n"
+		        << "      \"pipelines\": {\"count\": " << metrics.pipelineCache.pipelineCount
+		        << ", \"cache_hits\": " << metrics.pipelineCache.cacheHits
+		        << ", \"cache_unknown\": " << metrics.pipelineCache.unknownCount << ", \"ms\": "
+		        << metrics.pipelineCache.hitMilliseconds + metrics.pipelineCache.missMilliseconds +
+		                   metrics.pipelineCache.unknownMilliseconds
+		        << "},\n"
+		        << "      \"memory\": {\"peak_used_bytes\": " << metrics.memory.peakUsedBytes
+		        << ", \"reserved_bytes\": " << metrics.memory.reservedBytes
+		        << ", \"block_count\": " << metrics.memory.blockCount << "},\n"
+		        << "      \"blas\": {\"count\": " << metrics.blas.blasCount
+		        << ", \"build_ms\": " << metrics.blas.buildMilliseconds
+		        << ", \"compact_ms\": " << metrics.blas.compactMilliseconds
+		        << ", \"uncompacted_bytes\": " << metrics.blas.uncompactedBytes
+		        << ", \"compacted_bytes\": " << metrics.blas.compactedBytes << "},\n"
+		        << "      \"tlas\": {\"instances\": " << metrics.tlas.instanceCount
+		        << ", \"rebuilds\": " << metrics.tlas.rebuildCount << ", \"refits\": " << metrics.tlas.refitCount
+		        << "}\n"
+		        << "    }";
+	}
+
+	uint32_t ParseUnsigned(std::string_view option, std::string_view value) {
+		uint32_t result{};
+		const auto [end, errorCode]{std::from_chars(value.data(), value.data() + value.size(), result)};
+
+		if (errorCode != std::errc{} || end != value.data() + value.size() || result == 0)
+			throw std::invalid_argument{std::string{option} + " expects a positive integer, got " + std::string{value}};
+
+		return result;
+	}
+}// namespace
+
+int main(int argc, char **argv) {
+	uint32_t                             frameCount{DEFAULT_FRAME_COUNT};
+	std::filesystem::path                outputPath{"renderer_bench.json"};
+	std::optional<std::filesystem::path> shaderDirectory{};
+	std::string                          device{};
+	std::optional<Renderer>              onlyRenderer{};
+
+	try {
+		for (int i{1}; i < argc; ++i) {
+			const std::string_view option{argv[i]};
+
+			if (option == "--help" || option == "-h") {
+				std::cout << USAGE;
+				return EXIT_SUCCESS;
+			}
+
+			if (i + 1 >= argc)
+				throw std::invalid_argument{"Unknown option or missing value: " + std::string{option}};
+
+			const std::string_view value{argv[++i]};
+			if (option == "--frames") {
+				frameCount = ParseUnsigned(option, value);
+			} else if (option == "--output") {
+				outputPath = value;
+			} else if (option == "--shader-dir") {
+				shaderDirectory = value;
+			} else if (option == "--device") {
+				device = value;
+			} else if (option == "--renderer") {
+				const auto rendererIterator{std::find_if(
+				        ApplicationConfig::RENDERER_NAMES.cbegin(), ApplicationConfig::RENDERER_NAMES.cend(),
+				        [value](const auto &renderer) { return renderer.first == value; }
+				)};
+
+				if (rendererIterator == ApplicationConfig::RENDERER_NAMES.cend() ||
+				    rendererIterator->second == Renderer::Cpu)
+					throw std::invalid_argument{"Unknown renderer: " + std::string{value}};
+
+				onlyRenderer = rendererIterator->second;
+			} else {
+				throw std::invalid_argument{"Unknown option: " + std::string{option}};
+			}
+		}
+	} catch (const std::invalid_argument &exception) {
+		std::cerr << exception.what() << '\n' << USAGE;
+		return EXIT_FAILURE;
+	}
+
+	std::ofstream file{outputPath, std::ios::trunc};
+	if (!file.is_open()) {
+		std::cerr << "Failed to open " << outputPath.string() << '\n';
+		return EXIT_FAILURE;
+	}
+
+	std::string deviceName{};
+	bool        firstCase{true};
+
+	file << "{\n  \"cases\": [\n";
+
+	for (const BenchCase &benchCase: BENCH_CASES) {
+		// Both renderers draw the same scene, so their main_pass timings compare directly
+		for (const auto &[rendererName, renderer]: ApplicationConfig::RENDERER_NAMES) {
+			// Hundreds of CPU frames per case would take longer than the whole GPU bench
+			if (renderer == Renderer::Cpu || (onlyRenderer.has_value() && renderer != *onlyRenderer))
+				continue;
+
+			const std::string caseName{
+			        std::string{benchCase.scene} + '_' + std::string{rendererName} + '_' +
+			        std::to_string(benchCase.width) + 'x' + std::to_string(benchCase.height) +
+			        (benchCase.animate ? "_animated" : "")
+			};
+
+			// A cache left behind by an earlier, aborted run would make this case warm
+			const std::filesystem::path pipelineCachePath{
+			        std::filesystem::temp_directory_path() / ("renderer_bench_pipeline_cache_" + caseName + ".bin")
+			};
+			std::error_code errorCode{};
+			std::filesystem::remove(pipelineCachePath, errorCode);
+
+			// The last frame of every case is kept around for eyeballing regressions
+			ApplicationConfig config{};
+			config.headless          = true;
+			config.frameCount        = frameCount;
+			config.width             = benchCase.width;
+			config.height            = benchCase.height;
+			config.scene             = benchCase.scene;
+			config.renderer          = renderer;
+			config.animate           = benchCase.animate;
+			config.outputPath        = caseName + ".ppm";
+			config.shaderDirectory   = shaderDirectory;
+			config.device            = device;
+			config.pipelineCachePath = pipelineCachePath;
+
+			std::cout << "Running " << caseName << " for " << frameCount << " frames\n";
+
+			// The constructor loads the scene, so it can throw as well as Run
+			RunMetrics metrics{};
+			try {
+				Application application{std::move(config)};
+				application.Run();
+				metrics = application.GetMetrics();
+			} catch (const std::exception &exception) {
+				std::cerr << exception.what() << '\n';
+				return EXIT_FAILURE;
+			}
+
+			std::filesystem::remove(pipelineCachePath, errorCode);
+
+			deviceName = metrics.deviceName;
+
+			file << (firstCase ? "" : ",\n");
+			WriteCase(file, benchCase, rendererName, frameCount, metrics);
+			firstCase = false;
+		}
+	}
+
+	file << "\n  ],\n  \"device\": \"" << deviceName << "\"\n}\n";
+
+	std::cout << "Wrote " << outputPath.string() << '\n';
+
+	return EXIT_SUCCESS;
+}
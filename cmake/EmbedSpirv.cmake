@@ -0,0 +1,33 @@
+# Turns a SPIR-V binary into a header holding it as a uint32_t array.
+# Usage: cmake -DINPUT=<file.spv> -DOUTPUT=<file.spv.h> -DIDENTIFIER=<c identifier> -P EmbedSpirv.cmake
+
+file(READ "${INPUT}" SPIRV_HEX HEX)
+
+string(LENGTH "${SPIRV_HEX}" SPIRV_HEX_LENGTH)
+math(EXPR SPIRV_WORD_REMAINDER "${SPIRV_HEX_LENGTH} % 8")
+if (NOT SPIRV_WORD_REMAINDER EQUAL 0)
+    message(FATAL_ERROR "${INPUT} is not a whole number of 32-bit words")
+endif ()
+
+# SPIR-V words are little-endian on disk, swap every group of 4 bytes into a uint32_t literal
+string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1u, " SPIRV_WORDS "${SPIRV_HEX}")
+# CMake regexes have no {n} quantifier, spell out 8 words per line
+set(WORD "0x[0-9a-f]+u, ")
+string(REGEX REPLACE "(${WORD}${WORD}${WORD}${WORD}${WORD}${WORD}${WORD}${WORD})" "\\1\n        " SPIRV_WORDS
+       "${SPIRV_WORDS}")
+
+get_filename_component(INPUT_NAME "${INPUT}" NAME)
+
+file(WRITE "${OUTPUT}.tmp" "// Generated by cmake/EmbedSpirv.cmake from ${INPUT_NAME}, do not edit.
+#pragma once
+
+#include <cstdint>
+
+alignas(4) inline constexpr uint32_t ${IDENTIFIER}[]{
+        ${SPIRV_WORDS}
+};
+")
+
+# Only touch the header when its contents change, so unchanged shaders don't trigger recompiles
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different "${OUTPUT}.tmp" "${OUTPUT}")
+file(REMOVE "${OUTPUT}.tmp")
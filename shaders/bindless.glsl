@@ -0,0 +1,27 @@
+// The BindlessTable descriptor set, shared by every shader that reads resources through handles. Bindings have to
+// match BindlessResource, a handle is only valid in the array of the resource type it was added as. Handles arrive
+// through push constants, so indexing stays dynamically uniform and needs no nonuniformEXT.
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Storage buffers are declared once per element type, all of them alias the same array
+layout (set = 0, binding = 0, std430) readonly buffer BindlessFloatBuffer {
+    float values[];
+} floatBuffers[];
+
+layout (set = 0, binding = 0, std430) readonly buffer BindlessUintBuffer {
+    uint values[];
+} uintBuffers[];
+
+layout (set = 0, binding = 1) uniform texture2D sampledImages[];
+
+// Same for storage images and their formats
+layout (set = 0, binding = 2, rgba16f) uniform image2D storageImagesRgba16f[];
+layout (set = 0, binding = 2, rgba32f) uniform image2D storageImagesRgba32f[];
+
+// Only present in the layout where the device supports ray tracing
+#ifdef BINDLESS_ACCELERATION_STRUCTURES
+layout (set = 0, binding = 3) uniform accelerationStructureEXT accelerationStructures[];
+#endif
+
+// Linear filtering with repeat addressing, combine as sampler2D(sampledImages[handle], linearSampler)
+layout (set = 0, binding = 4) uniform sampler linearSampler;
@@ -1,11 +1,32 @@
 #version 450
 
-layout (location = 0) in vec2 inPosition;
+// z in [-1, 1] maps to depth [0, 1], the same front to back order the ray tracers see shooting from z = -1
+layout (location = 0) in vec3 inPosition;
 layout (location = 1) in vec3 inColor;
 
 layout (location = 0) out vec3 fragColor;
 
+// Instances are spread over a gridSize x gridSize grid, a grid of 1 leaves the geometry untouched. A non-zero time
+// bobs them inside their cells like Scene::GetInstanceTransform
+layout (push_constant) uniform InstanceGrid {
+    uint gridSize;
+    float time;
+} instanceGrid;
+
+// Scene::ANIMATION_AMPLITUDE, ANIMATION_ANGULAR_SPEED and ANIMATION_PHASE_STEP
+const float ANIMATION_AMPLITUDE = 0.25;
+const float ANIMATION_ANGULAR_SPEED = 3.0;
+const float ANIMATION_PHASE_STEP = 0.7;
+
 void main() {
-    gl_Position = vec4(inPosition, 0.0, 1.0);
+    float cellSize = 2.0 / float(instanceGrid.gridSize);
+    vec2 cell = vec2(gl_InstanceIndex % instanceGrid.gridSize, gl_InstanceIndex / instanceGrid.gridSize);
+    vec2 cellCenter = -1.0 + cellSize * (cell + 0.5);
+
+    float phase = ANIMATION_PHASE_STEP * float(gl_InstanceIndex);
+    float sway = sin(ANIMATION_ANGULAR_SPEED * instanceGrid.time + phase) - sin(phase);
+    cellCenter.y += ANIMATION_AMPLITUDE * cellSize * sway;
+
+    gl_Position = vec4(cellCenter + inPosition.xy * cellSize * 0.5, inPosition.z * 0.5 + 0.5, 1.0);
     fragColor = inColor;
-}
\ No newline at end of file
+}
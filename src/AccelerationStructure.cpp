@@ -0,0 +1,53 @@
+#include "AccelerationStructure.h"
+#include <stdexcept>
+#include <string>
+#include <vulkan/vk_enum_string_helper.h>
+
+AccelerationStructure CreateAccelerationStructure(
+        VkDevice device, MemoryAllocator &allocator, const RayTracingFunctions &functions,
+        VkAccelerationStructureTypeKHR type, VkDeviceSize size
+) {
+	AccelerationStructure accelerationStructure{};
+	accelerationStructure.size = size;
+
+	allocator.CreateBuffer(
+	        size, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+	        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, accelerationStructure.buffer, accelerationStructure.allocation
+	);
+
+	VkAccelerationStructureCreateInfoKHR createInfo{};
+	createInfo.sType  = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
+	createInfo.buffer = accelerationStructure.buffer;
+	createInfo.offset = 0;
+	createInfo.size   = size;
+	createInfo.type   = type;
+
+	if (const VkResult result{functions.vkCreateAccelerationStructureKHR(
+	            device, &createInfo, nullptr, &accelerationStructure.handle
+	    )};
+	    result != VK_SUCCESS) {
+		allocator.DestroyBuffer(accelerationStructure.buffer, accelerationStructure.allocation);
+		throw std::runtime_error{std::string{"Failed to create acceleration structure: "} + string_VkResult(result)};
+	}
+
+	VkAccelerationStructureDeviceAddressInfoKHR addressInfo{};
+	addressInfo.sType                 = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR;
+	addressInfo.accelerationStructure = accelerationStructure.handle;
+
+	accelerationStructure.deviceAddress = functions.vkGetAccelerationStructureDeviceAddressKHR(device, &addressInfo);
+
+	return accelerationStructure;
+}
+
+void DestroyAccelerationStructure(
+        VkDevice device, MemoryAllocator &allocator, const RayTracingFunctions &functions,
+        AccelerationStructure &accelerationStructure
+) {
+	if (accelerationStructure.handle == VK_NULL_HANDLE)
+		return;
+
+	functions.vkDestroyAccelerationStructureKHR(device, accelerationStructure.handle, nullptr);
+	allocator.DestroyBuffer(accelerationStructure.buffer, accelerationStructure.allocation);
+
+	accelerationStructure = {};
+}
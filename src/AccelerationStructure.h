@@ -0,0 +1,29 @@
+#ifndef PORTAL2RAYTRACED_ACCELERATIONSTRUCTURE_H
+#define PORTAL2RAYTRACED_ACCELERATIONSTRUCTURE_H
+
+#include "MemoryAllocator.h"
+#include "RayTracingFunctions.h"
+#include <vulkan/vulkan.h>
+
+// An acceleration structure together with the buffer backing it.
+struct AccelerationStructure {
+	VkAccelerationStructureKHR handle{VK_NULL_HANDLE};
+	VkBuffer                   buffer{};
+	Allocation                 allocation{};
+	VkDeviceAddress            deviceAddress{};
+	VkDeviceSize               size{};
+};
+
+[[nodiscard]]
+AccelerationStructure CreateAccelerationStructure(
+        VkDevice device, MemoryAllocator &allocator, const RayTracingFunctions &functions,
+        VkAccelerationStructureTypeKHR type, VkDeviceSize size
+);
+
+void DestroyAccelerationStructure(
+        VkDevice device, MemoryAllocator &allocator, const RayTracingFunctions &functions,
+        AccelerationStructure &accelerationStructure
+);
+
+
+#endif//PORTAL2RAYTRACED_ACCELERATIONSTRUCTURE_H
@@ -0,0 +1,17 @@
+#ifndef PORTAL2RAYTRACED_ALIGNMENT_H
+#define PORTAL2RAYTRACED_ALIGNMENT_H
+
+#include <cstdint>
+
+// Rounds value up to the next multiple of alignment, which does not have to be a power of two. Vulkan reports 0 for
+// some alignments it does not care about, value is returned unchanged then.
+[[nodiscard]]
+constexpr uint64_t AlignUp(uint64_t value, uint64_t alignment) noexcept {
+	if (alignment == 0)
+		return value;
+
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+
+#endif//PORTAL2RAYTRACED_ALIGNMENT_H
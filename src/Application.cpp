@@ -1,21 +1,54 @@
 #include "Application.h"
+#include "Alignment.h"
+#include "ImageWriter.h"
+#include "MeshLoader.h"
 #include <algorithm>
 #include <array>
+#include <cctype>
+#include <chrono>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
-#include <fstream>
 #include <iostream>
 #include <iterator>
 #include <limits>
 #include <set>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <vector>
 #include <vulkan/vk_enum_string_helper.h>
 
+Application::Application(ApplicationConfig config)
+    : m_Config{std::move(config)} {
+	if (CookedScene::IsCookedSceneFile(m_Config.scene)) {
+		// Stays mapped, the buffers are uploaded and RunCpu's BVH is traced straight from it
+		m_CookedScene = CookedScene{m_Config.scene};
+		m_Scene       = m_CookedScene.GetScene();
+
+		std::cout << m_CookedScene.GetStatistics() << '\n';
+	} else if (MeshLoader::IsMeshFile(m_Config.scene)) {
+		MeshLoader loader{m_ThreadPool};
+		m_Scene = loader.Load(m_Config.scene);
+
+		std::cout << loader.GetStatistics() << '\n';
+	} else {
+		m_Scene = Scene::Create(m_Config.scene);
+	}
+
+	m_SceneStreams = m_CookedScene.IsOpen() ? m_CookedScene.GetStreams() : m_Scene.GetStreams();
+}
+
 void Application::Run() {
-	InitWindow();
+	if (m_Config.renderer == Renderer::Cpu) {
+		RunCpu();
+		return;
+	}
+
+	if (!m_Config.headless)
+		InitWindow();
+
 	InitVulkan();
 	MainLoop();
 	Cleanup();
@@ -25,31 +58,110 @@ void Application::InitWindow() {
 	glfwInit();
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 
-	m_pWindow = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_TITLE.data(), nullptr, nullptr);
+	m_pWindow = glfwCreateWindow(
+	        static_cast<int>(m_Config.width), static_cast<int>(m_Config.height), WINDOW_TITLE.data(), nullptr, nullptr
+	);
 	glfwSetWindowUserPointer(m_pWindow, this);
 	glfwSetFramebufferSizeCallback(m_pWindow, FramebufferResizeCallback);
 }
 
 void Application::InitVulkan() {
+	if (m_Config.shaderDirectory.has_value()) {
+		m_ShaderLibrary.Init(m_Config.shaderDirectory);
+	} else if (const char *shaderDirectory{std::getenv(SHADER_DIRECTORY_VARIABLE)}; shaderDirectory != nullptr) {
+		m_ShaderLibrary.Init(shaderDirectory);
+	} else {
+		m_ShaderLibrary.Init(std::nullopt);
+	}
+
 	CreateInstance();
 	SetupDebugMessenger();
-	CreateSurface();
+
+	if (!m_Config.headless)
+		CreateSurface();
+
 	PickPhysicalDevice();
 	CreateLogicalDevice();
-	CreateSwapChain();
+	// The TLAS instances of every frame are written into the ring as well
+	m_FrameRing.Init(
+	        m_PhysicalDevice, m_Allocator, m_Config.framesInFlight, m_RayTracingEnabled,
+	        FrameRingBuffer::DEFAULT_REGION_SIZE +
+	                (m_RayTracingEnabled ? TlasManager::GetFrameDataSize(m_Scene.instanceCount) : 0)
+	);
+	m_Profiler.Init(
+	        m_PhysicalDevice, m_Device, FindQueueFamilies(m_PhysicalDevice).graphicsFamily.value(),
+	        m_Config.framesInFlight
+	);
+	m_PipelineCache.Init(m_PhysicalDevice, m_Device, m_Config.pipelineCachePath, m_PipelineCreationFeedback);
+	m_PipelineBuilder.Init(m_Device, m_ThreadPool, m_PipelineCache, m_ShaderLibrary, m_RayTracingFunctions);
+	if (m_Config.headless) {
+		CreateOffscreenTargets();
+	} else {
+		CreateSwapChain();
+	}
+
 	CreateImageViews();
+	CreateDepthResources();
 	CreateRenderPass();
 	CreateGraphicsPipeline();
+
+	if (m_Config.renderer == Renderer::RayTracing) {
+		m_RayTracingPass.Init(
+		        m_PhysicalDevice, m_Device, m_Allocator, m_RayTracingFunctions, m_PipelineBuilder, m_BindlessTable,
+		        m_DeletionQueue, m_SwapChainExtent
+		);
+		m_RayTracingPass.ConfigureAccumulation(m_Config.progressive, m_Config.targetSamplesPerPixel);
+	}
+
 	CreateFramebuffers();
 	CreateCommandPool();
+
+	const auto uploadStart{std::chrono::steady_clock::now()};
 	CreateVertexBuffer();
 	CreateIndexBuffer();
+	m_SceneUploadTicket = m_UploadManager.Flush();
+	m_UploadManager.Wait(m_SceneUploadTicket);
+
+	const std::chrono::duration<double, std::milli> uploadTime{std::chrono::steady_clock::now() - uploadStart};
+	m_Metrics.uploadBytes        = m_SceneStreams.GetVertexBufferSize() + m_SceneStreams.GetIndexBufferSize();
+	m_Metrics.uploadMilliseconds = uploadTime.count();
+
+	if (m_RayTracingEnabled) {
+		CreateBottomLevelAccelerationStructures();
+		CreateTopLevelAccelerationStructure();
+	}
+
 	CreateCommandBuffers();
 	CreateSyncObjects();
+
+	m_PipelineBuilder.WaitAll();
+	m_GraphicsPipeline = m_GraphicsPipelineFuture.get();
+
+	if (m_Config.renderer == Renderer::RayTracing) {
+		m_RayTracingPass.FinishPipeline();
+		m_RayTracingPass.UpdateDescriptors(
+		        m_TlasManager.Get(), m_VertexBuffer, m_IndexBuffer, m_SceneStreams.GetIndexType()
+		);
+	}
+
+	m_PipelineBuilder.Cleanup();
 }
 
 void Application::MainLoop() {
-	while (!glfwWindowShouldClose(m_pWindow)) {
+	if (m_Config.headless) {
+		for (uint32_t frame{0}; frame < m_Config.frameCount; ++frame) {
+			DrawFrame();
+		}
+
+		vkDeviceWaitIdle(m_Device);
+		ReadbackOffscreenImage();
+		return;
+	}
+
+	uint32_t frame{0};
+	while (!glfwWindowShouldClose(m_pWindow) && (m_Config.frameCount == 0 || frame++ < m_Config.frameCount)) {
+		// Paced before polling, so input is as fresh as possible when the frame is recorded
+		m_FramePacer.BeginFrame(m_FrameTimeline, m_Profiler);
 		glfwPollEvents();
 		DrawFrame();
 	}
@@ -58,58 +170,125 @@ void Application::MainLoop() {
 }
 
 void Application::DrawFrame() {
-	vkWaitForFences(m_Device, 1, &m_InFlightFences[m_CurrentFrame], VK_TRUE, UINT64_MAX);
+	// Until the size settled the current swap chain keeps presenting, scaled to the window
+	if (m_FramebufferResized && std::chrono::steady_clock::now() - m_LastFramebufferResize >= RESIZE_SETTLE_TIME) {
+		m_FramebufferResized = false;
+		RecreateSwapChain();
+	}
 
-	uint32_t imageIndex{};
-	if (const VkResult result{vkAcquireNextImageKHR(
-	            m_Device, m_SwapChain, UINT64_MAX, m_ImageAvailableSemaphores[m_CurrentFrame], VK_NULL_HANDLE,
-	            &imageIndex
-	    )};
-	    result != VK_SUCCESS) {
-		if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-			RecreateSwapChain();
-			return;
-		}
+	{
+		const auto waitScope{m_Profiler.ScopeCpu("cpu/wait_frame")};
+		m_CurrentFrame = m_FrameTimeline.BeginFrame();
+	}
 
-		if (result != VK_SUBOPTIMAL_KHR) {
-			throw std::runtime_error{
-			        std::string{"Failed to acquire swap chain image from swapchain: "} + string_VkResult(result)
-			};
+	m_DeletionQueue.Collect(m_FrameTimeline.GetCompletedValue());
+
+	m_Profiler.BeginFrame(m_CurrentFrame);
+
+	// Offscreen there is one target image per frame in flight, so the frame slot doubles as the image index
+	uint32_t imageIndex{m_CurrentFrame};
+	if (!m_Config.headless) {
+		const auto acquireScope{m_Profiler.ScopeCpu("cpu/acquire")};
+
+		if (const VkResult result{vkAcquireNextImageKHR(
+		            m_Device, m_SwapChain, UINT64_MAX, m_ImageAvailableSemaphores[m_CurrentFrame], VK_NULL_HANDLE,
+		            &imageIndex
+		    )};
+		    result != VK_SUCCESS) {
+			if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+				m_FramebufferResized = false;
+				RecreateSwapChain();
+				return;
+			}
+
+			if (result != VK_SUBOPTIMAL_KHR) {
+				throw std::runtime_error{
+				        std::string{"Failed to acquire swap chain image from swapchain: "} + string_VkResult(result)
+				};
+			}
 		}
 	}
 
-	vkResetFences(m_Device, 1, &m_InFlightFences[m_CurrentFrame]);
+	m_UploadManager.CollectGarbage();
+	m_FrameRing.BeginFrame(m_CurrentFrame);
 
-	vkResetCommandBuffer(m_CommandBuffers[m_CurrentFrame], 0);
+	VkCommandBuffer commandBuffer{};
+	{
+		const auto recordScope{m_Profiler.ScopeCpu("cpu/record")};
 
-	RecordCommandBuffer(m_CommandBuffers[m_CurrentFrame], imageIndex);
+		commandBuffer = m_CommandRecorder.BeginFrame(m_CurrentFrame);
+		RecordCommandBuffer(commandBuffer, imageIndex);
+	}
 
 	VkSubmitInfo submitInfo{};
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-	std::array<VkSemaphore, 1>          waitSemaphores{m_ImageAvailableSemaphores[m_CurrentFrame]};
-	std::array<VkPipelineStageFlags, 1> waitStages{VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+	std::array<VkSemaphore, 2>          waitSemaphores{};
+	std::array<uint64_t, 2>             waitValues{};
+	std::array<VkPipelineStageFlags, 2> waitStages{};
+	uint32_t                            waitSemaphoreCount{0};
+
+	// Uploads still in flight are waited for on the GPU instead of stalling the CPU, any command may read them
+	if (const UploadTicket uploadTicket{m_UploadManager.GetLastTicket()};
+	    uploadTicket != 0 && !m_UploadManager.IsComplete(uploadTicket)) {
+		waitSemaphores[waitSemaphoreCount] = m_UploadManager.GetTimeline();
+		waitValues[waitSemaphoreCount]     = uploadTicket;
+		waitStages[waitSemaphoreCount]     = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		++waitSemaphoreCount;
+	}
 
-	submitInfo.waitSemaphoreCount = waitSemaphores.size();
-	submitInfo.pWaitSemaphores    = waitSemaphores.data();
-	submitInfo.pWaitDstStageMask  = waitStages.data();
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers    = &m_CommandBuffers[m_CurrentFrame];
+	// Offscreen frames have no swap chain image to wait for and nothing to present. The ray tracing pass first touches
+	// the swap chain image with its blit
+	if (!m_Config.headless) {
+		waitSemaphores[waitSemaphoreCount] = m_ImageAvailableSemaphores[m_CurrentFrame];
+		waitStages[waitSemaphoreCount]     = m_Config.renderer == Renderer::RayTracing
+		                                           ? VK_PIPELINE_STAGE_TRANSFER_BIT
+		                                           : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		++waitSemaphoreCount;
+	}
 
-	std::array<VkSemaphore, 1> signalSemaphores{m_RenderFinishedSemaphores[m_CurrentFrame]};
-	submitInfo.signalSemaphoreCount = signalSemaphores.size();
+	// The second value is ignored, the render finished semaphore is binary
+	const std::array<VkSemaphore, 2> signalSemaphores{
+	        m_FrameTimeline.GetSemaphore(),
+	        m_Config.headless ? VK_NULL_HANDLE : m_RenderFinishedSemaphores[m_CurrentFrame]
+	};
+	const std::array<uint64_t, 2> signalValues{m_FrameTimeline.GetFrameValue(), 0};
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+	timelineInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.waitSemaphoreValueCount   = waitSemaphoreCount;
+	timelineInfo.pWaitSemaphoreValues      = waitValues.data();
+	timelineInfo.signalSemaphoreValueCount = m_Config.headless ? 1u : 2u;
+	timelineInfo.pSignalSemaphoreValues    = signalValues.data();
+
+	submitInfo.pNext                = &timelineInfo;
+	submitInfo.waitSemaphoreCount   = waitSemaphoreCount;
+	submitInfo.pWaitSemaphores      = waitSemaphores.data();
+	submitInfo.pWaitDstStageMask    = waitStages.data();
+	submitInfo.commandBufferCount   = 1;
+	submitInfo.pCommandBuffers      = &commandBuffer;
+	submitInfo.signalSemaphoreCount = timelineInfo.signalSemaphoreValueCount;
 	submitInfo.pSignalSemaphores    = signalSemaphores.data();
 
-	if (const VkResult result{vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, m_InFlightFences[m_CurrentFrame])};
-	    result != VK_SUCCESS) {
-		throw std::runtime_error{std::string{"Failed to submit draw command buffer: "} + string_VkResult(result)};
+	{
+		const auto submitScope{m_Profiler.ScopeCpu("cpu/submit")};
+
+		if (const VkResult result{vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE)};
+		    result != VK_SUCCESS) {
+			throw std::runtime_error{std::string{"Failed to submit draw command buffer: "} + string_VkResult(result)};
+		}
 	}
 
+	m_FrameTimeline.EndFrame();
+
+	if (m_Config.headless)
+		return;
+
 	VkPresentInfoKHR presentInfo{};
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
-	presentInfo.waitSemaphoreCount = signalSemaphores.size();
-	presentInfo.pWaitSemaphores    = signalSemaphores.data();
+	presentInfo.waitSemaphoreCount = 1;
+	presentInfo.pWaitSemaphores    = &m_RenderFinishedSemaphores[m_CurrentFrame];
 
 	std::array<VkSwapchainKHR, 1> swapChains{m_SwapChain};
 	presentInfo.swapchainCount = swapChains.size();
@@ -117,54 +296,167 @@ void Application::DrawFrame() {
 	presentInfo.pImageIndices  = &imageIndex;
 	presentInfo.pResults       = nullptr;
 
-	if (const VkResult result{vkQueuePresentKHR(m_PresentQueue, &presentInfo)}; result != VK_SUCCESS) {
-		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_FramebufferResized) {
-			m_FramebufferResized = false;
-			RecreateSwapChain();
-		} else {
-			throw std::runtime_error{std::string{"Failed to present swap chain image: "} + string_VkResult(result)};
-		}
+	VkPresentIdKHR presentId{};
+	m_FramePacer.AddPresentId(m_SwapChain, presentInfo, presentId);
+
+	VkResult presentResult;
+	{
+		const auto presentScope{m_Profiler.ScopeCpu("cpu/present")};
+		presentResult = vkQueuePresentKHR(m_PresentQueue, &presentInfo);
 	}
 
-	m_CurrentFrame = (m_CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+	if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR) {
+		// Left to the next DrawFrame, its acquire recreates an out of date swap chain right away. Only the first
+		// report starts the settle time, a swap chain that stays suboptimal would otherwise never be recreated
+		if (!m_FramebufferResized) {
+			m_FramebufferResized    = true;
+			m_LastFramebufferResize = std::chrono::steady_clock::now();
+		}
+	} else if (presentResult != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to present swap chain image: "} + string_VkResult(presentResult)};
+	}
 }
 
 void Application::Cleanup() {
-	for (size_t i{0}; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+	// MainLoop left the device idle
+	m_DeletionQueue.Cleanup();
+
+	for (size_t i{0}; i < m_ImageAvailableSemaphores.size(); ++i) {
 		vkDestroySemaphore(m_Device, m_ImageAvailableSemaphores[i], nullptr);
 		vkDestroySemaphore(m_Device, m_RenderFinishedSemaphores[i], nullptr);
-		vkDestroyFence(m_Device, m_InFlightFences[i], nullptr);
 	}
 
+	m_FrameTimeline.Cleanup();
+
+	m_CommandRecorder.Cleanup();
 	vkDestroyCommandPool(m_Device, m_CommandPool, nullptr);
 
 	CleanupSwapChain();
 
-	vkDestroyBuffer(m_Device, m_IndexBuffer, nullptr);
-	vkFreeMemory(m_Device, m_IndexBufferMemory, nullptr);
+	m_UploadManager.Cleanup();
+	m_FrameRing.Cleanup();
+
+	if (m_RayTracingEnabled) {
+		m_TlasManager.Cleanup();
+		m_BlasBuilder.Cleanup();
+	}
 
-	vkDestroyBuffer(m_Device, m_VertexBuffer, nullptr);
-	vkFreeMemory(m_Device, m_VertexBufferMemory, nullptr);
+	DestroyBuffer(m_IndexBuffer, m_IndexBufferAllocation);
+	DestroyBuffer(m_VertexBuffer, m_VertexBufferAllocation);
 
 	vkDestroyPipeline(m_Device, m_GraphicsPipeline, nullptr);
 
+	if (m_Config.renderer == Renderer::RayTracing)
+		m_RayTracingPass.Cleanup();
+
+	m_PipelineBuilder.Cleanup();
+	m_PipelineCache.Cleanup();
+
 	vkDestroyPipelineLayout(m_Device, m_PipelineLayout, nullptr);
 
+	// Only after the deletion queue, retired resources still hand their handles back
+	if (m_Config.renderer == Renderer::RayTracing)
+		m_BindlessTable.Cleanup();
+
 	vkDestroyRenderPass(m_Device, m_RenderPass, nullptr);
 
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(m_PhysicalDevice, &deviceProperties);
+
+	m_Metrics.deviceName    = deviceProperties.deviceName;
+	m_Metrics.timings       = m_Profiler.GetStatistics();
+	m_Metrics.pipelineCache = m_PipelineCache.GetStatistics();
+	m_Metrics.memory        = m_Allocator.GetStatistics();
+	m_Metrics.tlas          = m_TlasManager.GetStatistics();
+	m_Metrics.deletionQueue = m_DeletionQueue.GetStatistics();
+
+	std::cout << m_Metrics.tlas << '\n';
+	std::cout << m_Metrics.deletionQueue << '\n';
+
+	if (!m_Config.headless) {
+		m_Metrics.present = m_FramePacer.GetStatistics();
+		std::cout << m_Metrics.present << '\n';
+	}
+
+	if (m_Config.renderer == Renderer::RayTracing) {
+		m_Metrics.accumulation = m_RayTracingPass.GetAccumulationStatistics();
+		std::cout << m_Metrics.accumulation << '\n';
+	}
+
+	for (const TimingStatistics &timing: m_Metrics.timings) {
+		std::cout << timing << '\n';
+	}
+
+	if (m_Config.profileOutputPath.has_value())
+		m_Profiler.Dump(*m_Config.profileOutputPath);
+
+	m_Profiler.Cleanup();
+
+	std::cout << m_Metrics.memory << '\n';
+	m_Allocator.Cleanup();
+
 	vkDestroyDevice(m_Device, nullptr);
 
 	if (ENABLE_VALIDATION_LAYERS) {
 		DestroyDebugUtilsMessengerEXT(m_Instance, m_DebugMessenger, nullptr);
 	}
 
-	vkDestroySurfaceKHR(m_Instance, m_Surface, nullptr);
+	if (!m_Config.headless)
+		vkDestroySurfaceKHR(m_Instance, m_Surface, nullptr);
 
 	vkDestroyInstance(m_Instance, nullptr);
 
-	glfwDestroyWindow(m_pWindow);
+	if (!m_Config.headless) {
+		glfwDestroyWindow(m_pWindow);
 
-	glfwTerminate();
+		glfwTerminate();
+	}
+}
+
+void Application::RunCpu() {
+	// Owns its own workers, so GPU runs never spin them up
+	CpuRenderer renderer{};
+	renderer.SetTileSize(m_Config.tileSize);
+	renderer.SetProgressive(m_Config.progressive, m_Config.targetSamplesPerPixel);
+
+	if (m_CookedScene.IsOpen()) {
+		Bvh bvh{};
+		m_CookedScene.LoadBvh(bvh);
+		renderer.SetScene(m_Scene, m_SceneStreams, bvh);
+	} else {
+		renderer.SetScene(m_Scene);
+	}
+
+	std::vector<std::byte> image{};
+	for (uint32_t frame{0}; frame < m_Config.frameCount; ++frame) {
+		{
+			const auto renderScope{m_Profiler.ScopeCpu("cpu/render")};
+			image = renderer.Render(m_Config.width, m_Config.height);
+		}
+
+		for (const TileTiming &timing: renderer.GetTileTimings()) {
+			if (timing.completed)
+				m_Profiler.AddSample("cpu/tile", timing.milliseconds);
+		}
+	}
+
+	WriteImage(m_Config.outputPath, m_Config.width, m_Config.height, image);
+	std::cout << "Wrote " << m_Config.width << 'x' << m_Config.height << " frame to " << m_Config.outputPath.string()
+	          << '\n';
+
+	m_Metrics.deviceName   = "CPU (" + std::to_string(renderer.GetThreadCount()) + " threads)";
+	m_Metrics.timings      = m_Profiler.GetStatistics();
+	m_Metrics.cpu          = renderer.GetStatistics();
+	m_Metrics.accumulation = m_Metrics.cpu.accumulation;
+
+	std::cout << m_Metrics.cpu << '\n';
+
+	for (const TimingStatistics &timing: m_Metrics.timings) {
+		std::cout << timing << '\n';
+	}
+
+	if (m_Config.profileOutputPath.has_value())
+		m_Profiler.Dump(*m_Config.profileOutputPath);
 }
 
 void Application::CreateInstance() {
@@ -184,12 +476,7 @@ void Application::CreateInstance() {
 	createInfo.sType            = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
 	createInfo.pApplicationInfo = &appInfo;
 
-	uint32_t     glfwExtensionCount{0};
-	const char **glfwExtensions{glfwGetRequiredInstanceExtensions(&glfwExtensionCount)};
-
-	createInfo.enabledExtensionCount   = glfwExtensionCount;
-	createInfo.ppEnabledExtensionNames = glfwExtensions;
-	createInfo.enabledLayerCount       = 0;
+	createInfo.enabledLayerCount = 0;
 
 	VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo{};
 	if (ENABLE_VALIDATION_LAYERS) {
@@ -215,27 +502,10 @@ void Application::CreateInstance() {
 	}
 }
 
-void Application::FramebufferResizeCallback(GLFWwindow *pApplication, int width, int height) {
-	auto appPtr{reinterpret_cast<Application *>(pApplication)};
-	appPtr->m_FramebufferResized = true;
-}
-
-std::vector<char> Application::ReadFile(std::string_view fileName) {
-	std::ifstream file{fileName.data(), std::ios::ate | std::ios::binary};
-
-	if (!file.is_open()) {
-		throw std::runtime_error{"Failed to open file: "};
-	}
-
-	size_t            fileSize{static_cast<size_t>(file.tellg())};
-	std::vector<char> buffer(fileSize);
-
-	file.seekg(0);
-	file.read(buffer.data(), static_cast<std::streamsize>(fileSize));
-
-	file.close();
-
-	return buffer;
+void Application::FramebufferResizeCallback(GLFWwindow *pWindow, int width, int height) {
+	auto *const pApplication{static_cast<Application *>(glfwGetWindowUserPointer(pWindow))};
+	pApplication->m_FramebufferResized    = true;
+	pApplication->m_LastFramebufferResize = std::chrono::steady_clock::now();
 }
 
 bool Application::CheckValidationLayerSupport() {
@@ -270,11 +540,15 @@ void Application::PrintAvailableInstanceExtensions() {
 	vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
 }
 
-std::vector<const char *> Application::GetRequiredExtensions() {
-	uint32_t     glfwExtensionCount{0};
-	const char **glfwExtensions{glfwGetRequiredInstanceExtensions(&glfwExtensionCount)};
+std::vector<const char *> Application::GetRequiredExtensions() const {
+	std::vector<const char *> extensions{};
+
+	if (!m_Config.headless) {
+		uint32_t     glfwExtensionCount{0};
+		const char **glfwExtensions{glfwGetRequiredInstanceExtensions(&glfwExtensionCount)};
 
-	std::vector<const char *> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+		extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	}
 
 	if (ENABLE_VALIDATION_LAYERS) {
 		extensions.emplace_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -285,6 +559,22 @@ std::vector<const char *> Application::GetRequiredExtensions() {
 	return extensions;
 }
 
+std::vector<const char *> Application::GetRequiredDeviceExtensions() const {
+	std::vector<const char *> extensions{};
+
+	if (m_Config.renderer == Renderer::RayTracing)
+		extensions.insert(
+		        extensions.end(), RAY_TRACING_DEVICE_EXTENSIONS.cbegin(), RAY_TRACING_DEVICE_EXTENSIONS.cend()
+		);
+
+	if (!m_Config.headless)
+		extensions.insert(
+		        extensions.end(), PRESENTATION_DEVICE_EXTENSIONS.cbegin(), PRESENTATION_DEVICE_EXTENSIONS.cend()
+		);
+
+	return extensions;
+}
+
 VkBool32 Application::DebugCallback(
         VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType,
         const VkDebugUtilsMessengerCallbackDataEXT *pCallbackData, void *pUserData
@@ -320,20 +610,42 @@ void Application::PickPhysicalDevice() {
 	std::vector<VkPhysicalDevice> devices(deviceCount);
 	vkEnumeratePhysicalDevices(m_Instance, &deviceCount, devices.data());
 
-	const auto firstSuitableDeviceIterator{std::find_if(devices.cbegin(), devices.cend(), [this](const auto &device) {
-		return IsDeviceSuitable(device);
-	})};
-	if (firstSuitableDeviceIterator == devices.cend())
-		throw std::runtime_error{"Failed to find a suitable GPU"};
+	uint64_t bestScore{0};
+
+	for (VkPhysicalDevice device: devices) {
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(device, &deviceProperties);
+
+		const bool     selectable{m_Config.device.empty() || MatchesDeviceOverride(device)};
+		const uint64_t score{selectable ? ScorePhysicalDevice(device) : 0};
+
+		std::cout << "Device " << deviceProperties.deviceName << " (" << GetDeviceUuid(device) << "): "
+		          << (!selectable ? "not selected" : score == 0 ? "unsuitable" : "score " + std::to_string(score))
+		          << '\n';
 
-	m_PhysicalDevice = *firstSuitableDeviceIterator;
+		if (score > bestScore) {
+			bestScore        = score;
+			m_PhysicalDevice = device;
+		}
+	}
+
+	if (m_PhysicalDevice == VK_NULL_HANDLE)
+		throw std::runtime_error{
+		        m_Config.device.empty() ? std::string{"Failed to find a suitable GPU"}
+		                                : "No suitable device matches " + m_Config.device
+		};
+
+	// The raster renderer builds acceleration structures too where it can, so both renderers measure the same work
+	m_RayTracingEnabled = CheckRayTracingSupport(m_PhysicalDevice);
 }
 
 void Application::CreateLogicalDevice() {
 	QueueFamilyIndices indices{FindQueueFamilies(m_PhysicalDevice)};
 
 	std::vector<VkDeviceQueueCreateInfo> queueCreateInfos{};
-	std::set<uint32_t> uniqueQueueFamilies{indices.graphicsFamily.value(), indices.presentFamily.value()};
+	std::set<uint32_t> uniqueQueueFamilies{
+	        indices.graphicsFamily.value(), indices.presentFamily.value(), indices.transferFamily.value()
+	};
 
 	float queuePriority = 1.f;
 	for (uint32_t queueFamily: uniqueQueueFamilies) {
@@ -347,8 +659,72 @@ void Application::CreateLogicalDevice() {
 
 	VkPhysicalDeviceFeatures deviceFeatures{};
 
+	VkPhysicalDeviceRayTracingPipelineFeaturesKHR rayTracingPipelineFeatures{};
+	rayTracingPipelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_FEATURES_KHR;
+	rayTracingPipelineFeatures.rayTracingPipeline = VK_TRUE;
+
+	VkPhysicalDeviceAccelerationStructureFeaturesKHR accelerationStructureFeatures{};
+	accelerationStructureFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR;
+	accelerationStructureFeatures.pNext = &rayTracingPipelineFeatures;
+	accelerationStructureFeatures.accelerationStructure = VK_TRUE;
+	accelerationStructureFeatures.descriptorBindingAccelerationStructureUpdateAfterBind = VK_TRUE;
+
+	// Device addresses are only used by acceleration structure builds and the ray tracing shaders
+	VkPhysicalDeviceVulkan12Features vulkan12Features{};
+	vulkan12Features.sType               = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	vulkan12Features.timelineSemaphore   = VK_TRUE;
+	vulkan12Features.bufferDeviceAddress = m_RayTracingEnabled ? VK_TRUE : VK_FALSE;
+
+	// Only the ray tracing pass reads from the bindless table
+	if (m_Config.renderer == Renderer::RayTracing)
+		BindlessTable::EnableFeatures(deviceFeatures, vulkan12Features);
+
+	auto deviceExtensions{GetRequiredDeviceExtensions()};
+
+	// Optional features are chained in right behind vulkan12Features, only when the device supports them
+	if (m_RayTracingEnabled) {
+		vulkan12Features.pNext = &accelerationStructureFeatures;
+
+		if (m_Config.renderer != Renderer::RayTracing)
+			deviceExtensions.insert(
+			        deviceExtensions.end(), RAY_TRACING_DEVICE_EXTENSIONS.cbegin(), RAY_TRACING_DEVICE_EXTENSIONS.cend()
+			);
+	}
+
+	VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+	presentWaitFeatures.sType       = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+	presentWaitFeatures.presentWait = VK_TRUE;
+
+	VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+	presentIdFeatures.sType     = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+	presentIdFeatures.pNext     = &presentWaitFeatures;
+	presentIdFeatures.presentId = VK_TRUE;
+
+	const bool presentWait{!m_Config.headless && CheckPresentWaitSupport(m_PhysicalDevice)};
+	if (presentWait) {
+		presentWaitFeatures.pNext = vulkan12Features.pNext;
+		vulkan12Features.pNext    = &presentIdFeatures;
+		deviceExtensions.insert(
+		        deviceExtensions.end(), PRESENT_WAIT_DEVICE_EXTENSIONS.cbegin(), PRESENT_WAIT_DEVICE_EXTENSIONS.cend()
+		);
+	}
+
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(m_PhysicalDevice, &deviceProperties);
+
+	m_PipelineCreationFeedback = deviceProperties.apiVersion >= VK_API_VERSION_1_3;
+	if (!m_PipelineCreationFeedback &&
+	    SupportsDeviceExtensions(m_PhysicalDevice, PIPELINE_CREATION_FEEDBACK_DEVICE_EXTENSIONS)) {
+		m_PipelineCreationFeedback = true;
+		deviceExtensions.insert(
+		        deviceExtensions.end(), PIPELINE_CREATION_FEEDBACK_DEVICE_EXTENSIONS.cbegin(),
+		        PIPELINE_CREATION_FEEDBACK_DEVICE_EXTENSIONS.cend()
+		);
+	}
+
 	VkDeviceCreateInfo createInfo{};
 	createInfo.sType                = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	createInfo.pNext                = &vulkan12Features;
 	createInfo.queueCreateInfoCount = queueCreateInfos.size();
 	createInfo.pQueueCreateInfos    = queueCreateInfos.data();
 	createInfo.pEnabledFeatures     = &deviceFeatures;
@@ -360,8 +736,8 @@ void Application::CreateLogicalDevice() {
 		createInfo.enabledLayerCount = 0;
 	}
 
-	createInfo.enabledExtensionCount   = static_cast<uint32_t>(DEVICE_EXTENSIONS.size());
-	createInfo.ppEnabledExtensionNames = DEVICE_EXTENSIONS.data();
+	createInfo.enabledExtensionCount   = static_cast<uint32_t>(deviceExtensions.size());
+	createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
 	if (const VkResult result{vkCreateDevice(m_PhysicalDevice, &createInfo, nullptr, &m_Device)};
 	    result != VK_SUCCESS) {
@@ -370,6 +746,24 @@ void Application::CreateLogicalDevice() {
 
 	vkGetDeviceQueue(m_Device, indices.graphicsFamily.value(), 0, &m_GraphicsQueue);
 	vkGetDeviceQueue(m_Device, indices.presentFamily.value(), 0, &m_PresentQueue);
+	vkGetDeviceQueue(m_Device, indices.transferFamily.value(), 0, &m_TransferQueue);
+
+	if (m_RayTracingEnabled)
+		m_RayTracingFunctions.Load(m_Device);
+
+	m_Allocator.Init(m_PhysicalDevice, m_Device, m_RayTracingEnabled);
+	m_DeletionQueue.Init(m_Device, m_Allocator);
+	if (m_Config.renderer == Renderer::RayTracing)
+		m_BindlessTable.Init(m_PhysicalDevice, m_Device, m_DeletionQueue, m_RayTracingEnabled);
+	m_FramePacer.Init(m_Device, m_Config.presentPolicy, m_Config.maxFramesPerSecond, presentWait);
+
+	if (m_RayTracingEnabled)
+		m_BlasBuilder.Init(m_PhysicalDevice, m_Device, m_Allocator, m_RayTracingFunctions);
+
+	m_UploadManager.Init(
+	        m_Device, m_Allocator, indices.transferFamily.value(), m_TransferQueue, indices.graphicsFamily.value(),
+	        m_GraphicsQueue
+	);
 }
 
 void Application::CreateSurface() {
@@ -383,7 +777,9 @@ void Application::CreateSwapChain() {
 	const SwapChainSupportDetails swapChainSupport{QuerySwapChainSupport(m_PhysicalDevice)};
 
 	const VkSurfaceFormatKHR surfaceFormat{ChooseSwapSurfaceFormat(swapChainSupport.formats)};
-	const VkPresentModeKHR   presentMode{ChooseSwapPresentMode(swapChainSupport.presentModes)};
+	const VkPresentModeKHR   presentMode{
+	        ChooseSwapPresentMode(swapChainSupport.presentModes, m_Config.presentPolicy)
+	};
 	const VkExtent2D         extent{ChooseSwapExtent(swapChainSupport.capabilities)};
 
 	uint32_t imageCount{swapChainSupport.capabilities.minImageCount + 1};
@@ -402,6 +798,14 @@ void Application::CreateSwapChain() {
 	createInfo.imageArrayLayers = 1;
 	createInfo.imageUsage       = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
+	// The ray tracing pass blits into the swap chain image instead of rendering to it
+	if (m_Config.renderer == Renderer::RayTracing) {
+		if (!(swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT))
+			throw std::runtime_error{"Swap chain images can not be used as transfer destination"};
+
+		createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	}
+
 	QueueFamilyIndices      indices{FindQueueFamilies(m_PhysicalDevice)};
 	std::array<uint32_t, 2> queueFamilyIndices{indices.graphicsFamily.value(), indices.presentFamily.value()};
 
@@ -421,7 +825,8 @@ void Application::CreateSwapChain() {
 	createInfo.presentMode = presentMode;
 	createInfo.clipped     = VK_TRUE;
 
-	createInfo.oldSwapchain = VK_NULL_HANDLE;
+	// Lets the presentation engine hand resources over from the swap chain being replaced, VK_NULL_HANDLE at startup
+	createInfo.oldSwapchain = m_SwapChain;
 
 	if (const VkResult result{vkCreateSwapchainKHR(m_Device, &createInfo, nullptr, &m_SwapChain)};
 	    result != VK_SUCCESS) {
@@ -434,6 +839,8 @@ void Application::CreateSwapChain() {
 
 	m_SwapChainImageFormat = surfaceFormat.format;
 	m_SwapChainExtent      = extent;
+
+	m_FramePacer.SetPresentMode(presentMode);
 }
 
 void Application::CreateImageViews() {
@@ -462,68 +869,187 @@ void Application::CreateImageViews() {
 	}
 }
 
-void Application::CreateGraphicsPipeline() {
-	auto vertShaderCode{ReadFile("shaders/shader.vert.spv")};
-	auto fragShaderCode{ReadFile("shaders/shader.frag.spv")};
+void Application::CreateOffscreenTargets() {
+	m_SwapChainImageFormat = OFFSCREEN_FORMAT;
+	m_SwapChainExtent      = {m_Config.width, m_Config.height};
+
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType     = VK_IMAGE_TYPE_2D;
+	imageInfo.format        = m_SwapChainImageFormat;
+	imageInfo.extent        = {m_SwapChainExtent.width, m_SwapChainExtent.height, 1};
+	imageInfo.mipLevels     = 1;
+	imageInfo.arrayLayers   = 1;
+	imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage         = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+	                          VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	// One image per frame in flight, so a frame never renders over an image the previous one is still writing
+	m_SwapChainImages.resize(m_Config.framesInFlight);
+	m_OffscreenImageAllocations.resize(m_Config.framesInFlight);
 
-	VkShaderModule vertShaderModule{CreateShaderModule(std::move(vertShaderCode))};
-	VkShaderModule fragShaderModule{CreateShaderModule(std::move(fragShaderCode))};
+	for (size_t i{0}; i < m_SwapChainImages.size(); ++i) {
+		m_Allocator.CreateImage(
+		        imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_SwapChainImages[i], m_OffscreenImageAllocations[i]
+		);
+	}
+}
 
-	VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-	vertShaderStageInfo.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-	vertShaderStageInfo.stage  = VK_SHADER_STAGE_VERTEX_BIT;
-	vertShaderStageInfo.module = vertShaderModule;
-	vertShaderStageInfo.pName  = "main";
+void Application::CreateDepthResources() {
+	m_DepthFormat = VK_FORMAT_UNDEFINED;
+	for (const VkFormat format: DEPTH_FORMATS) {
+		VkFormatProperties properties;
+		vkGetPhysicalDeviceFormatProperties(m_PhysicalDevice, format, &properties);
 
-	VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-	fragShaderStageInfo.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-	fragShaderStageInfo.stage  = VK_SHADER_STAGE_FRAGMENT_BIT;
-	fragShaderStageInfo.module = fragShaderModule;
-	fragShaderStageInfo.pName  = "main";
+		if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) {
+			m_DepthFormat = format;
+			break;
+		}
+	}
 
-	std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages{vertShaderStageInfo, fragShaderStageInfo};
+	if (m_DepthFormat == VK_FORMAT_UNDEFINED)
+		throw std::runtime_error{"Failed to find a supported depth format"};
+
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType     = VK_IMAGE_TYPE_2D;
+	imageInfo.format        = m_DepthFormat;
+	imageInfo.extent        = {m_SwapChainExtent.width, m_SwapChainExtent.height, 1};
+	imageInfo.mipLevels     = 1;
+	imageInfo.arrayLayers   = 1;
+	imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage         = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+	imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	m_Allocator.CreateImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_DepthImage, m_DepthImageAllocation);
+
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType                           = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image                           = m_DepthImage;
+	viewInfo.viewType                        = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format                          = m_DepthFormat;
+	viewInfo.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_DEPTH_BIT;
+	viewInfo.subresourceRange.baseMipLevel   = 0;
+	viewInfo.subresourceRange.levelCount     = 1;
+	viewInfo.subresourceRange.baseArrayLayer = 0;
+	viewInfo.subresourceRange.layerCount     = 1;
+
+	if (const VkResult result{vkCreateImageView(m_Device, &viewInfo, nullptr, &m_DepthImageView)};
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to create depth image view: "} + string_VkResult(result)};
+	}
+}
 
-	std::vector<VkDynamicState> dynamicStates{VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+void Application::ReadbackOffscreenImage() {
+	const uint32_t     lastImageIndex{m_FrameTimeline.GetLastFrameSlot()};
+	const VkDeviceSize imageSize{static_cast<VkDeviceSize>(m_SwapChainExtent.width) * m_SwapChainExtent.height * 4};
 
-	VkPipelineDynamicStateCreateInfo dynamicStateInfo{};
-	dynamicStateInfo.sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-	dynamicStateInfo.dynamicStateCount = dynamicStates.size();
-	dynamicStateInfo.pDynamicStates    = dynamicStates.data();
+	VkBuffer   readbackBuffer;
+	Allocation readbackBufferAllocation;
+	CreateBuffer(
+	        imageSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, readbackBuffer,
+	        readbackBufferAllocation
+	);
+
+	VkCommandBufferAllocateInfo allocateInfo{};
+	allocateInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocateInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandPool        = m_CommandPool;
+	allocateInfo.commandBufferCount = 1;
 
-	VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	VkCommandBuffer commandBuffer;
+	if (const VkResult result{vkAllocateCommandBuffers(m_Device, &allocateInfo, &commandBuffer)};
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to allocate readback command buffer: "} + string_VkResult(result)};
+	}
 
-	const auto bindingDescription{Vertex::GetBindingDescription()};
-	const auto attributeDescriptions{Vertex::GetAttributeDescriptions()};
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-	vertexInputInfo.vertexBindingDescriptionCount   = 1;
-	vertexInputInfo.pVertexBindingDescriptions      = &bindingDescription;
-	vertexInputInfo.vertexAttributeDescriptionCount = attributeDescriptions.size();
-	vertexInputInfo.pVertexAttributeDescriptions    = attributeDescriptions.data();
+	if (const VkResult result{vkBeginCommandBuffer(commandBuffer, &beginInfo)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to begin readback command buffer: "} + string_VkResult(result)};
+	}
 
-	VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo{};
-	inputAssemblyInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-	inputAssemblyInfo.topology               = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-	inputAssemblyInfo.primitiveRestartEnable = VK_FALSE;
+	// The render pass already left the image in TRANSFER_SRC_OPTIMAL
+	VkBufferImageCopy region{};
+	region.bufferOffset                = 0;
+	region.bufferRowLength             = 0;
+	region.bufferImageHeight           = 0;
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent                 = {m_SwapChainExtent.width, m_SwapChainExtent.height, 1};
+	vkCmdCopyImageToBuffer(
+	        commandBuffer, m_SwapChainImages[lastImageIndex], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer, 1,
+	        &region
+	);
 
-	VkViewport viewport{};
-	viewport.x        = 0.0f;
-	viewport.y        = 0.0f;
-	viewport.width    = static_cast<float>(m_SwapChainExtent.width);
-	viewport.height   = static_cast<float>(m_SwapChainExtent.height);
-	viewport.minDepth = 0.0f;
-	viewport.maxDepth = 1.0f;
+	VkBufferMemoryBarrier hostReadBarrier{};
+	hostReadBarrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	hostReadBarrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+	hostReadBarrier.dstAccessMask       = VK_ACCESS_HOST_READ_BIT;
+	hostReadBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	hostReadBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	hostReadBarrier.buffer              = readbackBuffer;
+	hostReadBarrier.size                = VK_WHOLE_SIZE;
+	vkCmdPipelineBarrier(
+	        commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1,
+	        &hostReadBarrier, 0, nullptr
+	);
 
-	VkRect2D scissor{};
-	scissor.offset = {0, 0};
-	scissor.extent = m_SwapChainExtent;
+	if (const VkResult result{vkEndCommandBuffer(commandBuffer)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to record readback command buffer: "} + string_VkResult(result)};
+	}
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers    = &commandBuffer;
 
-	VkPipelineViewportStateCreateInfo viewportStateInfo{};
-	viewportStateInfo.sType         = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-	viewportStateInfo.viewportCount = 1;
-	viewportStateInfo.scissorCount  = 1;
+	if (const VkResult result{vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to submit readback: "} + string_VkResult(result)};
+	}
 
-	VkPipelineRasterizationStateCreateInfo rasterizerInfo{};
+	// Shutdown path only, nothing else is in flight anymore
+	if (const VkResult result{vkQueueWaitIdle(m_GraphicsQueue)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to wait for readback: "} + string_VkResult(result)};
+	}
+	vkFreeCommandBuffers(m_Device, m_CommandPool, 1, &commandBuffer);
+
+	WriteImage(
+	        m_Config.outputPath, m_SwapChainExtent.width, m_SwapChainExtent.height,
+	        {static_cast<const std::byte *>(readbackBufferAllocation.pMapped), static_cast<size_t>(imageSize)}
+	);
+	std::cout << "Wrote " << m_SwapChainExtent.width << 'x' << m_SwapChainExtent.height << " frame to "
+	          << m_Config.outputPath.string() << '\n';
+
+	DestroyBuffer(readbackBuffer, readbackBufferAllocation);
+}
+
+void Application::CreateGraphicsPipeline() {
+	GraphicsPipelineDescription description{};
+	description.name = "raster";
+	description.stages.emplace_back(VK_SHADER_STAGE_VERTEX_BIT, "shader.vert.spv");
+	description.stages.emplace_back(VK_SHADER_STAGE_FRAGMENT_BIT, "shader.frag.spv");
+
+	description.dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+
+	const auto attributeDescriptions{Vertex::GetAttributeDescriptions()};
+	description.vertexBindings.emplace_back(Vertex::GetBindingDescription());
+	description.vertexAttributes.assign(attributeDescriptions.cbegin(), attributeDescriptions.cend());
+
+	VkPipelineInputAssemblyStateCreateInfo &inputAssemblyInfo{description.inputAssembly};
+	inputAssemblyInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssemblyInfo.topology               = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	inputAssemblyInfo.primitiveRestartEnable = VK_FALSE;
+
+	VkPipelineRasterizationStateCreateInfo &rasterizerInfo{description.rasterization};
 	rasterizerInfo.sType                   = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
 	rasterizerInfo.depthClampEnable        = VK_FALSE;
 	rasterizerInfo.rasterizerDiscardEnable = VK_FALSE;
@@ -533,11 +1059,20 @@ void Application::CreateGraphicsPipeline() {
 	rasterizerInfo.frontFace               = VK_FRONT_FACE_CLOCKWISE;
 	rasterizerInfo.depthBiasEnable         = VK_FALSE;
 
-	VkPipelineMultisampleStateCreateInfo multisampleInfo{};
+	VkPipelineMultisampleStateCreateInfo &multisampleInfo{description.multisample};
 	multisampleInfo.sType                = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
 	multisampleInfo.sampleShadingEnable  = VK_FALSE;
 	multisampleInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
 
+	// Smaller z is closer, the ray tracers shoot from z = -1 towards +z
+	VkPipelineDepthStencilStateCreateInfo &depthStencilInfo{description.depthStencil};
+	depthStencilInfo.sType                 = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depthStencilInfo.depthTestEnable       = VK_TRUE;
+	depthStencilInfo.depthWriteEnable      = VK_TRUE;
+	depthStencilInfo.depthCompareOp        = VK_COMPARE_OP_LESS;
+	depthStencilInfo.depthBoundsTestEnable = VK_FALSE;
+	depthStencilInfo.stencilTestEnable     = VK_FALSE;
+
 	VkPipelineColorBlendAttachmentState colorBlendAttachment{};
 	colorBlendAttachment.colorWriteMask =
 	        VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
@@ -548,56 +1083,40 @@ void Application::CreateGraphicsPipeline() {
 	colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
 	colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
 	colorBlendAttachment.alphaBlendOp        = VK_BLEND_OP_ADD;
+	description.colorBlendAttachments.emplace_back(colorBlendAttachment);
 
-	VkPipelineColorBlendStateCreateInfo colorBlending{};
+	VkPipelineColorBlendStateCreateInfo &colorBlending{description.colorBlend};
 	colorBlending.sType             = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
 	colorBlending.logicOpEnable     = VK_FALSE;
 	colorBlending.logicOp           = VK_LOGIC_OP_COPY;
-	colorBlending.attachmentCount   = 1;
-	colorBlending.pAttachments      = &colorBlendAttachment;
 	colorBlending.blendConstants[0] = 0.0f;
 	colorBlending.blendConstants[1] = 0.0f;
 	colorBlending.blendConstants[2] = 0.0f;
 	colorBlending.blendConstants[3] = 0.0f;
 
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	pushConstantRange.offset     = 0;
+	pushConstantRange.size       = sizeof(InstanceGridPushConstants);
+
+	// The raster shaders get everything from vertex attributes and push constants, no descriptor sets
 	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount         = 0;
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	pipelineLayoutInfo.pPushConstantRanges    = &pushConstantRange;
 
 	if (const VkResult result{vkCreatePipelineLayout(m_Device, &pipelineLayoutInfo, nullptr, &m_PipelineLayout)};
 	    result != VK_SUCCESS) {
 		throw std::runtime_error{std::string{"Failed to create pipeline layout: "} + string_VkResult(result)};
 	}
 
-	VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
-	pipelineCreateInfo.sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-	pipelineCreateInfo.stageCount          = shaderStages.size();
-	pipelineCreateInfo.pStages             = shaderStages.data();
-	pipelineCreateInfo.pVertexInputState   = &vertexInputInfo;
-	pipelineCreateInfo.pInputAssemblyState = &inputAssemblyInfo;
-	pipelineCreateInfo.pViewportState      = &viewportStateInfo;
-	pipelineCreateInfo.pRasterizationState = &rasterizerInfo;
-	pipelineCreateInfo.pMultisampleState   = &multisampleInfo;
-	pipelineCreateInfo.pDepthStencilState  = nullptr;
-	pipelineCreateInfo.pColorBlendState    = &colorBlending;
-	pipelineCreateInfo.pDynamicState       = &dynamicStateInfo;
-	pipelineCreateInfo.layout              = m_PipelineLayout;
-	pipelineCreateInfo.renderPass          = m_RenderPass;
-	pipelineCreateInfo.subpass             = 0;
-
-	// Creating new pipeline from existing one!
-	// https://vulkan-tutorial.com/en/Drawing_a_triangle/Graphics_pipeline_basics/Conclusion
-	pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
-	pipelineCreateInfo.basePipelineIndex  = -1;
-
-	if (const VkResult result{vkCreateGraphicsPipelines(
-	            m_Device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_GraphicsPipeline
-	    )};
-	    result != VK_SUCCESS) {
-		throw std::runtime_error{std::string{"Failed to create graphics pipeline: "} + string_VkResult(result)};
-	}
+	description.layout     = m_PipelineLayout;
+	description.renderPass = m_RenderPass;
+	description.subpass    = 0;
 
-	vkDestroyShaderModule(m_Device, vertShaderModule, nullptr);
-	vkDestroyShaderModule(m_Device, fragShaderModule, nullptr);
+	// Only queues the build, InitVulkan collects the result once everything else is set up
+	m_GraphicsPipelineFuture = m_PipelineBuilder.BuildGraphicsPipeline(std::move(description));
 }
 
 void Application::CreateRenderPass() {
@@ -609,31 +1128,52 @@ void Application::CreateRenderPass() {
 	colorAttachment.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	colorAttachment.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
-	colorAttachment.finalLayout    = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	colorAttachment.finalLayout    = GetTargetFinalLayout();
+
+	// Only needed while the pass runs, so it is never stored
+	VkAttachmentDescription depthAttachment{};
+	depthAttachment.format         = m_DepthFormat;
+	depthAttachment.samples        = VK_SAMPLE_COUNT_1_BIT;
+	depthAttachment.loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	depthAttachment.storeOp        = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	depthAttachment.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	depthAttachment.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
+	depthAttachment.finalLayout    = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	const std::array<VkAttachmentDescription, 2> attachments{colorAttachment, depthAttachment};
 
 	VkAttachmentReference colorAttachmentRef{};
 	colorAttachmentRef.attachment = 0;
 	colorAttachmentRef.layout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
+	VkAttachmentReference depthAttachmentRef{};
+	depthAttachmentRef.attachment = 1;
+	depthAttachmentRef.layout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
 	VkSubpassDescription subpassDescription{};
-	subpassDescription.pipelineBindPoint    = VK_PIPELINE_BIND_POINT_GRAPHICS;
-	subpassDescription.colorAttachmentCount = 1;
-	subpassDescription.pColorAttachments    = &colorAttachmentRef;
+	subpassDescription.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpassDescription.colorAttachmentCount    = 1;
+	subpassDescription.pColorAttachments       = &colorAttachmentRef;
+	subpassDescription.pDepthStencilAttachment = &depthAttachmentRef;
 
 	VkRenderPassCreateInfo renderPassCreateInfo{};
 	renderPassCreateInfo.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-	renderPassCreateInfo.attachmentCount = 1;
-	renderPassCreateInfo.pAttachments    = &colorAttachment;
+	renderPassCreateInfo.attachmentCount = attachments.size();
+	renderPassCreateInfo.pAttachments    = attachments.data();
 	renderPassCreateInfo.subpassCount    = 1;
 	renderPassCreateInfo.pSubpasses      = &subpassDescription;
 
+	// Frames in flight share the depth image, so the clear waits for the depth tests of the frame before
 	VkSubpassDependency dependency{};
 	dependency.srcSubpass    = VK_SUBPASS_EXTERNAL;
 	dependency.dstSubpass    = 0;
-	dependency.srcStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	dependency.srcAccessMask = 0;
-	dependency.dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	dependency.srcStageMask =
+	        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	dependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependency.dstStageMask =
+	        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
 	renderPassCreateInfo.dependencyCount = 1;
 	renderPassCreateInfo.pDependencies   = &dependency;
@@ -648,7 +1188,7 @@ void Application::CreateFramebuffers() {
 	m_SwapChainFramebuffers.resize(m_SwapChainImages.size());
 
 	for (uint32_t i{0}; i < m_SwapChainImageViews.size(); i++) {
-		std::array<VkImageView, 1> attachments{m_SwapChainImageViews[i]};
+		std::array<VkImageView, 2> attachments{m_SwapChainImageViews[i], m_DepthImageView};
 
 		VkFramebufferCreateInfo framebufferCreateInfo{};
 		framebufferCreateInfo.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
@@ -673,7 +1213,7 @@ void Application::CreateCommandPool() {
 
 	VkCommandPoolCreateInfo commandPoolCreateInfo{};
 	commandPoolCreateInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-	commandPoolCreateInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	commandPoolCreateInfo.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
 	commandPoolCreateInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
 
 	if (const VkResult result{vkCreateCommandPool(m_Device, &commandPoolCreateInfo, nullptr, &m_CommandPool)};
@@ -683,28 +1223,67 @@ void Application::CreateCommandPool() {
 }
 
 void Application::CreateCommandBuffers() {
-	VkCommandBufferAllocateInfo allocateInfo{};
-	allocateInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	allocateInfo.commandPool        = m_CommandPool;
-	allocateInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	allocateInfo.commandBufferCount = m_CommandBuffers.size();
+	const uint32_t workerCount{
+	        m_Config.recordThreadCount == 0 ? static_cast<uint32_t>(m_ThreadPool.GetThreadCount())
+	                                        : m_Config.recordThreadCount
+	};
 
-	if (const VkResult result{vkAllocateCommandBuffers(m_Device, &allocateInfo, m_CommandBuffers.data())};
-	    result != VK_SUCCESS) {
-		throw std::runtime_error{std::string{"Failed to allocate command buffers: "} + string_VkResult(result)};
-	}
+	m_CommandRecorder.Init(
+	        m_Device, FindQueueFamilies(m_PhysicalDevice).graphicsFamily.value(), m_ThreadPool, m_Config.framesInFlight,
+	        workerCount
+	);
 }
 
 void Application::RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
 	VkCommandBufferBeginInfo beginInfo{};
 	beginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-	beginInfo.flags            = 0;
+	beginInfo.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 	beginInfo.pInheritanceInfo = nullptr;
 
 	if (const VkResult result{vkBeginCommandBuffer(commandBuffer, &beginInfo)}; result != VK_SUCCESS) {
 		throw std::runtime_error{std::string{"Failed to begin command buffer: "} + string_VkResult(result)};
 	}
 
+	m_Profiler.ResetQueries(commandBuffer);
+
+	if (m_Config.animate) {
+		m_AnimationTime = static_cast<float>(m_FrameTimeline.GetFrameValue()) * ANIMATION_TIME_STEP;
+
+		// Only the transforms change, so TlasManager refits instead of rebuilding
+		if (m_RayTracingEnabled) {
+			for (uint32_t instance{0}; instance < m_Scene.instanceCount; ++instance) {
+				m_TlasManager.SetTransform(instance, m_Scene.GetInstanceTransform(instance, m_AnimationTime));
+			}
+		}
+	}
+
+	if (m_RayTracingEnabled) {
+		const uint32_t tlasScope{m_Profiler.BeginGpuScope(commandBuffer, "tlas_build")};
+		const bool     sceneChanged{m_TlasManager.Record(commandBuffer, m_FrameRing)};
+		m_Profiler.EndGpuScope(commandBuffer, tlasScope);
+
+		// Samples taken against the old scene would ghost into the new one
+		if (sceneChanged && m_Config.renderer == Renderer::RayTracing)
+			m_RayTracingPass.ResetAccumulation();
+	}
+
+	// Same scope name for both renderers, so their timings line up in the benchmark output
+	const uint32_t mainPassScope{m_Profiler.BeginGpuScope(commandBuffer, "main_pass")};
+
+	if (m_Config.renderer == Renderer::RayTracing) {
+		m_RayTracingPass.Record(commandBuffer, m_SwapChainImages[imageIndex], GetTargetFinalLayout());
+	} else {
+		RecordRasterPass(commandBuffer, imageIndex);
+	}
+
+	m_Profiler.EndGpuScope(commandBuffer, mainPassScope);
+
+	if (const VkResult result{vkEndCommandBuffer(commandBuffer)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to record command buffer: "} + string_VkResult(result)};
+	}
+}
+
+void Application::RecordRasterPass(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
 	VkRenderPassBeginInfo renderPassInfo{};
 	renderPassInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 	renderPassInfo.renderPass        = m_RenderPass;
@@ -712,12 +1291,53 @@ void Application::RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t im
 	renderPassInfo.renderArea.offset = {0, 0};
 	renderPassInfo.renderArea.extent = m_SwapChainExtent;
 
-	VkClearValue clearValue{{{0.0f, 0.0f, 0.0f, 1.0f}}};
-	renderPassInfo.clearValueCount = 1;
-	renderPassInfo.pClearValues    = &clearValue;
+	std::array<VkClearValue, 2> clearValues{};
+	clearValues[0].color           = {{0.0f, 0.0f, 0.0f, 1.0f}};
+	clearValues[1].depthStencil    = {1.0f, 0};
+	renderPassInfo.clearValueCount = clearValues.size();
+	renderPassInfo.pClearValues    = clearValues.data();
+
+	// Instances are split into one contiguous range per worker, small scenes are not worth the hand-off
+	const uint32_t chunkCount{std::clamp(
+	        m_Scene.instanceCount / MIN_INSTANCES_PER_RECORDING_CHUNK, 1u, m_CommandRecorder.GetWorkerCount()
+	)};
+
+	if (chunkCount == 1) {
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		RecordRasterDraws(commandBuffer, 0, m_Scene.instanceCount);
+		vkCmdEndRenderPass(commandBuffer);
+		return;
+	}
+
+	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+	VkCommandBufferInheritanceInfo inheritanceInfo{};
+	inheritanceInfo.sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritanceInfo.renderPass  = m_RenderPass;
+	inheritanceInfo.subpass     = 0;
+	inheritanceInfo.framebuffer = m_SwapChainFramebuffers[imageIndex];
+
+	const std::span<const VkCommandBuffer> secondaries{m_CommandRecorder.RecordSecondaries(
+	        inheritanceInfo, chunkCount,
+	        [this, chunkCount](VkCommandBuffer secondary, uint32_t chunk) {
+		        const uint32_t firstInstance{static_cast<uint32_t>(
+		                static_cast<uint64_t>(m_Scene.instanceCount) * chunk / chunkCount
+		        )};
+		        const uint32_t endInstance{static_cast<uint32_t>(
+		                static_cast<uint64_t>(m_Scene.instanceCount) * (chunk + 1) / chunkCount
+		        )};
+
+		        RecordRasterDraws(secondary, firstInstance, endInstance - firstInstance);
+	        }
+	)};
 
-	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+	vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(secondaries.size()), secondaries.data());
 
+	vkCmdEndRenderPass(commandBuffer);
+}
+
+void Application::RecordRasterDraws(VkCommandBuffer commandBuffer, uint32_t firstInstance, uint32_t instanceCount) {
+	// Secondary command buffers inherit none of this state, so every chunk binds it again
 	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline);
 
 	// TODO: this is repeated
@@ -739,26 +1359,29 @@ void Application::RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t im
 	std::array<VkDeviceSize, 1> offsets{0};
 	vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers.data(), offsets.data());
 
-	vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+	vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer, 0, m_SceneStreams.GetIndexType());
 
-	vkCmdDrawIndexed(commandBuffer, INDICES.size(), 1, 0, 0, 0);
-
-	vkCmdEndRenderPass(commandBuffer);
+	const InstanceGridPushConstants instanceGrid{m_Scene.GetGridSize(), m_AnimationTime};
+	vkCmdPushConstants(
+	        commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(instanceGrid), &instanceGrid
+	);
 
-	if (const VkResult result{vkEndCommandBuffer(commandBuffer)}; result != VK_SUCCESS) {
-		throw std::runtime_error{std::string{"Failed to record command buffer: "} + string_VkResult(result)};
-	}
+	// gl_InstanceIndex includes firstInstance, so every chunk lands in its own grid cells
+	vkCmdDrawIndexed(
+	        commandBuffer, static_cast<uint32_t>(m_SceneStreams.GetIndexCount()), instanceCount, 0, 0, firstInstance
+	);
 }
 
 void Application::CreateSyncObjects() {
+	m_FrameTimeline.Init(m_Device, m_Config.framesInFlight);
+
 	VkSemaphoreCreateInfo semaphoreInfo{};
 	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-	VkFenceCreateInfo fenceInfo{};
-	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-	fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+	m_ImageAvailableSemaphores.resize(m_Config.framesInFlight);
+	m_RenderFinishedSemaphores.resize(m_Config.framesInFlight);
 
-	for (size_t i{0}; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+	for (size_t i{0}; i < m_Config.framesInFlight; ++i) {
 		if (const VkResult result{vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &m_ImageAvailableSemaphores[i])};
 		    result != VK_SUCCESS) {
 			throw std::runtime_error{
@@ -772,11 +1395,6 @@ void Application::CreateSyncObjects() {
 			        std::string{"Failed to create render finished semaphore: "} + string_VkResult(result)
 			};
 		}
-
-		if (const VkResult result{vkCreateFence(m_Device, &fenceInfo, nullptr, &m_InFlightFences[i])};
-		    result != VK_SUCCESS) {
-			throw std::runtime_error{std::string{"Failed to create fence: "} + string_VkResult(result)};
-		}
 	}
 }
 
@@ -788,13 +1406,34 @@ void Application::RecreateSwapChain() {
 		glfwWaitEvents();
 	}
 
-	vkDeviceWaitIdle(m_Device);
+	const auto recreateScope{m_Profiler.ScopeCpu("cpu/recreate_swapchain")};
 
-	CleanupSwapChain();
+	// Frames already submitted keep rendering into and presenting the old images. Their presents are queued before
+	// those of the next framesInFlight frames, so once those finished nothing references the old swap chain anymore
+	const uint64_t       retireValue{m_FrameTimeline.GetFrameValue() - 1 + m_Config.framesInFlight};
+	const VkSwapchainKHR oldSwapChain{m_SwapChain};
+
+	for (auto framebuffer: m_SwapChainFramebuffers) { m_DeletionQueue.DestroyFramebuffer(retireValue, framebuffer); }
+
+	for (auto imageView: m_SwapChainImageViews) { m_DeletionQueue.DestroyImageView(retireValue, imageView); }
+
+	m_DeletionQueue.DestroyImageView(retireValue, m_DepthImageView);
+	m_DeletionQueue.DestroyImage(retireValue, m_DepthImage, m_DepthImageAllocation);
+
+	m_SwapChainFramebuffers.clear();
+	m_SwapChainImageViews.clear();
 
 	CreateSwapChain();
+	m_DeletionQueue.DestroySwapChain(retireValue, oldSwapChain);
+	m_FramePacer.OnSwapChainRecreated();
+
 	CreateImageViews();
+	CreateDepthResources();
 	CreateFramebuffers();
+
+	// The submitted frames keep tracing into the old storage images, only they read the old bindless handles
+	if (m_Config.renderer == Renderer::RayTracing)
+		m_RayTracingPass.Resize(m_SwapChainExtent, m_FrameTimeline.GetFrameValue() - 1);
 }
 
 void Application::CleanupSwapChain() {
@@ -802,155 +1441,86 @@ void Application::CleanupSwapChain() {
 
 	for (auto imageView: m_SwapChainImageViews) { vkDestroyImageView(m_Device, imageView, nullptr); }
 
+	vkDestroyImageView(m_Device, m_DepthImageView, nullptr);
+	m_Allocator.DestroyImage(m_DepthImage, m_DepthImageAllocation);
+
+	if (m_Config.headless) {
+		for (size_t i{0}; i < m_SwapChainImages.size(); ++i) {
+			m_Allocator.DestroyImage(m_SwapChainImages[i], m_OffscreenImageAllocations[i]);
+		}
+
+		return;
+	}
+
 	vkDestroySwapchainKHR(m_Device, m_SwapChain, nullptr);
 }
 
 void Application::CreateVertexBuffer() {
-	VkDeviceSize bufferSize{sizeof(Vertex) * VERTICES.size()};
+	VkDeviceSize bufferSize{m_SceneStreams.GetVertexBufferSize()};
 
-	VkBuffer       stagingBuffer;
-	VkDeviceMemory stagingBufferMemory;
 	CreateBuffer(
-	        bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-	        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer,
-	        stagingBufferMemory
+	        bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | GetGeometryBufferUsage(),
+	        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_VertexBuffer, m_VertexBufferAllocation
 	);
 
-	void *data;
-	vkMapMemory(m_Device, stagingBufferMemory, 0, bufferSize, 0, &data);
-	memcpy(data, VERTICES.data(), bufferSize);
-	vkUnmapMemory(m_Device, stagingBufferMemory);
-
-	CreateBuffer(
-	        bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-	        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_VertexBuffer, m_VertexBufferMemory
+	m_SceneUploadTicket = m_UploadManager.Enqueue(
+	        m_VertexBuffer, 0, m_SceneStreams.vertices.data(), bufferSize,
+	        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | GetGeometryReadStages(),
+	        VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | GetGeometryReadAccess()
 	);
-
-	CopyBuffer(stagingBuffer, m_VertexBuffer, bufferSize);
-
-	vkDestroyBuffer(m_Device, stagingBuffer, nullptr);
-	vkFreeMemory(m_Device, stagingBufferMemory, nullptr);
 }
 
 void Application::CreateIndexBuffer() {
-	VkDeviceSize bufferSize{sizeof(INDICES[0]) * INDICES.size()};
+	VkDeviceSize bufferSize{m_SceneStreams.GetIndexBufferSize()};
 
-	VkBuffer       stagingBuffer;
-	VkDeviceMemory stagingBufferMemory;
+	// raytrace.rchit reads 16-bit indices in pairs, so an odd index count still needs the whole last uint
 	CreateBuffer(
-	        bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-	        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer,
-	        stagingBufferMemory
+	        AlignUp(bufferSize, 4),
+	        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | GetGeometryBufferUsage(),
+	        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_IndexBuffer, m_IndexBufferAllocation
 	);
 
-	void *data;
-	vkMapMemory(m_Device, stagingBufferMemory, 0, bufferSize, 0, &data);
-	memcpy(data, INDICES.data(), bufferSize);
-	vkUnmapMemory(m_Device, stagingBufferMemory);
-
-	CreateBuffer(
-	        bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-	        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_IndexBuffer, m_IndexBufferMemory
+	m_SceneUploadTicket = m_UploadManager.Enqueue(
+	        m_IndexBuffer, 0, m_SceneStreams.GetIndexData(), bufferSize,
+	        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | GetGeometryReadStages(),
+	        VK_ACCESS_INDEX_READ_BIT | GetGeometryReadAccess()
 	);
-
-	CopyBuffer(stagingBuffer, m_IndexBuffer, bufferSize);
-
-	vkDestroyBuffer(m_Device, stagingBuffer, nullptr);
-	vkFreeMemory(m_Device, stagingBufferMemory, nullptr);
-}
-
-void Application::CreateBuffer(
-        VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer,
-        VkDeviceMemory &bufferMemory
-) {
-	VkBufferCreateInfo bufferInfo{};
-	bufferInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-	bufferInfo.size        = size;
-	bufferInfo.usage       = usage;
-	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-	if (const VkResult result{vkCreateBuffer(m_Device, &bufferInfo, nullptr, &buffer)}; result != VK_SUCCESS) {
-		throw std::runtime_error{std::string{"Failed to create buffer: "} + string_VkResult(result)};
-	}
-
-	VkMemoryRequirements memoryRequirements;
-	vkGetBufferMemoryRequirements(m_Device, buffer, &memoryRequirements);
-
-	VkMemoryAllocateInfo memoryAllocateInfo{};
-	memoryAllocateInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	memoryAllocateInfo.allocationSize  = memoryRequirements.size;
-	memoryAllocateInfo.memoryTypeIndex = FindMemoryType(memoryRequirements.memoryTypeBits, properties);
-
-	if (const VkResult result{vkAllocateMemory(m_Device, &memoryAllocateInfo, nullptr, &bufferMemory)};
-	    result != VK_SUCCESS) {
-		throw std::runtime_error{std::string{"Failed to allocate memory: "} + string_VkResult(result)};
-	}
-
-	vkBindBufferMemory(m_Device, buffer, bufferMemory, 0);
 }
 
-void Application::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
-	VkCommandBufferAllocateInfo allocateInfo{};
-	allocateInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	allocateInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	allocateInfo.commandPool        = m_CommandPool;
-	allocateInfo.commandBufferCount = 1;
-
-	VkCommandBuffer commandBuffer;
-	vkAllocateCommandBuffers(m_Device, &allocateInfo, &commandBuffer);
-
-	VkCommandBufferBeginInfo beginInfo{};
-	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-	vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-	VkBufferCopy copyRegion{};
-	copyRegion.srcOffset = 0;
-	copyRegion.dstOffset = 0;
-	copyRegion.size      = size;
-	vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-	vkEndCommandBuffer(commandBuffer);
-
-	VkSubmitInfo submitInfo{};
-	submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers    = &commandBuffer;
-
-	vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-	vkQueueWaitIdle(m_GraphicsQueue);
-
-	vkFreeCommandBuffers(m_Device, m_CommandPool, 1, &commandBuffer);
+void Application::CreateBottomLevelAccelerationStructures() {
+	BlasTriangleGeometry geometry{};
+	geometry.vertexAddress = m_Allocator.GetDeviceAddress(m_VertexBuffer);
+	geometry.vertexFormat  = VK_FORMAT_R32G32B32_SFLOAT;
+	geometry.vertexStride  = sizeof(Vertex);
+	geometry.maxVertex     = static_cast<uint32_t>(m_SceneStreams.vertices.size() - 1);
+	geometry.indexAddress  = m_Allocator.GetDeviceAddress(m_IndexBuffer);
+	geometry.indexType     = m_SceneStreams.GetIndexType();
+	geometry.triangleCount = static_cast<uint32_t>(m_SceneStreams.GetIndexCount() / 3);
+
+	m_SceneBlas = m_BlasBuilder.Add({geometry});
+	m_BlasBuilder.Build(m_CommandPool, m_GraphicsQueue);
+
+	m_Metrics.blas = m_BlasBuilder.GetStatistics();
+	std::cout << m_Metrics.blas << '\n';
 }
 
-uint32_t Application::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
-	VkPhysicalDeviceMemoryProperties memoryProperties;
-	vkGetPhysicalDeviceMemoryProperties(m_PhysicalDevice, &memoryProperties);
+void Application::CreateTopLevelAccelerationStructure() {
+	m_TlasManager.Init(m_PhysicalDevice, m_Device, m_Allocator, m_RayTracingFunctions, m_Scene.instanceCount);
 
-	//TODO: prefer vram resource
-	for (uint32_t i{0}; i < memoryProperties.memoryTypeCount; i++) {
-		if (typeFilter & (1 << i) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-			return i;
-		}
+	for (uint32_t i{0}; i < m_Scene.instanceCount; ++i) {
+		static_cast<void>(m_TlasManager.AddInstance(m_BlasBuilder.Get(m_SceneBlas), m_Scene.GetInstanceTransform(i)));
 	}
-
-	throw std::runtime_error{"Failed to find a suitable memory type"};
 }
 
-VkShaderModule Application::CreateShaderModule(std::vector<char> &&code) {
-	VkShaderModuleCreateInfo createInfo{};
-	createInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-	createInfo.codeSize = code.size();
-	createInfo.pCode    = reinterpret_cast<const uint32_t *>(code.data());
-
-	VkShaderModule shaderModule{};
-	if (const VkResult result{vkCreateShaderModule(m_Device, &createInfo, nullptr, &shaderModule)};
-	    result != VK_SUCCESS) {
-		throw std::runtime_error{std::string{"Failed to create shader module: "} + string_VkResult(result)};
-	}
+void Application::CreateBuffer(
+        VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer,
+        Allocation &bufferAllocation
+) {
+	m_Allocator.CreateBuffer(size, usage, properties, buffer, bufferAllocation);
+}
 
-	return shaderModule;
+void Application::DestroyBuffer(VkBuffer &buffer, Allocation &bufferAllocation) {
+	m_Allocator.DestroyBuffer(buffer, bufferAllocation);
 }
 
 QueueFamilyIndices Application::FindQueueFamilies(VkPhysicalDevice device) {
@@ -962,23 +1532,34 @@ QueueFamilyIndices Application::FindQueueFamilies(VkPhysicalDevice device) {
 	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
 	vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
 
-	for (int idx{}; idx < queueFamilies.size(); ++idx) {
-		VkBool32 presentSupport{false};
-		vkGetPhysicalDeviceSurfaceSupportKHR(device, idx, m_Surface, &presentSupport);
+	for (uint32_t idx{}; idx < queueFamilies.size(); ++idx) {
+		const VkQueueFlags queueFlags{queueFamilies[idx].queueFlags};
 
-		if (presentSupport) {
-			indices.presentFamily = idx;
-		}
+		if (!indices.IsComplete()) {
+			// Without a surface nothing is presented, the graphics family stands in so the rest stays uniform
+			VkBool32 presentSupport{m_Config.headless && (queueFlags & VK_QUEUE_GRAPHICS_BIT)};
+			if (!m_Config.headless)
+				vkGetPhysicalDeviceSurfaceSupportKHR(device, idx, m_Surface, &presentSupport);
+
+			if (presentSupport) {
+				indices.presentFamily = idx;
+			}
 
-		if (queueFamilies[idx].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-			indices.graphicsFamily = idx;
+			if (queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+				indices.graphicsFamily = idx;
+			}
 		}
 
-		if (indices.IsComplete()) {
-			break;
+		// Transfer-only families map to the DMA engines and can copy while the graphics queue keeps rendering
+		if (!indices.transferFamily.has_value() && (queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+		    !(queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+			indices.transferFamily = idx;
 		}
 	}
 
+	if (!indices.transferFamily.has_value())
+		indices.transferFamily = indices.graphicsFamily;
+
 	return indices;
 }
 
@@ -998,14 +1579,28 @@ VkSurfaceFormatKHR Application::ChooseSwapSurfaceFormat(const std::vector<VkSurf
 	return availableFormats.front();
 }
 
-VkPresentModeKHR Application::ChooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes) {
-	const auto presentModeIterator{std::find_if(
-	        availablePresentModes.cbegin(), availablePresentModes.cend(),
-	        [](const VkPresentModeKHR &presentMode) { return presentMode == VK_PRESENT_MODE_MAILBOX_KHR; }
-	)};
+VkPresentModeKHR
+Application::ChooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes, PresentPolicy policy) {
+	std::vector<VkPresentModeKHR> preferredPresentModes{};
+
+	switch (policy) {
+		case PresentPolicy::Throughput:
+			preferredPresentModes = {
+			        VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR
+			};
+			break;
+		case PresentPolicy::Vsync:
+			break;
+		case PresentPolicy::LowLatency:
+			// Mailbox replaces a queued image instead of waiting behind it, the newest frame is always the one shown
+			preferredPresentModes = {VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR};
+			break;
+	}
 
-	if (presentModeIterator != availablePresentModes.cend()) {
-		return *presentModeIterator;
+	for (const VkPresentModeKHR presentMode: preferredPresentModes) {
+		if (std::find(availablePresentModes.cbegin(), availablePresentModes.cend(), presentMode) !=
+		    availablePresentModes.cend())
+			return presentMode;
 	}
 
 	return VK_PRESENT_MODE_FIFO_KHR;
@@ -1032,6 +1627,11 @@ VkExtent2D Application::ChooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabil
 	return actualExtent;
 }
 
+VkImageLayout Application::GetTargetFinalLayout() const noexcept {
+	// Offscreen targets are copied out after the frame instead of being presented
+	return m_Config.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+}
+
 SwapChainSupportDetails Application::QuerySwapChainSupport(VkPhysicalDevice device) {
 	SwapChainSupportDetails details{};
 
@@ -1056,23 +1656,91 @@ SwapChainSupportDetails Application::QuerySwapChainSupport(VkPhysicalDevice devi
 	return details;
 }
 
-bool Application::IsDeviceSuitable(VkPhysicalDevice device) {
+uint64_t Application::ScorePhysicalDevice(VkPhysicalDevice device) {
 	VkPhysicalDeviceProperties deviceProperties;
 	vkGetPhysicalDeviceProperties(device, &deviceProperties);
 
-	VkPhysicalDeviceFeatures deviceFeatures{};
-	vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
+	if (deviceProperties.apiVersion < VK_API_VERSION_1_2)
+		return 0;
+
+	// Frame pacing and uploads are built on timeline semaphores
+	VkPhysicalDeviceVulkan12Features vulkan12Features{};
+	vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+	VkPhysicalDeviceFeatures2 deviceFeatures{};
+	deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	deviceFeatures.pNext = &vulkan12Features;
+	vkGetPhysicalDeviceFeatures2(device, &deviceFeatures);
+
+	const QueueFamilyIndices indices{FindQueueFamilies(device)};
+
+	if (!vulkan12Features.timelineSemaphore || !indices.IsComplete() || !CheckDeviceExtensionSupport(device))
+		return 0;
+
+	if (!m_Config.headless) {
+		const SwapChainSupportDetails swapChainSupport{QuerySwapChainSupport(device)};
+
+		if (swapChainSupport.formats.empty() || swapChainSupport.presentModes.empty())
+			return 0;
+	}
+
+	const bool rayTracing{CheckRayTracingSupport(device)};
+	if (m_Config.renderer == Renderer::RayTracing && (!rayTracing || !BindlessTable::IsSupported(device)))
+		return 0;
+
+	uint64_t deviceTypeRank{};
+	switch (deviceProperties.deviceType) {
+		case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+			deviceTypeRank = 4;
+			break;
+		case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+			deviceTypeRank = 3;
+			break;
+		case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+			deviceTypeRank = 2;
+			break;
+		default:
+			deviceTypeRank = 1;
+			break;
+	}
+
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(device, &memoryProperties);
+
+	VkDeviceSize deviceLocalBytes{0};
+	for (uint32_t i{0}; i < memoryProperties.memoryHeapCount; ++i) {
+		if (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+			deviceLocalBytes = std::max(deviceLocalBytes, memoryProperties.memoryHeaps[i].size);
+	}
+
+	// Uploads overlap rendering on a dedicated transfer family, presenting from the graphics family saves a transfer
+	// of ownership
+	const bool dedicatedTransfer{indices.transferFamily != indices.graphicsFamily};
+	const bool sharedPresent{indices.presentFamily == indices.graphicsFamily};
+
+	// Each criterion only breaks ties of the ones before it, heap sizes are counted in MiB to leave room for them
+	constexpr uint64_t MAX_DEVICE_LOCAL_MIB{(uint64_t{1} << 40) - 1};
+
+	return deviceTypeRank << 48 | uint64_t{rayTracing} << 47 |
+	       std::min(deviceLocalBytes >> 20, MAX_DEVICE_LOCAL_MIB) << 2 | uint64_t{dedicatedTransfer} << 1 |
+	       uint64_t{sharedPresent};
+}
+
+bool Application::MatchesDeviceOverride(VkPhysicalDevice device) const {
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(device, &deviceProperties);
 
-	const bool extensionsSupported{CheckDeviceExtensionSupport(device)};
+	if (std::string_view{deviceProperties.deviceName}.find(m_Config.device) != std::string_view::npos)
+		return true;
 
-	bool swapChainAdequate{false};
-	if (extensionsSupported) {
-		SwapChainSupportDetails swapChainSupport{QuerySwapChainSupport(device)};
-		swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
+	// UUIDs are accepted in any case and with or without the usual dashes
+	std::string uuid{};
+	for (const char character: m_Config.device) {
+		if (character != '-')
+			uuid += static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
 	}
 
-	return deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU && deviceFeatures.geometryShader &&
-	       FindQueueFamilies(device).IsComplete() && CheckDeviceExtensionSupport(device) && swapChainAdequate;
+	return uuid == GetDeviceUuid(device);
 }
 
 VkResult Application::CreateDebugUtilsMessengerEXT(
@@ -1114,7 +1782,7 @@ void Application::PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateIn
 	createInfo.pUserData       = nullptr;
 }
 
-bool Application::CheckDeviceExtensionSupport(VkPhysicalDevice device) {
+bool Application::CheckDeviceExtensionSupport(VkPhysicalDevice device) const {
 	uint32_t extensionCount;
 	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
 
@@ -1130,33 +1798,84 @@ bool Application::CheckDeviceExtensionSupport(VkPhysicalDevice device) {
 	);
 	std::cout << '\n';
 
-	std::set<std::string_view> requiredExtensions(DEVICE_EXTENSIONS.cbegin(), DEVICE_EXTENSIONS.cend());
+	return SupportsDeviceExtensions(device, GetRequiredDeviceExtensions());
+}
+
+bool Application::SupportsDeviceExtensions(VkPhysicalDevice device, std::span<const char *const> extensions) {
+	uint32_t extensionCount;
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+	std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+	std::set<std::string_view> requiredExtensions(extensions.begin(), extensions.end());
 
 	for (const auto &extension: availableExtensions) { requiredExtensions.erase(extension.extensionName); }
 
 	return requiredExtensions.empty();
 }
 
-constexpr VkVertexInputBindingDescription Vertex::GetBindingDescription() {
-	VkVertexInputBindingDescription bindingDescription{};
-	bindingDescription.binding   = 0;
-	bindingDescription.stride    = sizeof(Vertex);
-	bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+bool Application::CheckRayTracingSupport(VkPhysicalDevice device) {
+	if (!SupportsDeviceExtensions(device, RAY_TRACING_DEVICE_EXTENSIONS))
+		return false;
+
+	VkPhysicalDeviceRayTracingPipelineFeaturesKHR rayTracingPipelineFeatures{};
+	rayTracingPipelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_FEATURES_KHR;
 
-	return bindingDescription;
+	VkPhysicalDeviceAccelerationStructureFeaturesKHR accelerationStructureFeatures{};
+	accelerationStructureFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR;
+	accelerationStructureFeatures.pNext = &rayTracingPipelineFeatures;
+
+	VkPhysicalDeviceVulkan12Features vulkan12Features{};
+	vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	vulkan12Features.pNext = &accelerationStructureFeatures;
+
+	VkPhysicalDeviceFeatures2 features{};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &vulkan12Features;
+	vkGetPhysicalDeviceFeatures2(device, &features);
+
+	// The TLAS is bound through the bindless table
+	return vulkan12Features.bufferDeviceAddress && accelerationStructureFeatures.accelerationStructure &&
+	       accelerationStructureFeatures.descriptorBindingAccelerationStructureUpdateAfterBind &&
+	       rayTracingPipelineFeatures.rayTracingPipeline;
+}
+
+bool Application::CheckPresentWaitSupport(VkPhysicalDevice device) {
+	if (!SupportsDeviceExtensions(device, PRESENT_WAIT_DEVICE_EXTENSIONS))
+		return false;
+
+	VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+	presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+	VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+	presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+	presentIdFeatures.pNext = &presentWaitFeatures;
+
+	VkPhysicalDeviceFeatures2 features{};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &presentIdFeatures;
+	vkGetPhysicalDeviceFeatures2(device, &features);
+
+	return presentIdFeatures.presentId && presentWaitFeatures.presentWait;
 }
 
-constexpr std::array<VkVertexInputAttributeDescription, 2> Vertex::GetAttributeDescriptions() {
-	std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
-	attributeDescriptions[0].binding  = 0;
-	attributeDescriptions[0].location = 0;
-	attributeDescriptions[0].format   = VK_FORMAT_R32G32_SFLOAT;
-	attributeDescriptions[0].offset   = offsetof(Vertex, pos);
+std::string Application::GetDeviceUuid(VkPhysicalDevice device) {
+	VkPhysicalDeviceIDProperties idProperties{};
+	idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
 
-	attributeDescriptions[1].binding  = 0;
-	attributeDescriptions[1].location = 1;
-	attributeDescriptions[1].format   = VK_FORMAT_R32G32B32_SFLOAT;
-	attributeDescriptions[1].offset   = offsetof(Vertex, color);
+	VkPhysicalDeviceProperties2 properties{};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &idProperties;
+	vkGetPhysicalDeviceProperties2(device, &properties);
+
+	constexpr std::string_view HEX_DIGITS{"0123456789abcdef"};
+
+	std::string uuid{};
+	for (const uint8_t byte: idProperties.deviceUUID) {
+		uuid += HEX_DIGITS[byte >> 4];
+		uuid += HEX_DIGITS[byte & 0xF];
+	}
 
-	return attributeDescriptions;
+	return uuid;
 }
@@ -2,27 +2,42 @@
 #define PORTAL2RAYTRACED_APPLICATION_H
 
 #define GLFW_INCLUDE_VULKAN
+#include "ApplicationConfig.h"
+#include "BindlessTable.h"
+#include "BlasBuilder.h"
+#include "CommandRecorder.h"
+#include "CookedScene.h"
+#include "CpuRenderer.h"
+#include "DeletionQueue.h"
+#include "FramePacer.h"
+#include "FrameRingBuffer.h"
+#include "FrameTimeline.h"
+#include "MemoryAllocator.h"
+#include "PipelineBuilder.h"
+#include "PipelineCache.h"
+#include "Profiler.h"
+#include "RayTracingFunctions.h"
+#include "RayTracingPass.h"
+#include "Scene.h"
+#include "ShaderLibrary.h"
+#include "ThreadPool.h"
+#include "TlasManager.h"
+#include "UploadManager.h"
 #include <GLFW/glfw3.h>
 #include <array>
-#include <glm\glm.hpp>
+#include <chrono>
+#include <future>
 #include <optional>
+#include <span>
+#include <string>
 #include <string_view>
 #include <vector>
 
-// TODO: avoid vkAllocateMemory calls, instead group with custom allocator and use an offset
-
-struct Vertex {
-	glm::vec2 pos{};
-	glm::vec3 color{};
-
-	constexpr static VkVertexInputBindingDescription GetBindingDescription();
-
-	constexpr static std::array<VkVertexInputAttributeDescription, 2> GetAttributeDescriptions();
-};
-
 struct QueueFamilyIndices {
 	std::optional<uint32_t> graphicsFamily{};
 	std::optional<uint32_t> presentFamily{};
+	// Falls back to the graphics family when the device has no dedicated transfer family
+	std::optional<uint32_t> transferFamily{};
 
 	[[nodiscard]]
 	bool IsComplete() const noexcept {
@@ -36,10 +51,36 @@ struct SwapChainSupportDetails {
 	std::vector<VkPresentModeKHR>   presentModes{};
 };
 
+// Gathered right before teardown so a finished Run can still be inspected, e.g. by renderer_bench.
+struct RunMetrics {
+	std::string                   deviceName{};
+	std::vector<TimingStatistics> timings{};
+	VkDeviceSize                  uploadBytes{};
+	double                        uploadMilliseconds{};
+	PipelineCacheStatistics       pipelineCache{};
+	MemoryAllocatorStatistics     memory{};
+	BlasBuildStatistics           blas{};
+	TlasStatistics                tlas{};
+	DeletionQueueStatistics       deletionQueue{};
+	PresentStatistics             present{};
+	CpuRenderStatistics           cpu{};
+	// Progressive renderers only, for the CPU renderer a copy of cpu.accumulation
+	AccumulationStatistics accumulation{};
+};
+
 class Application final {
 public:
+	// Throws std::invalid_argument when the configured scene does not exist and std::runtime_error when the configured
+	// mesh or cooked scene file cannot be loaded.
+	explicit Application(ApplicationConfig config);
+
 	void Run();
 
+	[[nodiscard]]
+	const RunMetrics &GetMetrics() const noexcept {
+		return m_Metrics;
+	}
+
 	static VKAPI_ATTR VkBool32 DebugCallback(
 	        VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType,
 	        const VkDebugUtilsMessengerCallbackDataEXT *pCallbackData, void *pUserData
@@ -57,6 +98,9 @@ private:
 
 	void Cleanup();
 
+	// Renders m_Config.frameCount frames with the CPU renderer and writes the last one, Vulkan is never touched
+	void RunCpu();
+
 	// Helper
 	void CreateInstance();
 
@@ -72,6 +116,13 @@ private:
 
 	void CreateImageViews();
 
+	void CreateOffscreenTargets();
+
+	// One depth image is enough for every frame in flight, the render pass orders their depth writes
+	void CreateDepthResources();
+
+	void ReadbackOffscreenImage();
+
 	void CreateGraphicsPipeline();
 
 	void CreateRenderPass();
@@ -84,8 +135,14 @@ private:
 
 	void RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
 
+	void RecordRasterPass(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+
+	// Binds everything the raster pipeline needs and draws instances [firstInstance, firstInstance + instanceCount)
+	void RecordRasterDraws(VkCommandBuffer commandBuffer, uint32_t firstInstance, uint32_t instanceCount);
+
 	void CreateSyncObjects();
 
+	// Builds the new swap chain from the current one while frames keep running, the old one goes to m_DeletionQueue
 	void RecreateSwapChain();
 
 	void CleanupSwapChain();
@@ -94,17 +151,16 @@ private:
 
 	void CreateIndexBuffer();
 
+	void CreateBottomLevelAccelerationStructures();
+
+	void CreateTopLevelAccelerationStructure();
+
 	void CreateBuffer(
 	        VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer,
-	        VkDeviceMemory &bufferMemory
+	        Allocation &bufferAllocation
 	);
 
-	void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
-
-	uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
-
-	[[nodiscard]]
-	VkShaderModule CreateShaderModule(std::vector<char> &&code);
+	void DestroyBuffer(VkBuffer &buffer, Allocation &bufferAllocation);
 
 	[[nodiscard]]
 	QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device);
@@ -112,17 +168,39 @@ private:
 	[[nodiscard]]
 	SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice device);
 
+	// 0 for devices that can not run the configured renderer. Otherwise device type dominates, so any GPU beats a CPU
+	// implementation, then ray tracing support, then the largest device local heap and last the queue layout.
+	[[nodiscard]]
+	uint64_t ScorePhysicalDevice(VkPhysicalDevice device);
+
 	[[nodiscard]]
-	bool IsDeviceSuitable(VkPhysicalDevice device);
+	bool MatchesDeviceOverride(VkPhysicalDevice device) const;
 
 	[[nodiscard]]
 	VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities);
 
-	// Static
-	static void FramebufferResizeCallback(GLFWwindow *pWindow, int width, int height);
+	// Layout every frame leaves its target image in, ready to present or to copy out offscreen
+	[[nodiscard]]
+	VkImageLayout GetTargetFinalLayout() const noexcept;
 
+	// Scene buffers only take part in acceleration structure builds where the device supports ray tracing
 	[[nodiscard]]
-	static std::vector<char> ReadFile(std::string_view fileName);
+	VkBufferUsageFlags GetGeometryBufferUsage() const noexcept {
+		return m_RayTracingEnabled ? GEOMETRY_BUFFER_USAGE : 0;
+	}
+
+	[[nodiscard]]
+	VkPipelineStageFlags GetGeometryReadStages() const noexcept {
+		return m_RayTracingEnabled ? VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR : 0;
+	}
+
+	[[nodiscard]]
+	VkAccessFlags GetGeometryReadAccess() const noexcept {
+		return m_RayTracingEnabled ? VK_ACCESS_SHADER_READ_BIT : 0;
+	}
+
+	// Static
+	static void FramebufferResizeCallback(GLFWwindow *pWindow, int width, int height);
 
 	[[nodiscard]]
 	static bool CheckValidationLayerSupport();
@@ -130,13 +208,18 @@ private:
 	[[nodiscard]]
 	static VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &availableFormats);
 
+	// Takes the first mode in the policy's order of preference the surface supports, FIFO is always supported.
 	[[nodiscard]]
-	static VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes);
+	static VkPresentModeKHR
+	ChooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes, PresentPolicy policy);
 
 	static void PrintAvailableInstanceExtensions();
 
 	[[nodiscard]]
-	static std::vector<const char *> GetRequiredExtensions();
+	std::vector<const char *> GetRequiredExtensions() const;
+
+	[[nodiscard]]
+	std::vector<const char *> GetRequiredDeviceExtensions() const;
 
 	[[nodiscard]]
 	static VkResult CreateDebugUtilsMessengerEXT(
@@ -151,7 +234,22 @@ private:
 	static void PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
 
 	[[nodiscard]]
-	static bool CheckDeviceExtensionSupport(VkPhysicalDevice device);
+	bool CheckDeviceExtensionSupport(VkPhysicalDevice device) const;
+
+	[[nodiscard]]
+	static bool SupportsDeviceExtensions(VkPhysicalDevice device, std::span<const char *const> extensions);
+
+	// Required by the rt renderer only, the raster renderer keeps building acceleration structures where available.
+	[[nodiscard]]
+	static bool CheckRayTracingSupport(VkPhysicalDevice device);
+
+	// VK_KHR_present_id and VK_KHR_present_wait are optional, they only add present latency measurements.
+	[[nodiscard]]
+	static bool CheckPresentWaitSupport(VkPhysicalDevice device);
+
+	// Lowercase hex without separators, as accepted by --device
+	[[nodiscard]]
+	static std::string GetDeviceUuid(VkPhysicalDevice device);
 
 #ifdef NDEBUG
 	static constexpr bool ENABLE_VALIDATION_LAYERS{false};
@@ -159,54 +257,114 @@ private:
 	static constexpr bool ENABLE_VALIDATION_LAYERS{true};
 #endif
 
-	static constexpr int                         WINDOW_WIDTH{800}, WINDOW_HEIGHT{600};
 	static constexpr std::string_view            WINDOW_TITLE{"Vulkan"};
 	static constexpr std::array<const char *, 1> VALIDATION_LAYERS{"VK_LAYER_KHRONOS_validation"};
 	static constexpr std::array<const char *, 0> INSTANCE_EXTENSIONS{};
-	static constexpr std::array<const char *, 6> DEVICE_EXTENSIONS{
-	        VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+	static constexpr std::array<const char *, 1> PRESENTATION_DEVICE_EXTENSIONS{VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+	static constexpr std::array<const char *, 2> PRESENT_WAIT_DEVICE_EXTENSIONS{
+	        VK_KHR_PRESENT_ID_EXTENSION_NAME, VK_KHR_PRESENT_WAIT_EXTENSION_NAME
+	};
+	// Only enabled on Vulkan 1.2 devices, pipeline creation feedback is core from 1.3 on
+	static constexpr std::array<const char *, 1> PIPELINE_CREATION_FEEDBACK_DEVICE_EXTENSIONS{
+	        VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME
+	};
+	static constexpr std::array<const char *, 5> RAY_TRACING_DEVICE_EXTENSIONS{
 	        VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME,
 	        VK_KHR_RAY_TRACING_PIPELINE_EXTENSION_NAME,
 	        VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
 	        VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME,
 	        VK_KHR_SPIRV_1_4_EXTENSION_NAME
 	};
-	static constexpr int                   MAX_FRAMES_IN_FLIGHT{2};
-	static constexpr std::array<Vertex, 4> VERTICES{
-	        Vertex{{-0.5f, -0.5f}, {1.0f, 0.0f, 0.0f}}, Vertex{{0.5f, -0.5f}, {0.0f, 1.0f, 0.0f}},
-	        Vertex{{0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}}, Vertex{{-0.5f, 0.5f}, {1.0f, 1.0f, 1.0f}}
+	static constexpr VkFormat         OFFSCREEN_FORMAT{VK_FORMAT_R8G8B8A8_SRGB};
+	// In order of preference, every device supports at least one of them as a depth attachment
+	static constexpr std::array<VkFormat, 3> DEPTH_FORMATS{
+	        VK_FORMAT_D32_SFLOAT, VK_FORMAT_X8_D24_UNORM_PACK32, VK_FORMAT_D16_UNORM
+	};
+	static constexpr const char      *SHADER_DIRECTORY_VARIABLE{"PORTAL2RAYTRACED_SHADER_DIR"};
+	// Fewer instances than this per worker are not worth a secondary command buffer
+	static constexpr uint32_t MIN_INSTANCES_PER_RECORDING_CHUNK{1024};
+	// A suboptimal swap chain is only recreated once the window size stopped changing for this long, so a drag-resize
+	// recreates it once instead of every frame. Out of date swap chains can not present and are recreated right away
+	static constexpr std::chrono::milliseconds RESIZE_SETTLE_TIME{100};
+	// Animation time added per frame with --animate, independent of the real frame time so runs are reproducible
+	static constexpr float ANIMATION_TIME_STEP{1.f / 60.f};
+	// Lets the ray tracing side read the scene buffers as build inputs and through device addresses
+	static constexpr VkBufferUsageFlags GEOMETRY_BUFFER_USAGE{
+	        VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
+	        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
 	};
-	static constexpr std::array<uint16_t, 6> INDICES{0, 1, 2, 2, 3, 0};
-
-	VkInstance                 m_Instance{};
-	VkDebugUtilsMessengerEXT   m_DebugMessenger{};
-	GLFWwindow                *m_pWindow{};
-	VkPhysicalDevice           m_PhysicalDevice{VK_NULL_HANDLE};
-	VkDevice                   m_Device{};
-	VkSurfaceKHR               m_Surface{};
-	VkQueue                    m_GraphicsQueue{};
-	VkQueue                    m_PresentQueue{};
-	VkSwapchainKHR             m_SwapChain{};
-	std::vector<VkImage>       m_SwapChainImages{};
-	VkFormat                   m_SwapChainImageFormat{};
-	VkExtent2D                 m_SwapChainExtent{};
-	std::vector<VkImageView>   m_SwapChainImageViews{};
-	VkRenderPass               m_RenderPass{};
-	VkPipelineLayout           m_PipelineLayout{};
-	VkPipeline                 m_GraphicsPipeline{};
-	std::vector<VkFramebuffer> m_SwapChainFramebuffers{};
-	VkCommandPool              m_CommandPool{};
-	uint32_t                   m_CurrentFrame{0};
-	bool                       m_FramebufferResized{false};
-	VkBuffer                   m_VertexBuffer{};
-	VkDeviceMemory             m_VertexBufferMemory{};
-	VkBuffer                   m_IndexBuffer{};
-	VkDeviceMemory             m_IndexBufferMemory{};
-
-	std::array<VkCommandBuffer, MAX_FRAMES_IN_FLIGHT> m_CommandBuffers{};
-	std::array<VkSemaphore, MAX_FRAMES_IN_FLIGHT>     m_ImageAvailableSemaphores{};
-	std::array<VkSemaphore, MAX_FRAMES_IN_FLIGHT>     m_RenderFinishedSemaphores{};
-	std::array<VkFence, MAX_FRAMES_IN_FLIGHT>         m_InFlightFences{};
+
+	ApplicationConfig              m_Config{};
+	Scene                          m_Scene{};
+	CookedScene                    m_CookedScene{};
+	// Geometry of m_Scene, or the mapping of m_CookedScene when one is open
+	SceneStreams                   m_SceneStreams{};
+	RunMetrics                     m_Metrics{};
+	VkInstance                     m_Instance{};
+	VkDebugUtilsMessengerEXT       m_DebugMessenger{};
+	GLFWwindow                    *m_pWindow{};
+	VkPhysicalDevice               m_PhysicalDevice{VK_NULL_HANDLE};
+	// Acceleration structures are only built where the device supports them, always true for the rt renderer
+	bool                           m_RayTracingEnabled{false};
+	// Core or extension, without it pipeline cache hits are unknown
+	bool                           m_PipelineCreationFeedback{false};
+	VkDevice                       m_Device{};
+	VkSurfaceKHR                   m_Surface{};
+	VkQueue                        m_GraphicsQueue{};
+	VkQueue                        m_PresentQueue{};
+	VkQueue                        m_TransferQueue{};
+	VkSwapchainKHR                 m_SwapChain{};
+	std::vector<VkImage>           m_SwapChainImages{};
+	VkFormat                       m_SwapChainImageFormat{};
+	VkExtent2D                     m_SwapChainExtent{};
+	std::vector<VkImageView>       m_SwapChainImageViews{};
+	std::vector<Allocation>        m_OffscreenImageAllocations{};
+	VkFormat                       m_DepthFormat{};
+	VkImage                        m_DepthImage{};
+	Allocation                     m_DepthImageAllocation{};
+	VkImageView                    m_DepthImageView{};
+	VkRenderPass                   m_RenderPass{};
+	ThreadPool                     m_ThreadPool{};
+	ShaderLibrary                  m_ShaderLibrary{};
+	PipelineCache                  m_PipelineCache{};
+	PipelineBuilder                m_PipelineBuilder{};
+	VkPipelineLayout               m_PipelineLayout{};
+	std::shared_future<VkPipeline> m_GraphicsPipelineFuture{};
+	VkPipeline                     m_GraphicsPipeline{};
+	std::vector<VkFramebuffer>     m_SwapChainFramebuffers{};
+	// One-off work like BLAS builds and readbacks, frames record through m_CommandRecorder
+	VkCommandPool                  m_CommandPool{};
+	CommandRecorder                m_CommandRecorder{};
+	FrameTimeline                  m_FrameTimeline{};
+	FramePacer                     m_FramePacer{};
+	// Slot of the frame being recorded, indexes everything that exists once per frame in flight
+	uint32_t                       m_CurrentFrame{0};
+	// Seconds into the instance animation of the frame being recorded, stays 0 without --animate
+	float                          m_AnimationTime{0.f};
+	MemoryAllocator                m_Allocator{};
+	// Keyed by m_FrameTimeline values, anything replaced while frames are in flight is destroyed through it
+	DeletionQueue                  m_DeletionQueue{};
+	BindlessTable                  m_BindlessTable{};
+	UploadManager                  m_UploadManager{};
+	UploadTicket                   m_SceneUploadTicket{};
+	FrameRingBuffer                m_FrameRing{};
+	Profiler                       m_Profiler{};
+	VkBuffer                       m_VertexBuffer{};
+	Allocation                     m_VertexBufferAllocation{};
+	VkBuffer                       m_IndexBuffer{};
+	Allocation                     m_IndexBufferAllocation{};
+	RayTracingFunctions            m_RayTracingFunctions{};
+	BlasBuilder                    m_BlasBuilder{};
+	uint32_t                       m_SceneBlas{};
+	TlasManager                    m_TlasManager{};
+	RayTracingPass                 m_RayTracingPass{};
+	// Binary, presentation cannot wait on or signal a timeline semaphore
+	std::vector<VkSemaphore>       m_ImageAvailableSemaphores{};
+	std::vector<VkSemaphore>       m_RenderFinishedSemaphores{};
+
+	// Set by the framebuffer size callback and suboptimal presents, see RESIZE_SETTLE_TIME
+	bool                                  m_FramebufferResized{false};
+	std::chrono::steady_clock::time_point m_LastFramebufferResize{};
 };
 
 
@@ -0,0 +1,143 @@
+#include "ApplicationConfig.h"
+#include "CookedScene.h"
+#include "MeshLoader.h"
+#include "Scene.h"
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+
+namespace {
+	uint32_t ParseUnsigned(std::string_view option, std::string_view value) {
+		uint32_t result{};
+		const auto [end, errorCode]{std::from_chars(value.data(), value.data() + value.size(), result)};
+
+		if (errorCode != std::errc{} || end != value.data() + value.size())
+			throw std::invalid_argument{
+			        std::string{option} + " expects an unsigned integer, got " + std::string{value}
+			};
+
+		return result;
+	}
+}// namespace
+
+ApplicationConfig ApplicationConfig::Parse(int argc, const char *const *argv) {
+	ApplicationConfig config{};
+	bool              frameCountSet{false};
+
+	for (int i{1}; i < argc; ++i) {
+		const std::string_view option{argv[i]};
+
+		const auto nextValue{[&]() -> std::string_view {
+			if (i + 1 >= argc)
+				throw std::invalid_argument{std::string{option} + " expects a value"};
+
+			return argv[++i];
+		}};
+
+		if (option == "--help" || option == "-h") {
+			config.showHelp = true;
+		} else if (option == "--headless") {
+			config.headless = true;
+		} else if (option == "--frames") {
+			config.frameCount = ParseUnsigned(option, nextValue());
+			frameCountSet     = true;
+		} else if (option == "--width") {
+			config.width = ParseUnsigned(option, nextValue());
+		} else if (option == "--height") {
+			config.height = ParseUnsigned(option, nextValue());
+		} else if (option == "--frames-in-flight") {
+			config.framesInFlight = ParseUnsigned(option, nextValue());
+		} else if (option == "--present") {
+			const std::string_view name{nextValue()};
+
+			const auto policyIterator{std::find_if(
+			        PRESENT_POLICY_NAMES.cbegin(), PRESENT_POLICY_NAMES.cend(),
+			        [name](const auto &policy) { return policy.first == name; }
+			)};
+
+			if (policyIterator == PRESENT_POLICY_NAMES.cend())
+				throw std::invalid_argument{"Unknown present policy: " + std::string{name}};
+
+			config.presentPolicy = policyIterator->second;
+		} else if (option == "--max-fps") {
+			config.maxFramesPerSecond = ParseUnsigned(option, nextValue());
+		} else if (option == "--scene") {
+			config.scene = nextValue();
+		} else if (option == "--renderer") {
+			const std::string_view name{nextValue()};
+
+			const auto rendererIterator{std::find_if(
+			        RENDERER_NAMES.cbegin(), RENDERER_NAMES.cend(),
+			        [name](const auto &renderer) { return renderer.first == name; }
+			)};
+
+			if (rendererIterator == RENDERER_NAMES.cend())
+				throw std::invalid_argument{"Unknown renderer: " + std::string{name}};
+
+			config.renderer = rendererIterator->second;
+		} else if (option == "--device") {
+			config.device = nextValue();
+		} else if (option == "--tile-size") {
+			config.tileSize = ParseUnsigned(option, nextValue());
+		} else if (option == "--record-threads") {
+			config.recordThreadCount = ParseUnsigned(option, nextValue());
+		} else if (option == "--progressive") {
+			config.progressive = true;
+		} else if (option == "--target-spp") {
+			config.targetSamplesPerPixel = ParseUnsigned(option, nextValue());
+		} else if (option == "--animate") {
+			config.animate = true;
+		} else if (option == "--output") {
+			config.outputPath = nextValue();
+		} else if (option == "--shader-dir") {
+			config.shaderDirectory = nextValue();
+		} else if (option == "--pipeline-cache") {
+			config.pipelineCachePath = nextValue();
+		} else if (option == "--profile-output") {
+			config.profileOutputPath = nextValue();
+		} else {
+			throw std::invalid_argument{"Unknown option: " + std::string{option}};
+		}
+	}
+
+	if (config.width == 0 || config.height == 0)
+		throw std::invalid_argument{"Width and height must be non-zero"};
+
+	if (config.framesInFlight == 0 || config.framesInFlight > FrameTimeline::MAX_FRAMES_IN_FLIGHT)
+		throw std::invalid_argument{
+		        "Frames in flight must be between 1 and " + std::to_string(FrameTimeline::MAX_FRAMES_IN_FLIGHT)
+		};
+
+	if (config.tileSize == 0)
+		throw std::invalid_argument{"Tile size must be non-zero"};
+
+	if (config.targetSamplesPerPixel == 0)
+		throw std::invalid_argument{"Target samples per pixel must be non-zero"};
+
+	// Rasterization is deterministic, averaging identical frames would gain nothing
+	if (config.progressive && config.renderer == Renderer::Raster)
+		throw std::invalid_argument{"--progressive needs the rt or cpu renderer"};
+
+	// The CPU renderer builds its BVH once up front
+	if (config.animate && config.renderer == Renderer::Cpu)
+		throw std::invalid_argument{"--animate needs the raster or rt renderer"};
+
+	// Files are only opened once the application starts, a missing one fails there
+	if (!MeshLoader::IsMeshFile(config.scene) && !CookedScene::IsCookedSceneFile(config.scene) &&
+	    std::find(Scene::NAMES.cbegin(), Scene::NAMES.cend(), config.scene) == Scene::NAMES.cend())
+		throw std::invalid_argument{"Unknown scene: " + config.scene};
+
+	// The CPU renderer has no window to show anything in
+	if (config.renderer == Renderer::Cpu)
+		config.headless = true;
+
+	if (config.headless && !frameCountSet)
+		config.frameCount =
+		        config.renderer == Renderer::Cpu ? DEFAULT_CPU_FRAME_COUNT : DEFAULT_HEADLESS_FRAME_COUNT;
+
+	if (config.headless && config.frameCount == 0)
+		throw std::invalid_argument{"Headless runs need at least one frame"};
+
+	return config;
+}
@@ -0,0 +1,112 @@
+#ifndef PORTAL2RAYTRACED_APPLICATIONCONFIG_H
+#define PORTAL2RAYTRACED_APPLICATIONCONFIG_H
+
+#include "FrameTimeline.h"
+#include "ProgressiveAccumulation.h"
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+enum class Renderer {
+	Raster,
+	RayTracing,
+	// BVH path tracer on the CPU, runs without Vulkan or a window
+	Cpu
+};
+
+enum class PresentPolicy {
+	// Fastest present mode the surface offers, tearing allowed
+	Throughput,
+	// FIFO, frame rate locked to the display
+	Vsync,
+	// Tear-free where possible, frames start only once the previous one reached the display
+	LowLatency
+};
+
+struct ApplicationConfig {
+	bool showHelp{false};
+	// Renders into an offscreen image without creating a window, surface or swap chain
+	bool headless{false};
+	// 0 renders until the window is closed, headless runs always stop after a fixed number of frames
+	uint32_t frameCount{0};
+	uint32_t width{800};
+	uint32_t height{600};
+	// Frames the CPU may record ahead of the GPU, 1 for the lowest latency, 3 for the highest throughput
+	uint32_t framesInFlight{2};
+	// Swap chain present mode and CPU pacing, ignored by headless runs
+	PresentPolicy presentPolicy{PresentPolicy::Throughput};
+	// Upper bound on frame starts per second, 0 for none
+	uint32_t maxFramesPerSecond{0};
+	// One of Scene::NAMES or the path of a .obj, .glb or .cooked file
+	std::string scene{"quad"};
+	Renderer    renderer{Renderer::Raster};
+	// Substring of the device name or its UUID in hex, empty picks the highest scoring device
+	std::string device{};
+	// Edge length of the CPU renderer's tiles, ignored by the Vulkan renderers
+	uint32_t tileSize{32};
+	// Workers recording the raster pass into secondary command buffers, 0 uses every thread pool worker
+	uint32_t recordThreadCount{0};
+	// Keeps averaging samples across frames while nothing changes, rt and cpu renderers only
+	bool     progressive{false};
+	uint32_t targetSamplesPerPixel{ProgressiveAccumulation::DEFAULT_TARGET_SAMPLES_PER_PIXEL};
+	// Moves the scene's instances every frame, which refits the TLAS. Time advances a fixed step per frame, so headless
+	// runs stay reproducible. raster and rt renderers only
+	bool animate{false};
+	// Headless result, .ppm writes a binary PPM, anything else the raw RGBA8 rows
+	std::filesystem::path                outputPath{"output.ppm"};
+	std::optional<std::filesystem::path> shaderDirectory{};
+	// Loaded at startup and replaced on exit, a missing file just means a cold start
+	std::filesystem::path pipelineCachePath{"pipeline_cache.bin"};
+	// Frame timing percentiles are written here on exit, .json writes JSON, anything else CSV
+	std::optional<std::filesystem::path> profileOutputPath{};
+
+	static constexpr uint32_t DEFAULT_HEADLESS_FRAME_COUNT{60};
+	static constexpr uint32_t DEFAULT_CPU_FRAME_COUNT{1};
+
+	static constexpr std::array<std::pair<std::string_view, Renderer>, 3> RENDERER_NAMES{
+	        std::pair{"raster", Renderer::Raster},
+	        std::pair{"rt", Renderer::RayTracing},
+	        std::pair{"cpu", Renderer::Cpu}
+	};
+
+	static constexpr std::array<std::pair<std::string_view, PresentPolicy>, 3> PRESENT_POLICY_NAMES{
+	        std::pair{"throughput", PresentPolicy::Throughput},
+	        std::pair{"vsync", PresentPolicy::Vsync},
+	        std::pair{"low-latency", PresentPolicy::LowLatency}
+	};
+
+	static constexpr std::string_view USAGE{
+	        "Usage: Portal2RayTraced [options]\n"
+	        "  --headless               render offscreen without a window\n"
+	        "  --frames <n>             number of frames to render (headless default 60, cpu default 1)\n"
+	        "  --width <pixels>         render width\n"
+	        "  --height <pixels>        render height\n"
+	        "  --frames-in-flight <n>   frames the CPU may run ahead of the GPU, 1 to 4 (default 2)\n"
+	        "  --present <policy>       throughput (default), vsync or low-latency\n"
+	        "  --max-fps <n>            cap the frame rate (default 0, uncapped)\n"
+	        "  --scene <name>           quad, instances, mesh or a .obj/.glb/.cooked file\n"
+	        "  --renderer <name>        raster, rt (ray tracing pipeline) or cpu (no GPU, implies --headless)\n"
+	        "  --device <name|uuid>     use the Vulkan device whose name contains <name> or whose UUID matches\n"
+	        "  --tile-size <pixels>     cpu renderer tile edge length (default 32)\n"
+	        "  --record-threads <n>     raster command recording workers (default 0, every pool worker)\n"
+	        "  --progressive            accumulate samples across frames (rt and cpu renderers)\n"
+	        "  --target-spp <n>         samples per pixel the convergence time is measured to (default 64)\n"
+	        "  --animate                move the scene's instances every frame (raster and rt renderers)\n"
+	        "  --output <file>          headless output image (.ppm or raw RGBA8)\n"
+	        "  --shader-dir <dir>       load .spv files from <dir> instead of the embedded ones\n"
+	        "  --pipeline-cache <file>  pipeline cache to load and save (default pipeline_cache.bin)\n"
+	        "  --profile-output <file>  write frame timing percentiles on exit (.json or .csv)\n"
+	        "  --help                   show this message\n"
+	};
+
+	// Throws std::invalid_argument on unknown options or malformed values.
+	[[nodiscard]]
+	static ApplicationConfig Parse(int argc, const char *const *argv);
+};
+
+
+#endif//PORTAL2RAYTRACED_APPLICATIONCONFIG_H
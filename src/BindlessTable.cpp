@@ -0,0 +1,316 @@
+#include "BindlessTable.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vulkan/vk_enum_string_helper.h>
+
+namespace {
+	constexpr std::array<VkDescriptorType, 4> DESCRIPTOR_TYPES{
+	        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+	        VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR
+	};
+
+	// The leading BindlessResource types that count against maxPerStageUpdateAfterBindResources
+	constexpr size_t PER_STAGE_RESOURCE_TYPES{3};
+
+	constexpr std::array<const char *, 4> RESOURCE_NAMES{
+	        "storage buffer", "sampled image", "storage image", "acceleration structure"
+	};
+}// namespace
+
+bool BindlessTable::IsSupported(VkPhysicalDevice physicalDevice) {
+	VkPhysicalDeviceVulkan12Features vulkan12Features{};
+	vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+	VkPhysicalDeviceFeatures2 features{};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &vulkan12Features;
+	vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+
+	return features.features.shaderStorageBufferArrayDynamicIndexing &&
+	       features.features.shaderSampledImageArrayDynamicIndexing &&
+	       features.features.shaderStorageImageArrayDynamicIndexing && vulkan12Features.runtimeDescriptorArray &&
+	       vulkan12Features.descriptorBindingPartiallyBound &&
+	       vulkan12Features.descriptorBindingUpdateUnusedWhilePending &&
+	       vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind &&
+	       vulkan12Features.descriptorBindingSampledImageUpdateAfterBind &&
+	       vulkan12Features.descriptorBindingStorageImageUpdateAfterBind;
+}
+
+void BindlessTable::EnableFeatures(
+        VkPhysicalDeviceFeatures &features, VkPhysicalDeviceVulkan12Features &vulkan12Features
+) noexcept {
+	features.shaderStorageBufferArrayDynamicIndexing = VK_TRUE;
+	features.shaderSampledImageArrayDynamicIndexing  = VK_TRUE;
+	features.shaderStorageImageArrayDynamicIndexing  = VK_TRUE;
+
+	vulkan12Features.runtimeDescriptorArray                        = VK_TRUE;
+	vulkan12Features.descriptorBindingPartiallyBound               = VK_TRUE;
+	vulkan12Features.descriptorBindingUpdateUnusedWhilePending     = VK_TRUE;
+	vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+	vulkan12Features.descriptorBindingSampledImageUpdateAfterBind  = VK_TRUE;
+	vulkan12Features.descriptorBindingStorageImageUpdateAfterBind  = VK_TRUE;
+}
+
+void BindlessTable::Init(
+        VkPhysicalDevice physicalDevice, VkDevice device, DeletionQueue &deletionQueue, bool accelerationStructures
+) {
+	m_Device         = device;
+	m_pDeletionQueue = &deletionQueue;
+
+	VkPhysicalDeviceAccelerationStructurePropertiesKHR accelerationStructureProperties{};
+	accelerationStructureProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR;
+
+	VkPhysicalDeviceVulkan12Properties vulkan12Properties{};
+	vulkan12Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+	vulkan12Properties.pNext = accelerationStructures ? &accelerationStructureProperties : nullptr;
+
+	VkPhysicalDeviceProperties2 properties{};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &vulkan12Properties;
+	vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+	uint32_t accelerationStructureLimit{0};
+	if (accelerationStructures)
+		accelerationStructureLimit = std::min(
+		        accelerationStructureProperties.maxDescriptorSetUpdateAfterBindAccelerationStructures,
+		        accelerationStructureProperties.maxPerStageDescriptorUpdateAfterBindAccelerationStructures
+		);
+
+	// Every binding is visible to all stages, so the per stage limits apply as well
+	const std::array<uint32_t, 4> limits{
+	        std::min(
+	                vulkan12Properties.maxDescriptorSetUpdateAfterBindStorageBuffers,
+	                vulkan12Properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers
+	        ),
+	        std::min(
+	                vulkan12Properties.maxDescriptorSetUpdateAfterBindSampledImages,
+	                vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSampledImages
+	        ),
+	        std::min(
+	                vulkan12Properties.maxDescriptorSetUpdateAfterBindStorageImages,
+	                vulkan12Properties.maxPerStageDescriptorUpdateAfterBindStorageImages
+	        ),
+	        accelerationStructureLimit
+	};
+
+	for (size_t i{0}; i < m_Slots.size(); ++i) {
+		m_Slots[i] = Slots{.capacity = std::min(DEFAULT_CAPACITIES[i], limits[i])};
+	}
+
+	// Buffers and images also count against one shared per stage budget, acceleration structures and samplers do not.
+	// When they exceed it together, each array gives up the same share.
+	const uint64_t resourceBudget{vulkan12Properties.maxPerStageUpdateAfterBindResources};
+	uint64_t       resourceCount{0};
+	for (size_t i{0}; i < PER_STAGE_RESOURCE_TYPES; ++i) {
+		resourceCount += m_Slots[i].capacity;
+	}
+
+	if (resourceCount > resourceBudget) {
+		for (size_t i{0}; i < PER_STAGE_RESOURCE_TYPES; ++i) {
+			m_Slots[i].capacity = static_cast<uint32_t>(m_Slots[i].capacity * resourceBudget / resourceCount);
+		}
+	}
+
+	VkSamplerCreateInfo samplerInfo{};
+	samplerInfo.sType        = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter    = VK_FILTER_LINEAR;
+	samplerInfo.minFilter    = VK_FILTER_LINEAR;
+	samplerInfo.mipmapMode   = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	samplerInfo.maxLod       = VK_LOD_CLAMP_NONE;
+
+	if (const VkResult result{vkCreateSampler(m_Device, &samplerInfo, nullptr, &m_Sampler)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to create bindless sampler: "} + string_VkResult(result)};
+	}
+
+	std::vector<VkDescriptorSetLayoutBinding> bindings{};
+	std::vector<VkDescriptorBindingFlags>     bindingFlags{};
+	std::vector<VkDescriptorPoolSize>         poolSizes{};
+
+	for (uint32_t binding{0}; binding < m_Slots.size(); ++binding) {
+		if (m_Slots[binding].capacity == 0)
+			continue;
+
+		VkDescriptorSetLayoutBinding layoutBinding{};
+		layoutBinding.binding         = binding;
+		layoutBinding.descriptorType  = DESCRIPTOR_TYPES[binding];
+		layoutBinding.descriptorCount = m_Slots[binding].capacity;
+		layoutBinding.stageFlags      = VK_SHADER_STAGE_ALL;
+		bindings.emplace_back(layoutBinding);
+
+		bindingFlags.emplace_back(
+		        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+		        VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT
+		);
+
+		poolSizes.emplace_back(VkDescriptorPoolSize{DESCRIPTOR_TYPES[binding], m_Slots[binding].capacity});
+	}
+
+	VkDescriptorSetLayoutBinding samplerBinding{};
+	samplerBinding.binding            = SAMPLER_BINDING;
+	samplerBinding.descriptorType     = VK_DESCRIPTOR_TYPE_SAMPLER;
+	samplerBinding.descriptorCount    = 1;
+	samplerBinding.stageFlags         = VK_SHADER_STAGE_ALL;
+	samplerBinding.pImmutableSamplers = &m_Sampler;
+	bindings.emplace_back(samplerBinding);
+	bindingFlags.emplace_back(0);
+	poolSizes.emplace_back(VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_SAMPLER, 1});
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+	bindingFlagsInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	bindingFlagsInfo.bindingCount  = static_cast<uint32_t>(bindingFlags.size());
+	bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.pNext        = &bindingFlagsInfo;
+	layoutInfo.flags        = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings    = bindings.data();
+
+	if (const VkResult result{vkCreateDescriptorSetLayout(m_Device, &layoutInfo, nullptr, &m_Layout)};
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{
+		        std::string{"Failed to create bindless descriptor set layout: "} + string_VkResult(result)
+		};
+	}
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.flags         = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	poolInfo.maxSets       = 1;
+	poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+	poolInfo.pPoolSizes    = poolSizes.data();
+
+	if (const VkResult result{vkCreateDescriptorPool(m_Device, &poolInfo, nullptr, &m_Pool)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to create bindless descriptor pool: "} + string_VkResult(result)};
+	}
+
+	VkDescriptorSetAllocateInfo allocateInfo{};
+	allocateInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocateInfo.descriptorPool     = m_Pool;
+	allocateInfo.descriptorSetCount = 1;
+	allocateInfo.pSetLayouts        = &m_Layout;
+
+	if (const VkResult result{vkAllocateDescriptorSets(m_Device, &allocateInfo, &m_Set)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to allocate bindless descriptor set: "} + string_VkResult(result)};
+	}
+}
+
+void BindlessTable::Cleanup() {
+	if (m_Device == VK_NULL_HANDLE)
+		return;
+
+	vkDestroyDescriptorPool(m_Device, m_Pool, nullptr);
+	vkDestroyDescriptorSetLayout(m_Device, m_Layout, nullptr);
+	vkDestroySampler(m_Device, m_Sampler, nullptr);
+
+	m_Pool    = VK_NULL_HANDLE;
+	m_Layout  = VK_NULL_HANDLE;
+	m_Sampler = VK_NULL_HANDLE;
+	m_Set     = VK_NULL_HANDLE;
+	m_Device  = VK_NULL_HANDLE;
+}
+
+BindlessHandle BindlessTable::AddStorageBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+	const BindlessHandle handle{Allocate(BindlessResource::StorageBuffer)};
+
+	VkDescriptorBufferInfo bufferInfo{};
+	bufferInfo.buffer = buffer;
+	bufferInfo.offset = offset;
+	bufferInfo.range  = range;
+
+	VkWriteDescriptorSet write{};
+	write.pBufferInfo = &bufferInfo;
+	Write(BindlessResource::StorageBuffer, handle, write);
+
+	return handle;
+}
+
+BindlessHandle BindlessTable::AddSampledImage(VkImageView imageView, VkImageLayout layout) {
+	const BindlessHandle handle{Allocate(BindlessResource::SampledImage)};
+
+	VkDescriptorImageInfo imageInfo{};
+	imageInfo.imageView   = imageView;
+	imageInfo.imageLayout = layout;
+
+	VkWriteDescriptorSet write{};
+	write.pImageInfo = &imageInfo;
+	Write(BindlessResource::SampledImage, handle, write);
+
+	return handle;
+}
+
+BindlessHandle BindlessTable::AddStorageImage(VkImageView imageView) {
+	const BindlessHandle handle{Allocate(BindlessResource::StorageImage)};
+
+	VkDescriptorImageInfo imageInfo{};
+	imageInfo.imageView   = imageView;
+	imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+	VkWriteDescriptorSet write{};
+	write.pImageInfo = &imageInfo;
+	Write(BindlessResource::StorageImage, handle, write);
+
+	return handle;
+}
+
+BindlessHandle BindlessTable::AddAccelerationStructure(VkAccelerationStructureKHR accelerationStructure) {
+	const BindlessHandle handle{Allocate(BindlessResource::AccelerationStructure)};
+
+	VkWriteDescriptorSetAccelerationStructureKHR accelerationStructureInfo{};
+	accelerationStructureInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
+	accelerationStructureInfo.accelerationStructureCount = 1;
+	accelerationStructureInfo.pAccelerationStructures    = &accelerationStructure;
+
+	VkWriteDescriptorSet write{};
+	write.pNext = &accelerationStructureInfo;
+	Write(BindlessResource::AccelerationStructure, handle, write);
+
+	return handle;
+}
+
+void BindlessTable::Remove(BindlessResource resource, BindlessHandle handle, uint64_t frameValue) {
+	// The stale descriptor stays in place, partially bound arrays allow it as long as no shader reads it
+	m_pDeletionQueue->Enqueue(frameValue, [this, resource, handle] {
+		m_Slots[static_cast<size_t>(resource)].freeHandles.push_back(handle);
+	});
+}
+
+void BindlessTable::Bind(
+        VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout
+) const {
+	vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, 0, 1, &m_Set, 0, nullptr);
+}
+
+BindlessHandle BindlessTable::Allocate(BindlessResource resource) {
+	Slots &slots{m_Slots[static_cast<size_t>(resource)]};
+
+	if (!slots.freeHandles.empty()) {
+		const BindlessHandle handle{slots.freeHandles.back()};
+		slots.freeHandles.pop_back();
+
+		return handle;
+	}
+
+	if (slots.allocatedCount == slots.capacity)
+		throw std::runtime_error{
+		        std::string{"Bindless table is out of "} + RESOURCE_NAMES[static_cast<size_t>(resource)] + " handles"
+		};
+
+	return slots.allocatedCount++;
+}
+
+void BindlessTable::Write(BindlessResource resource, BindlessHandle handle, VkWriteDescriptorSet &write) const {
+	write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet          = m_Set;
+	write.dstBinding      = static_cast<uint32_t>(resource);
+	write.dstArrayElement = handle;
+	write.descriptorCount = 1;
+	write.descriptorType  = DESCRIPTOR_TYPES[static_cast<size_t>(resource)];
+
+	vkUpdateDescriptorSets(m_Device, 1, &write, 0, nullptr);
+}
@@ -0,0 +1,107 @@
+#ifndef PORTAL2RAYTRACED_BINDLESSTABLE_H
+#define PORTAL2RAYTRACED_BINDLESSTABLE_H
+
+#include "DeletionQueue.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Index into one of the BindlessTable arrays, shaders receive it through push constants or buffers.
+using BindlessHandle = uint32_t;
+
+// Value of the enumerator is the binding of its array, see shaders/bindless.glsl
+enum class BindlessResource : uint32_t {
+	StorageBuffer,
+	SampledImage,
+	StorageImage,
+	AccelerationStructure
+};
+
+// One descriptor set holding every resource the shaders read, bound once per command buffer instead of per draw.
+// All bindings are update-after-bind and partially bound, so resources are added and removed while frames using the
+// set are in flight, as long as the slots those frames read stay untouched. Removed handles are only reused once the
+// frames that may still read them finished. Binding 4 is an immutable linear sampler for the sampled images.
+class BindlessTable final {
+public:
+	BindlessTable() = default;
+
+	BindlessTable(const BindlessTable &) = delete;
+
+	BindlessTable &operator=(const BindlessTable &) = delete;
+
+	// Whether the device has the descriptor indexing features the table needs, acceleration structure arrays
+	// additionally need descriptorBindingAccelerationStructureUpdateAfterBind.
+	[[nodiscard]]
+	static bool IsSupported(VkPhysicalDevice physicalDevice);
+
+	// Enables what IsSupported checks for.
+	static void
+	EnableFeatures(VkPhysicalDeviceFeatures &features, VkPhysicalDeviceVulkan12Features &vulkan12Features) noexcept;
+
+	// Without accelerationStructures the acceleration structure array is left out of the layout.
+	void Init(
+	        VkPhysicalDevice physicalDevice, VkDevice device, DeletionQueue &deletionQueue, bool accelerationStructures
+	);
+
+	// The deletion queue has to be collected completely before, it may still return handles.
+	void Cleanup();
+
+	[[nodiscard]]
+	BindlessHandle AddStorageBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+
+	[[nodiscard]]
+	BindlessHandle AddSampledImage(VkImageView imageView, VkImageLayout layout);
+
+	// Storage images are always accessed in VK_IMAGE_LAYOUT_GENERAL
+	[[nodiscard]]
+	BindlessHandle AddStorageImage(VkImageView imageView);
+
+	[[nodiscard]]
+	BindlessHandle AddAccelerationStructure(VkAccelerationStructureKHR accelerationStructure);
+
+	// The handle becomes free for reuse once the frame timeline reached frameValue. The resource itself is the
+	// caller's to destroy.
+	void Remove(BindlessResource resource, BindlessHandle handle, uint64_t frameValue);
+
+	void Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout) const;
+
+	[[nodiscard]]
+	VkDescriptorSetLayout GetLayout() const noexcept {
+		return m_Layout;
+	}
+
+	// Maximum number of live handles of resource, clamped to the device limits
+	[[nodiscard]]
+	uint32_t GetCapacity(BindlessResource resource) const noexcept {
+		return m_Slots[static_cast<size_t>(resource)].capacity;
+	}
+
+	static constexpr uint32_t SAMPLER_BINDING{4};
+	// Requested array sizes, each one is lowered to what the device allows for update-after-bind descriptors
+	static constexpr std::array<uint32_t, 4> DEFAULT_CAPACITIES{16384, 16384, 1024, 64};
+
+private:
+	struct Slots {
+		uint32_t capacity{};
+		// Handles below it have been handed out before, later ones were never used
+		uint32_t                    allocatedCount{};
+		std::vector<BindlessHandle> freeHandles{};
+	};
+
+	[[nodiscard]]
+	BindlessHandle Allocate(BindlessResource resource);
+
+	void Write(BindlessResource resource, BindlessHandle handle, VkWriteDescriptorSet &write) const;
+
+	VkDevice              m_Device{};
+	DeletionQueue        *m_pDeletionQueue{};
+	VkSampler             m_Sampler{};
+	VkDescriptorSetLayout m_Layout{};
+	VkDescriptorPool      m_Pool{};
+	VkDescriptorSet       m_Set{};
+	std::array<Slots, 4>  m_Slots{};
+};
+
+
+#endif//PORTAL2RAYTRACED_BINDLESSTABLE_H
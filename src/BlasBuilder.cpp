@@ -0,0 +1,320 @@
+#include "BlasBuilder.h"
+#include "Alignment.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vulkan/vk_enum_string_helper.h>
+
+std::ostream &operator<<(std::ostream &ostream, const BlasBuildStatistics &statistics) {
+	return ostream << "BLAS: " << statistics.blasCount << " built in " << statistics.batchCount << " batches ("
+	               << statistics.scratchBytes << " bytes scratch) in " << statistics.buildMilliseconds
+	               << " ms, compacted from " << statistics.uncompactedBytes << " to " << statistics.compactedBytes
+	               << " bytes in " << statistics.compactMilliseconds << " ms";
+}
+
+void BlasBuilder::Init(
+        VkPhysicalDevice physicalDevice, VkDevice device, MemoryAllocator &allocator,
+        const RayTracingFunctions &functions
+) {
+	m_Device     = device;
+	m_pAllocator = &allocator;
+	m_pFunctions = &functions;
+
+	VkPhysicalDeviceAccelerationStructurePropertiesKHR accelerationStructureProperties{};
+	accelerationStructureProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR;
+
+	VkPhysicalDeviceProperties2 properties{};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &accelerationStructureProperties;
+	vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+	m_ScratchAlignment = accelerationStructureProperties.minAccelerationStructureScratchOffsetAlignment;
+}
+
+void BlasBuilder::Cleanup() {
+	for (auto &accelerationStructure: m_AccelerationStructures) {
+		DestroyAccelerationStructure(m_Device, *m_pAllocator, *m_pFunctions, accelerationStructure);
+	}
+
+	m_AccelerationStructures.clear();
+	m_PendingBuilds.clear();
+}
+
+uint32_t BlasBuilder::Add(std::vector<BlasTriangleGeometry> geometries) {
+	PendingBuild build{};
+	build.index = static_cast<uint32_t>(m_AccelerationStructures.size());
+
+	std::vector<uint32_t> maxPrimitiveCounts{};
+	for (const BlasTriangleGeometry &triangles: geometries) {
+		VkAccelerationStructureGeometryKHR geometry{};
+		geometry.sType        = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+		geometry.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
+		geometry.flags        = triangles.opaque ? VK_GEOMETRY_OPAQUE_BIT_KHR : 0;
+
+		VkAccelerationStructureGeometryTrianglesDataKHR &trianglesData{geometry.geometry.triangles};
+		trianglesData.sType                    = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
+		trianglesData.vertexFormat             = triangles.vertexFormat;
+		trianglesData.vertexData.deviceAddress = triangles.vertexAddress;
+		trianglesData.vertexStride             = triangles.vertexStride;
+		trianglesData.maxVertex                = triangles.maxVertex;
+		trianglesData.indexType                = triangles.indexType;
+		trianglesData.indexData.deviceAddress  = triangles.indexAddress;
+
+		VkAccelerationStructureBuildRangeInfoKHR range{};
+		range.primitiveCount = triangles.triangleCount;
+
+		build.geometries.emplace_back(geometry);
+		build.ranges.emplace_back(range);
+		maxPrimitiveCounts.emplace_back(triangles.triangleCount);
+	}
+
+	VkAccelerationStructureBuildGeometryInfoKHR buildInfo{};
+	buildInfo.sType         = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+	buildInfo.type          = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+	buildInfo.flags         = BUILD_FLAGS;
+	buildInfo.mode          = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+	buildInfo.geometryCount = static_cast<uint32_t>(build.geometries.size());
+	buildInfo.pGeometries   = build.geometries.data();
+
+	build.sizes.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
+	m_pFunctions->vkGetAccelerationStructureBuildSizesKHR(
+	        m_Device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &buildInfo, maxPrimitiveCounts.data(),
+	        &build.sizes
+	);
+
+	m_AccelerationStructures.emplace_back();
+	m_PendingBuilds.emplace_back(std::move(build));
+
+	return m_PendingBuilds.back().index;
+}
+
+void BlasBuilder::Build(VkCommandPool commandPool, VkQueue queue) {
+	if (m_PendingBuilds.empty())
+		return;
+
+	const auto buildStart{std::chrono::steady_clock::now()};
+
+	// Greedily pack builds into batches whose scratch ranges fit next to each other in the shared buffer
+	std::vector<size_t> batchEnds{};
+	VkDeviceSize        batchScratchSize{0};
+	VkDeviceSize        scratchSize{0};
+
+	for (size_t i{0}; i < m_PendingBuilds.size(); ++i) {
+		PendingBuild      &build{m_PendingBuilds[i]};
+		const VkDeviceSize buildScratchSize{AlignUp(build.sizes.buildScratchSize, m_ScratchAlignment)};
+
+		if (batchScratchSize > 0 && batchScratchSize + buildScratchSize > MAX_SCRATCH_SIZE) {
+			batchEnds.emplace_back(i);
+			batchScratchSize = 0;
+		}
+
+		build.scratchOffset = batchScratchSize;
+		batchScratchSize += buildScratchSize;
+		scratchSize = std::max(scratchSize, batchScratchSize);
+
+		m_AccelerationStructures[build.index] = CreateAccelerationStructure(
+		        m_Device, *m_pAllocator, *m_pFunctions, VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
+		        build.sizes.accelerationStructureSize
+		);
+		m_Statistics.uncompactedBytes += build.sizes.accelerationStructureSize;
+	}
+	batchEnds.emplace_back(m_PendingBuilds.size());
+
+	// Over-allocated by one alignment so the base address can be rounded up
+	VkBuffer   scratchBuffer;
+	Allocation scratchAllocation;
+	m_pAllocator->CreateBuffer(
+	        scratchSize + m_ScratchAlignment,
+	        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+	        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, scratchBuffer, scratchAllocation
+	);
+	const VkDeviceAddress scratchAddress{AlignUp(m_pAllocator->GetDeviceAddress(scratchBuffer), m_ScratchAlignment)};
+
+	const auto buildCount{static_cast<uint32_t>(m_PendingBuilds.size())};
+
+	VkQueryPoolCreateInfo queryPoolInfo{};
+	queryPoolInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolInfo.queryType  = VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR;
+	queryPoolInfo.queryCount = buildCount;
+
+	VkQueryPool queryPool;
+	if (const VkResult result{vkCreateQueryPool(m_Device, &queryPoolInfo, nullptr, &queryPool)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to create compaction query pool: "} + string_VkResult(result)};
+	}
+
+	VkCommandBuffer buildCommandBuffer{BeginCommandBuffer(commandPool)};
+	vkCmdResetQueryPool(buildCommandBuffer, queryPool, 0, buildCount);
+
+	// Consecutive batches reuse the same scratch memory, so each one has to wait for the previous one's writes
+	VkMemoryBarrier scratchBarrier{};
+	scratchBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	scratchBarrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	scratchBarrier.dstAccessMask =
+	        VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+
+	std::vector<VkAccelerationStructureBuildGeometryInfoKHR>     buildInfos{};
+	std::vector<const VkAccelerationStructureBuildRangeInfoKHR *> buildRanges{};
+	std::vector<VkAccelerationStructureKHR>                       handles{};
+
+	size_t batchBegin{0};
+	for (const size_t batchEnd: batchEnds) {
+		buildInfos.clear();
+		buildRanges.clear();
+
+		for (size_t i{batchBegin}; i < batchEnd; ++i) {
+			const PendingBuild &build{m_PendingBuilds[i]};
+
+			VkAccelerationStructureBuildGeometryInfoKHR buildInfo{};
+			buildInfo.sType                     = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+			buildInfo.type                      = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+			buildInfo.flags                     = BUILD_FLAGS;
+			buildInfo.mode                      = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+			buildInfo.dstAccelerationStructure  = m_AccelerationStructures[build.index].handle;
+			buildInfo.geometryCount             = static_cast<uint32_t>(build.geometries.size());
+			buildInfo.pGeometries               = build.geometries.data();
+			buildInfo.scratchData.deviceAddress = scratchAddress + build.scratchOffset;
+
+			buildInfos.emplace_back(buildInfo);
+			buildRanges.emplace_back(build.ranges.data());
+			handles.emplace_back(buildInfo.dstAccelerationStructure);
+		}
+
+		if (batchBegin > 0) {
+			vkCmdPipelineBarrier(
+			        buildCommandBuffer, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+			        VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &scratchBarrier, 0, nullptr, 0,
+			        nullptr
+			);
+		}
+
+		m_pFunctions->vkCmdBuildAccelerationStructuresKHR(
+		        buildCommandBuffer, static_cast<uint32_t>(buildInfos.size()), buildInfos.data(), buildRanges.data()
+		);
+
+		batchBegin = batchEnd;
+	}
+
+	// Compacted sizes can only be queried once the builds are finished
+	vkCmdPipelineBarrier(
+	        buildCommandBuffer, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+	        VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &scratchBarrier, 0, nullptr, 0, nullptr
+	);
+	m_pFunctions->vkCmdWriteAccelerationStructuresPropertiesKHR(
+	        buildCommandBuffer, buildCount, handles.data(), VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR,
+	        queryPool, 0
+	);
+
+	SubmitAndWait(commandPool, queue, buildCommandBuffer);
+
+	const std::chrono::duration<double, std::milli> buildTime{std::chrono::steady_clock::now() - buildStart};
+
+	std::vector<VkDeviceSize> compactedSizes(buildCount);
+	if (const VkResult result{vkGetQueryPoolResults(
+	            m_Device, queryPool, 0, buildCount, compactedSizes.size() * sizeof(VkDeviceSize),
+	            compactedSizes.data(), sizeof(VkDeviceSize), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT
+	    )};
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to read compacted sizes: "} + string_VkResult(result)};
+	}
+
+	vkDestroyQueryPool(m_Device, queryPool, nullptr);
+	m_pAllocator->DestroyBuffer(scratchBuffer, scratchAllocation);
+
+	const auto compactStart{std::chrono::steady_clock::now()};
+
+	std::vector<AccelerationStructure> compactedStructures(buildCount);
+	VkCommandBuffer                    compactCommandBuffer{BeginCommandBuffer(commandPool)};
+
+	for (uint32_t i{0}; i < buildCount; ++i) {
+		compactedStructures[i] = CreateAccelerationStructure(
+		        m_Device, *m_pAllocator, *m_pFunctions, VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
+		        compactedSizes[i]
+		);
+
+		VkCopyAccelerationStructureInfoKHR copyInfo{};
+		copyInfo.sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR;
+		copyInfo.src   = m_AccelerationStructures[m_PendingBuilds[i].index].handle;
+		copyInfo.dst   = compactedStructures[i].handle;
+		copyInfo.mode  = VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR;
+		m_pFunctions->vkCmdCopyAccelerationStructureKHR(compactCommandBuffer, &copyInfo);
+
+		m_Statistics.compactedBytes += compactedSizes[i];
+	}
+
+	SubmitAndWait(commandPool, queue, compactCommandBuffer);
+
+	for (uint32_t i{0}; i < buildCount; ++i) {
+		AccelerationStructure &accelerationStructure{m_AccelerationStructures[m_PendingBuilds[i].index]};
+
+		DestroyAccelerationStructure(m_Device, *m_pAllocator, *m_pFunctions, accelerationStructure);
+		accelerationStructure = compactedStructures[i];
+	}
+
+	const std::chrono::duration<double, std::milli> compactTime{std::chrono::steady_clock::now() - compactStart};
+
+	m_Statistics.blasCount += buildCount;
+	m_Statistics.batchCount += static_cast<uint32_t>(batchEnds.size());
+	m_Statistics.scratchBytes = std::max(m_Statistics.scratchBytes, scratchSize);
+	m_Statistics.buildMilliseconds += buildTime.count();
+	m_Statistics.compactMilliseconds += compactTime.count();
+
+	m_PendingBuilds.clear();
+}
+
+VkCommandBuffer BlasBuilder::BeginCommandBuffer(VkCommandPool commandPool) const {
+	VkCommandBufferAllocateInfo allocateInfo{};
+	allocateInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocateInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandPool        = commandPool;
+	allocateInfo.commandBufferCount = 1;
+
+	VkCommandBuffer commandBuffer;
+	if (const VkResult result{vkAllocateCommandBuffers(m_Device, &allocateInfo, &commandBuffer)};
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to allocate BLAS command buffer: "} + string_VkResult(result)};
+	}
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	if (const VkResult result{vkBeginCommandBuffer(commandBuffer, &beginInfo)}; result != VK_SUCCESS) {
+		vkFreeCommandBuffers(m_Device, commandPool, 1, &commandBuffer);
+		throw std::runtime_error{std::string{"Failed to begin BLAS command buffer: "} + string_VkResult(result)};
+	}
+
+	return commandBuffer;
+}
+
+void BlasBuilder::SubmitAndWait(VkCommandPool commandPool, VkQueue queue, VkCommandBuffer commandBuffer) const {
+	if (const VkResult result{vkEndCommandBuffer(commandBuffer)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to record BLAS command buffer: "} + string_VkResult(result)};
+	}
+
+	VkFenceCreateInfo fenceInfo{};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+	VkFence fence;
+	if (const VkResult result{vkCreateFence(m_Device, &fenceInfo, nullptr, &fence)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to create BLAS fence: "} + string_VkResult(result)};
+	}
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers    = &commandBuffer;
+
+	if (const VkResult result{vkQueueSubmit(queue, 1, &submitInfo, fence)}; result != VK_SUCCESS) {
+		vkDestroyFence(m_Device, fence, nullptr);
+		throw std::runtime_error{std::string{"Failed to submit BLAS build: "} + string_VkResult(result)};
+	}
+
+	if (const VkResult result{vkWaitForFences(m_Device, 1, &fence, VK_TRUE, UINT64_MAX)}; result != VK_SUCCESS) {
+		vkDestroyFence(m_Device, fence, nullptr);
+		throw std::runtime_error{std::string{"Failed to wait for BLAS build: "} + string_VkResult(result)};
+	}
+
+	vkDestroyFence(m_Device, fence, nullptr);
+	vkFreeCommandBuffers(m_Device, commandPool, 1, &commandBuffer);
+}
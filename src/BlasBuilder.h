@@ -0,0 +1,103 @@
+#ifndef PORTAL2RAYTRACED_BLASBUILDER_H
+#define PORTAL2RAYTRACED_BLASBUILDER_H
+
+#include "AccelerationStructure.h"
+#include "MemoryAllocator.h"
+#include "RayTracingFunctions.h"
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Indexed triangles read straight from device buffers, the buffers need
+// VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR and VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT.
+struct BlasTriangleGeometry {
+	VkDeviceAddress vertexAddress{};
+	VkFormat        vertexFormat{};
+	VkDeviceSize    vertexStride{};
+	uint32_t        maxVertex{};
+	VkDeviceAddress indexAddress{};
+	VkIndexType     indexType{};
+	uint32_t        triangleCount{};
+	bool            opaque{true};
+};
+
+struct BlasBuildStatistics {
+	uint32_t     blasCount{};
+	uint32_t     batchCount{};
+	VkDeviceSize scratchBytes{};
+	VkDeviceSize uncompactedBytes{};
+	VkDeviceSize compactedBytes{};
+	double       buildMilliseconds{};
+	double       compactMilliseconds{};
+};
+
+std::ostream &operator<<(std::ostream &ostream, const BlasBuildStatistics &statistics);
+
+// Builds bottom-level acceleration structures in batches that share one scratch buffer, then shrinks every one of
+// them to its compacted size. Meant for load time, Build blocks until the GPU is done.
+class BlasBuilder final {
+public:
+	BlasBuilder() = default;
+
+	BlasBuilder(const BlasBuilder &) = delete;
+
+	BlasBuilder &operator=(const BlasBuilder &) = delete;
+
+	void Init(
+	        VkPhysicalDevice physicalDevice, VkDevice device, MemoryAllocator &allocator,
+	        const RayTracingFunctions &functions
+	);
+
+	// Destroys every BLAS that was built.
+	void Cleanup();
+
+	// Queues a BLAS made of the given geometries and returns its index, the BLAS exists once Build returned.
+	[[nodiscard]]
+	uint32_t Add(std::vector<BlasTriangleGeometry> geometries);
+
+	// Builds and compacts everything added since the last call. commandPool has to belong to queue's family.
+	void Build(VkCommandPool commandPool, VkQueue queue);
+
+	[[nodiscard]]
+	const AccelerationStructure &Get(uint32_t index) const {
+		return m_AccelerationStructures.at(index);
+	}
+
+	[[nodiscard]]
+	const BlasBuildStatistics &GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+
+private:
+	struct PendingBuild {
+		uint32_t                                              index{};
+		std::vector<VkAccelerationStructureGeometryKHR>       geometries{};
+		std::vector<VkAccelerationStructureBuildRangeInfoKHR> ranges{};
+		VkAccelerationStructureBuildSizesInfoKHR              sizes{};
+		VkDeviceSize                                          scratchOffset{};
+	};
+
+	[[nodiscard]]
+	VkCommandBuffer BeginCommandBuffer(VkCommandPool commandPool) const;
+
+	void SubmitAndWait(VkCommandPool commandPool, VkQueue queue, VkCommandBuffer commandBuffer) const;
+
+	// Batches never need more scratch than this, unless a single BLAS does
+	static constexpr VkDeviceSize                         MAX_SCRATCH_SIZE{64ull * 1024 * 1024};
+	static constexpr VkBuildAccelerationStructureFlagsKHR BUILD_FLAGS{
+	        VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
+	        VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR
+	};
+
+	VkDevice                           m_Device{};
+	MemoryAllocator                   *m_pAllocator{};
+	const RayTracingFunctions         *m_pFunctions{};
+	VkDeviceSize                       m_ScratchAlignment{};
+	std::vector<PendingBuild>          m_PendingBuilds{};
+	std::vector<AccelerationStructure> m_AccelerationStructures{};
+	BlasBuildStatistics                m_Statistics{};
+};
+
+
+#endif//PORTAL2RAYTRACED_BLASBUILDER_H
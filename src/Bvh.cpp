@@ -0,0 +1,435 @@
+#include "Bvh.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace {
+	// Zero direction components are nudged away from zero, so slab tests never compute 0 * inf
+	constexpr float MIN_DIRECTION_COMPONENT{1e-30f};
+	constexpr float MISS{std::numeric_limits<float>::max()};
+}// namespace
+
+std::ostream &operator<<(std::ostream &ostream, const BvhStatistics &statistics) {
+	return ostream << "BVH: " << statistics.triangleCount << " triangles, " << statistics.nodeCount << " nodes ("
+	               << statistics.leafCount << " leaves, depth " << statistics.maxDepth << ") built in "
+	               << statistics.buildMilliseconds << " ms";
+}
+
+void Bvh::Build(std::vector<BvhTriangle> triangles) {
+	const auto buildStart{std::chrono::steady_clock::now()};
+
+	m_Triangles = std::move(triangles);
+	m_TriangleIndices.clear();
+	m_Nodes.clear();
+	m_Statistics = {};
+
+	const auto triangleCount{static_cast<uint32_t>(m_Triangles.size())};
+	m_Statistics.triangleCount = triangleCount;
+
+	if (triangleCount == 0) {
+		ViewOwnedArrays();
+		return;
+	}
+
+	m_Centroids.resize(triangleCount);
+	for (uint32_t i{0}; i < triangleCount; ++i) {
+		const BvhTriangle &triangle{m_Triangles[i]};
+		m_Centroids[i] = (triangle.v0 + triangle.v1 + triangle.v2) / 3.f;
+	}
+
+	m_TriangleIndices.resize(triangleCount);
+	std::iota(m_TriangleIndices.begin(), m_TriangleIndices.end(), 0u);
+
+	// A binary tree over n leaves never has more than 2n - 1 nodes, so node references stay valid while building
+	m_Nodes.reserve(static_cast<size_t>(triangleCount) * 2);
+
+	BvhNode &root{m_Nodes.emplace_back()};
+	root.leftFirst     = 0;
+	root.triangleCount = triangleCount;
+
+	UpdateBounds(0);
+	Subdivide(0, 1);
+
+	// Leaves index straight into m_Triangles from here on
+	std::vector<BvhTriangle> orderedTriangles(triangleCount);
+	for (uint32_t i{0}; i < triangleCount; ++i) { orderedTriangles[i] = m_Triangles[m_TriangleIndices[i]]; }
+
+	m_Triangles = std::move(orderedTriangles);
+	m_Centroids.clear();
+	m_Centroids.shrink_to_fit();
+	ViewOwnedArrays();
+
+	const std::chrono::duration<double, std::milli> buildTime{std::chrono::steady_clock::now() - buildStart};
+	m_Statistics.nodeCount         = static_cast<uint32_t>(m_Nodes.size());
+	m_Statistics.buildMilliseconds = buildTime.count();
+}
+
+void Bvh::Assign(
+        std::span<const BvhNode> nodes, std::span<const BvhTriangle> triangles, std::span<const uint32_t> triangleIndices
+) {
+	const auto assignStart{std::chrono::steady_clock::now()};
+
+	if (triangles.size() != triangleIndices.size() || triangles.size() > std::numeric_limits<uint32_t>::max() ||
+	    nodes.empty() != triangles.empty())
+		throw std::invalid_argument{"BVH triangle arrays do not match its nodes"};
+
+	// Every original triangle appears exactly once
+	std::vector<bool> seen(triangles.size(), false);
+	for (const uint32_t triangle: triangleIndices) {
+		if (triangle >= triangles.size() || seen[triangle])
+			throw std::invalid_argument{"BVH triangle indices are not a permutation"};
+
+		seen[triangle] = true;
+	}
+
+	BvhStatistics statistics{};
+	statistics.triangleCount = static_cast<uint32_t>(triangles.size());
+	statistics.nodeCount     = static_cast<uint32_t>(nodes.size());
+
+	// Children come after their parent and belong to no other node, which makes it a tree reachable from the root
+	std::vector<uint32_t> depths(nodes.size(), 0);
+	if (!nodes.empty())
+		depths[0] = 1;
+
+	for (size_t i{0}; i < nodes.size(); ++i) {
+		const BvhNode &node{nodes[i]};
+
+		if (depths[i] == 0)
+			throw std::invalid_argument{"BVH node " + std::to_string(i) + " is not part of the tree"};
+
+		statistics.maxDepth = std::max(statistics.maxDepth, depths[i]);
+
+		if (node.triangleCount > 0) {
+			if (static_cast<size_t>(node.leftFirst) + node.triangleCount > triangles.size())
+				throw std::invalid_argument{"BVH leaf " + std::to_string(i) + " references missing triangles"};
+
+			++statistics.leafCount;
+			continue;
+		}
+
+		const size_t left{node.leftFirst};
+		if (left <= i || left + 1 >= nodes.size() || depths[left] != 0 || depths[left + 1] != 0 ||
+		    depths[i] >= MAX_DEPTH)
+			throw std::invalid_argument{"BVH node " + std::to_string(i) + " has invalid children"};
+
+		depths[left]     = depths[i] + 1;
+		depths[left + 1] = depths[i] + 1;
+	}
+
+	// WideBvh reads small subtrees as one triangle range, so siblings have to cover adjacent ranges
+	std::vector<uint32_t> subtreeFirsts(nodes.size());
+	std::vector<uint32_t> subtreeCounts(nodes.size());
+	for (size_t i{nodes.size()}; i-- > 0;) {
+		const BvhNode &node{nodes[i]};
+
+		if (node.triangleCount > 0) {
+			subtreeFirsts[i] = node.leftFirst;
+			subtreeCounts[i] = node.triangleCount;
+			continue;
+		}
+
+		const uint32_t left{node.leftFirst};
+		if (subtreeFirsts[left + 1] != subtreeFirsts[left] + subtreeCounts[left])
+			throw std::invalid_argument{"BVH node " + std::to_string(i) + " has non-contiguous triangles"};
+
+		subtreeFirsts[i] = subtreeFirsts[left];
+		subtreeCounts[i] = subtreeCounts[left] + subtreeCounts[left + 1];
+	}
+
+	if (!nodes.empty() && (subtreeFirsts[0] != 0 || subtreeCounts[0] != triangles.size()))
+		throw std::invalid_argument{"BVH leaves do not cover every triangle"};
+
+	// Validated, so traversal can read them where they are, a memory mapped cooked scene is never copied
+	m_Nodes             = {};
+	m_Triangles         = {};
+	m_TriangleIndices   = {};
+	m_Centroids         = {};
+	m_NodeView          = nodes;
+	m_TriangleView      = triangles;
+	m_TriangleIndexView = triangleIndices;
+
+	const std::chrono::duration<double, std::milli> assignTime{std::chrono::steady_clock::now() - assignStart};
+	statistics.buildMilliseconds = assignTime.count();
+	m_Statistics                 = statistics;
+}
+
+bool Bvh::Intersect(const Ray &ray, RayHit &hit) const noexcept {
+	return Traverse<false>(ray, hit);
+}
+
+bool Bvh::IsOccluded(const Ray &ray) const noexcept {
+	RayHit hit{};
+	return Traverse<true>(ray, hit);
+}
+
+void Bvh::ViewOwnedArrays() noexcept {
+	m_NodeView          = m_Nodes;
+	m_TriangleView      = m_Triangles;
+	m_TriangleIndexView = m_TriangleIndices;
+}
+
+void Bvh::UpdateBounds(uint32_t nodeIndex) {
+	BvhNode &node{m_Nodes[nodeIndex]};
+	node.boundsMin = glm::vec3{std::numeric_limits<float>::max()};
+	node.boundsMax = glm::vec3{std::numeric_limits<float>::lowest()};
+
+	for (uint32_t i{node.leftFirst}; i < node.leftFirst + node.triangleCount; ++i) {
+		const BvhTriangle &triangle{m_Triangles[m_TriangleIndices[i]]};
+
+		node.boundsMin = glm::min(node.boundsMin, glm::min(triangle.v0, glm::min(triangle.v1, triangle.v2)));
+		node.boundsMax = glm::max(node.boundsMax, glm::max(triangle.v0, glm::max(triangle.v1, triangle.v2)));
+	}
+}
+
+void Bvh::Subdivide(uint32_t nodeIndex, uint32_t depth) {
+	BvhNode &node{m_Nodes[nodeIndex]};
+	m_Statistics.maxDepth = std::max(m_Statistics.maxDepth, depth);
+
+	const Split split{node.triangleCount > 1 && depth < MAX_DEPTH ? FindBestSplit(node) : Split{}};
+
+	// Splitting has to be cheaper than testing every triangle of the node
+	if (split.cost >= static_cast<float>(node.triangleCount)) {
+		++m_Statistics.leafCount;
+		return;
+	}
+
+	const auto first{m_TriangleIndices.begin() + node.leftFirst};
+	const auto middle{std::partition(first, first + node.triangleCount, [this, &split](uint32_t triangle) {
+		return GetBin(split, m_Centroids[triangle]) <= split.bin;
+	})};
+
+	const auto leftCount{static_cast<uint32_t>(middle - first)};
+	if (leftCount == 0 || leftCount == node.triangleCount) {
+		++m_Statistics.leafCount;
+		return;
+	}
+
+	const auto leftChild{static_cast<uint32_t>(m_Nodes.size())};
+
+	BvhNode &left{m_Nodes.emplace_back()};
+	left.leftFirst     = node.leftFirst;
+	left.triangleCount = leftCount;
+
+	BvhNode &right{m_Nodes.emplace_back()};
+	right.leftFirst     = node.leftFirst + leftCount;
+	right.triangleCount = node.triangleCount - leftCount;
+
+	node.leftFirst     = leftChild;
+	node.triangleCount = 0;
+
+	UpdateBounds(leftChild);
+	UpdateBounds(leftChild + 1);
+	Subdivide(leftChild, depth + 1);
+	Subdivide(leftChild + 1, depth + 1);
+}
+
+Bvh::Split Bvh::FindBestSplit(const BvhNode &node) const {
+	Split bestSplit{};
+
+	const float parentArea{GetSurfaceArea(node.boundsMin, node.boundsMax)};
+	if (parentArea <= 0.f)
+		return bestSplit;
+
+	glm::vec3 centroidMin{std::numeric_limits<float>::max()};
+	glm::vec3 centroidMax{std::numeric_limits<float>::lowest()};
+	for (uint32_t i{node.leftFirst}; i < node.leftFirst + node.triangleCount; ++i) {
+		centroidMin = glm::min(centroidMin, m_Centroids[m_TriangleIndices[i]]);
+		centroidMax = glm::max(centroidMax, m_Centroids[m_TriangleIndices[i]]);
+	}
+
+	for (int axis{0}; axis < 3; ++axis) {
+		const float extent{centroidMax[axis] - centroidMin[axis]};
+		if (extent <= 0.f)
+			continue;
+
+		Split split{};
+		split.axis        = axis;
+		split.centroidMin = centroidMin;
+		split.binScale    = glm::vec3{static_cast<float>(BIN_COUNT) / extent};
+
+		std::array<Bin, BIN_COUNT> bins{};
+		for (uint32_t i{node.leftFirst}; i < node.leftFirst + node.triangleCount; ++i) {
+			const uint32_t     triangleIndex{m_TriangleIndices[i]};
+			const BvhTriangle &triangle{m_Triangles[triangleIndex]};
+			Bin               &bin{bins[GetBin(split, m_Centroids[triangleIndex])]};
+
+			bin.boundsMin = glm::min(bin.boundsMin, glm::min(triangle.v0, glm::min(triangle.v1, triangle.v2)));
+			bin.boundsMax = glm::max(bin.boundsMax, glm::max(triangle.v0, glm::max(triangle.v1, triangle.v2)));
+			++bin.triangleCount;
+		}
+
+		// Empty sides cost nothing, their inverted bounds would otherwise produce a bogus area
+		const auto getSideCost{[](const Bin &side) {
+			return side.triangleCount == 0
+			               ? 0.f
+			               : static_cast<float>(side.triangleCount) * GetSurfaceArea(side.boundsMin, side.boundsMax);
+		}};
+
+		// Sweep from both sides, leftCosts[i] covers bins 0..i and rightCosts[i] bins i + 1..BIN_COUNT - 1
+		std::array<float, BIN_COUNT - 1> leftCosts{};
+		std::array<float, BIN_COUNT - 1> rightCosts{};
+		Bin                              leftSide{};
+		Bin                              rightSide{};
+
+		for (uint32_t i{0}; i < BIN_COUNT - 1; ++i) {
+			leftSide.boundsMin = glm::min(leftSide.boundsMin, bins[i].boundsMin);
+			leftSide.boundsMax = glm::max(leftSide.boundsMax, bins[i].boundsMax);
+			leftSide.triangleCount += bins[i].triangleCount;
+			leftCosts[i] = getSideCost(leftSide);
+
+			const Bin &rightBin{bins[BIN_COUNT - 1 - i]};
+			rightSide.boundsMin = glm::min(rightSide.boundsMin, rightBin.boundsMin);
+			rightSide.boundsMax = glm::max(rightSide.boundsMax, rightBin.boundsMax);
+			rightSide.triangleCount += rightBin.triangleCount;
+			rightCosts[BIN_COUNT - 2 - i] = getSideCost(rightSide);
+		}
+
+		for (uint32_t i{0}; i < BIN_COUNT - 1; ++i) {
+			const float cost{TRAVERSAL_COST + (leftCosts[i] + rightCosts[i]) / parentArea};
+
+			if (cost < bestSplit.cost) {
+				split.cost = cost;
+				split.bin  = i;
+				bestSplit  = split;
+			}
+		}
+	}
+
+	return bestSplit;
+}
+
+uint32_t Bvh::GetBin(const Split &split, const glm::vec3 &centroid) noexcept {
+	const float offset{(centroid[split.axis] - split.centroidMin[split.axis]) * split.binScale[split.axis]};
+
+	return std::min(static_cast<uint32_t>(std::max(offset, 0.f)), BIN_COUNT - 1);
+}
+
+template<bool AnyHit>
+bool Bvh::Traverse(const Ray &ray, RayHit &hit) const noexcept {
+	if (m_NodeView.empty())
+		return false;
+
+	glm::vec3 inverseDirection{};
+	for (int axis{0}; axis < 3; ++axis) {
+		const float component{ray.direction[axis]};
+		inverseDirection[axis] = 1.f / (std::abs(component) > MIN_DIRECTION_COMPONENT
+		                                        ? component
+		                                        : std::copysign(MIN_DIRECTION_COMPONENT, component));
+	}
+
+	hit.distance = ray.tMax;
+	if (IntersectBounds(m_NodeView.front(), ray.origin, inverseDirection, hit.distance) == MISS)
+		return false;
+
+	std::array<uint32_t, MAX_DEPTH> stack{};
+	uint32_t                        stackSize{0};
+	uint32_t                        nodeIndex{0};
+	bool                            found{false};
+
+	while (true) {
+		const BvhNode &node{m_NodeView[nodeIndex]};
+
+		if (node.triangleCount > 0) {
+			for (uint32_t i{node.leftFirst}; i < node.leftFirst + node.triangleCount; ++i) {
+				if (!IntersectTriangle(m_TriangleView[i], ray, hit))
+					continue;
+
+				hit.triangle = m_TriangleIndexView[i];
+				found        = true;
+
+				if constexpr (AnyHit)
+					return true;
+			}
+
+			if (stackSize == 0)
+				break;
+
+			nodeIndex = stack[--stackSize];
+			continue;
+		}
+
+		// Near child first, so the closest hit shrinks hit.distance before the far child is tested
+		uint32_t near{node.leftFirst};
+		uint32_t far{node.leftFirst + 1};
+		float    nearDistance{IntersectBounds(m_NodeView[near], ray.origin, inverseDirection, hit.distance)};
+		float    farDistance{IntersectBounds(m_NodeView[far], ray.origin, inverseDirection, hit.distance)};
+
+		if (farDistance < nearDistance) {
+			std::swap(near, far);
+			std::swap(nearDistance, farDistance);
+		}
+
+		if (nearDistance == MISS) {
+			if (stackSize == 0)
+				break;
+
+			nodeIndex = stack[--stackSize];
+			continue;
+		}
+
+		nodeIndex = near;
+		if (farDistance != MISS)
+			stack[stackSize++] = far;
+	}
+
+	return found;
+}
+
+float Bvh::IntersectBounds(
+        const BvhNode &node, const glm::vec3 &origin, const glm::vec3 &inverseDirection, float tMax
+) noexcept {
+	const glm::vec3 t0{(node.boundsMin - origin) * inverseDirection};
+	const glm::vec3 t1{(node.boundsMax - origin) * inverseDirection};
+
+	const glm::vec3 tNear{glm::min(t0, t1)};
+	const glm::vec3 tFar{glm::max(t0, t1)};
+
+	const float entry{std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.f))};
+	const float exit{std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax))};
+
+	return entry <= exit ? entry : MISS;
+}
+
+bool Bvh::IntersectTriangle(const BvhTriangle &triangle, const Ray &ray, RayHit &hit) noexcept {
+	// Möller-Trumbore, both faces count as a hit like the TLAS instances with culling disabled
+	const glm::vec3 edge1{triangle.v1 - triangle.v0};
+	const glm::vec3 edge2{triangle.v2 - triangle.v0};
+	const glm::vec3 p{glm::cross(ray.direction, edge2)};
+	const float     determinant{glm::dot(edge1, p)};
+
+	if (std::abs(determinant) < 1e-12f)
+		return false;
+
+	const float     inverseDeterminant{1.f / determinant};
+	const glm::vec3 s{ray.origin - triangle.v0};
+	const float     u{glm::dot(s, p) * inverseDeterminant};
+
+	if (u < 0.f || u > 1.f)
+		return false;
+
+	const glm::vec3 q{glm::cross(s, edge1)};
+	const float     v{glm::dot(ray.direction, q) * inverseDeterminant};
+
+	if (v < 0.f || u + v > 1.f)
+		return false;
+
+	const float distance{glm::dot(edge2, q) * inverseDeterminant};
+	if (distance <= ray.tMin || distance >= hit.distance)
+		return false;
+
+	hit.distance = distance;
+	hit.u        = u;
+	hit.v        = v;
+
+	return true;
+}
+
+float Bvh::GetSurfaceArea(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax) noexcept {
+	const glm::vec3 extent{boundsMax - boundsMin};
+
+	return 2.f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
@@ -0,0 +1,165 @@
+#ifndef PORTAL2RAYTRACED_BVH_H
+#define PORTAL2RAYTRACED_BVH_H
+
+#include <cstdint>
+#include <glm\glm.hpp>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <vector>
+
+struct Ray {
+	glm::vec3 origin{};
+	glm::vec3 direction{};
+	float     tMin{0.f};
+	float     tMax{std::numeric_limits<float>::max()};
+};
+
+struct BvhTriangle {
+	glm::vec3 v0{};
+	glm::vec3 v1{};
+	glm::vec3 v2{};
+};
+
+// u and v weight v1 and v2, the same convention as the barycentrics a closest hit shader receives.
+struct RayHit {
+	float    distance{std::numeric_limits<float>::max()};
+	uint32_t triangle{};
+	float    u{};
+	float    v{};
+};
+
+// Internal nodes have triangleCount 0 and their children at leftFirst and leftFirst + 1, leaves reference
+// triangleCount triangles starting at leftFirst. 32 bytes, two nodes per cache line.
+struct BvhNode {
+	glm::vec3 boundsMin{};
+	uint32_t  leftFirst{};
+	glm::vec3 boundsMax{};
+	uint32_t  triangleCount{};
+};
+
+struct BvhStatistics {
+	uint32_t triangleCount{};
+	uint32_t nodeCount{};
+	uint32_t leafCount{};
+	uint32_t maxDepth{};
+	double   buildMilliseconds{};
+};
+
+std::ostream &operator<<(std::ostream &ostream, const BvhStatistics &statistics);
+
+// Bounding volume hierarchy over a triangle soup, split with a binned surface area heuristic. Read-only once built,
+// so any number of threads can trace against it at the same time.
+class Bvh final {
+public:
+	Bvh() = default;
+
+	Bvh(const Bvh &) = delete;
+
+	Bvh &operator=(const Bvh &) = delete;
+
+	void Build(std::vector<BvhTriangle> triangles);
+
+	// Takes over a hierarchy an earlier Build produced, like the one stored in a cooked scene. The arrays are viewed
+	// in place rather than copied, so they have to outlive this Bvh or its next Build or Assign. Throws
+	// std::invalid_argument when it breaks any invariant Build guarantees, so a corrupt file can not make traversal
+	// read out of bounds.
+	void Assign(
+	        std::span<const BvhNode> nodes, std::span<const BvhTriangle> triangles,
+	        std::span<const uint32_t> triangleIndices
+	);
+
+	// Closest hit along the ray, hit.triangle is the index the triangle had in the vector passed to Build.
+	[[nodiscard]]
+	bool Intersect(const Ray &ray, RayHit &hit) const noexcept;
+
+	// Stops at the first hit, meant for shadow and occlusion rays.
+	[[nodiscard]]
+	bool IsOccluded(const Ray &ray) const noexcept;
+
+	[[nodiscard]]
+	const BvhStatistics &GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+
+	// Children of a node always come after it, and every subtree's triangles are contiguous in GetTriangles().
+	[[nodiscard]]
+	std::span<const BvhNode> GetNodes() const noexcept {
+		return m_NodeView;
+	}
+
+	// In leaf order, GetTriangleIndices() maps them back to the order they were passed to Build in.
+	[[nodiscard]]
+	std::span<const BvhTriangle> GetTriangles() const noexcept {
+		return m_TriangleView;
+	}
+
+	[[nodiscard]]
+	std::span<const uint32_t> GetTriangleIndices() const noexcept {
+		return m_TriangleIndexView;
+	}
+
+	// Subdivide stops at this depth, so the traversal stack can never overflow
+	static constexpr uint32_t MAX_DEPTH{64};
+
+private:
+	struct Bin {
+		glm::vec3 boundsMin{std::numeric_limits<float>::max()};
+		glm::vec3 boundsMax{std::numeric_limits<float>::lowest()};
+		uint32_t  triangleCount{};
+	};
+
+	// Triangles whose centroid falls into a bin up to and including bin go left
+	struct Split {
+		float     cost{std::numeric_limits<float>::infinity()};
+		int       axis{};
+		uint32_t  bin{};
+		glm::vec3 centroidMin{};
+		glm::vec3 binScale{};
+	};
+
+	void ViewOwnedArrays() noexcept;
+
+	void UpdateBounds(uint32_t nodeIndex);
+
+	void Subdivide(uint32_t nodeIndex, uint32_t depth);
+
+	[[nodiscard]]
+	Split FindBestSplit(const BvhNode &node) const;
+
+	[[nodiscard]]
+	static uint32_t GetBin(const Split &split, const glm::vec3 &centroid) noexcept;
+
+	template<bool AnyHit>
+	[[nodiscard]]
+	bool Traverse(const Ray &ray, RayHit &hit) const noexcept;
+
+	[[nodiscard]]
+	static float IntersectBounds(
+	        const BvhNode &node, const glm::vec3 &origin, const glm::vec3 &inverseDirection, float tMax
+	) noexcept;
+
+	[[nodiscard]]
+	static bool IntersectTriangle(const BvhTriangle &triangle, const Ray &ray, RayHit &hit) noexcept;
+
+	[[nodiscard]]
+	static float GetSurfaceArea(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax) noexcept;
+
+	// Relative cost of one traversal step against one triangle test
+	static constexpr float    TRAVERSAL_COST{1.f};
+	static constexpr uint32_t BIN_COUNT{16};
+
+	// Only filled by Build, Assign leaves them empty and views the caller's arrays
+	std::vector<BvhTriangle> m_Triangles{};
+	std::vector<glm::vec3>   m_Centroids{};
+	std::vector<uint32_t>    m_TriangleIndices{};
+	std::vector<BvhNode>     m_Nodes{};
+	// What traversal and the getters read, either the vectors above or the arrays passed to Assign
+	std::span<const BvhTriangle> m_TriangleView{};
+	std::span<const uint32_t>    m_TriangleIndexView{};
+	std::span<const BvhNode>     m_NodeView{};
+	BvhStatistics                m_Statistics{};
+};
+
+
+#endif//PORTAL2RAYTRACED_BVH_H
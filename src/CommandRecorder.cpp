@@ -0,0 +1,135 @@
+#include "CommandRecorder.h"
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vulkan/vk_enum_string_helper.h>
+
+void CommandRecorder::Init(
+        VkDevice device, uint32_t queueFamilyIndex, ThreadPool &threadPool, uint32_t frameCount, uint32_t workerCount
+) {
+	m_Device      = device;
+	m_pThreadPool = &threadPool;
+	m_WorkerCount = workerCount;
+
+	m_Frames.resize(frameCount);
+	for (FrameCommands &frame: m_Frames) {
+		frame.primaryPool = CreatePool(queueFamilyIndex);
+		frame.primary     = AllocateCommandBuffer(frame.primaryPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+		frame.workerPools.reserve(workerCount);
+		frame.secondaries.reserve(workerCount);
+		for (uint32_t worker{0}; worker < workerCount; ++worker) {
+			const VkCommandPool pool{frame.workerPools.emplace_back(CreatePool(queueFamilyIndex))};
+			frame.secondaries.push_back(AllocateCommandBuffer(pool, VK_COMMAND_BUFFER_LEVEL_SECONDARY));
+		}
+	}
+}
+
+void CommandRecorder::Cleanup() {
+	// Destroying a pool frees its command buffers along with it
+	for (const FrameCommands &frame: m_Frames) {
+		vkDestroyCommandPool(m_Device, frame.primaryPool, nullptr);
+
+		for (const VkCommandPool pool: frame.workerPools) { vkDestroyCommandPool(m_Device, pool, nullptr); }
+	}
+
+	m_Frames.clear();
+}
+
+VkCommandBuffer CommandRecorder::BeginFrame(uint32_t frameIndex) {
+	m_CurrentFrame = frameIndex;
+	FrameCommands &frame{m_Frames[frameIndex]};
+
+	if (const VkResult result{vkResetCommandPool(m_Device, frame.primaryPool, 0)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to reset command pool: "} + string_VkResult(result)};
+	}
+
+	for (const VkCommandPool pool: frame.workerPools) {
+		if (const VkResult result{vkResetCommandPool(m_Device, pool, 0)}; result != VK_SUCCESS) {
+			throw std::runtime_error{std::string{"Failed to reset command pool: "} + string_VkResult(result)};
+		}
+	}
+
+	return frame.primary;
+}
+
+std::span<const VkCommandBuffer> CommandRecorder::RecordSecondaries(
+        const VkCommandBufferInheritanceInfo &inheritanceInfo, uint32_t chunkCount, const RecordFunction &record
+) {
+	if (chunkCount > m_WorkerCount)
+		throw std::invalid_argument{
+		        "Cannot record " + std::to_string(chunkCount) + " chunks with " + std::to_string(m_WorkerCount) +
+		        " workers"
+		};
+
+	const FrameCommands &frame{m_Frames[m_CurrentFrame]};
+
+	std::vector<std::future<void>> recordings{};
+	recordings.reserve(chunkCount);
+
+	for (uint32_t chunk{0}; chunk < chunkCount; ++chunk) {
+		const VkCommandBuffer commandBuffer{frame.secondaries[chunk]};
+
+		recordings.push_back(m_pThreadPool->Submit([commandBuffer, chunk, &inheritanceInfo, &record] {
+			VkCommandBufferBeginInfo beginInfo{};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			if (inheritanceInfo.renderPass != VK_NULL_HANDLE)
+				beginInfo.flags |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+			beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+			if (const VkResult result{vkBeginCommandBuffer(commandBuffer, &beginInfo)}; result != VK_SUCCESS) {
+				throw std::runtime_error{
+				        std::string{"Failed to begin secondary command buffer: "} + string_VkResult(result)
+				};
+			}
+
+			record(commandBuffer, chunk);
+
+			if (const VkResult result{vkEndCommandBuffer(commandBuffer)}; result != VK_SUCCESS) {
+				throw std::runtime_error{
+				        std::string{"Failed to record secondary command buffer: "} + string_VkResult(result)
+				};
+			}
+		}));
+	}
+
+	// Workers still reference inheritanceInfo and record, so nothing may unwind before every one of them is done
+	for (const std::future<void> &recording: recordings) { recording.wait(); }
+
+	for (std::future<void> &recording: recordings) { recording.get(); }
+
+	return {frame.secondaries.data(), chunkCount};
+}
+
+VkCommandPool CommandRecorder::CreatePool(uint32_t queueFamilyIndex) const {
+	// No RESET_COMMAND_BUFFER_BIT, buffers are only ever reset along with their whole pool
+	VkCommandPoolCreateInfo commandPoolCreateInfo{};
+	commandPoolCreateInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	commandPoolCreateInfo.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	commandPoolCreateInfo.queueFamilyIndex = queueFamilyIndex;
+
+	VkCommandPool pool{};
+	if (const VkResult result{vkCreateCommandPool(m_Device, &commandPoolCreateInfo, nullptr, &pool)};
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to create command pool: "} + string_VkResult(result)};
+	}
+
+	return pool;
+}
+
+VkCommandBuffer CommandRecorder::AllocateCommandBuffer(VkCommandPool pool, VkCommandBufferLevel level) const {
+	VkCommandBufferAllocateInfo allocateInfo{};
+	allocateInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocateInfo.commandPool        = pool;
+	allocateInfo.level              = level;
+	allocateInfo.commandBufferCount = 1;
+
+	VkCommandBuffer commandBuffer{};
+	if (const VkResult result{vkAllocateCommandBuffers(m_Device, &allocateInfo, &commandBuffer)};
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to allocate command buffers: "} + string_VkResult(result)};
+	}
+
+	return commandBuffer;
+}
@@ -0,0 +1,73 @@
+#ifndef PORTAL2RAYTRACED_COMMANDRECORDER_H
+#define PORTAL2RAYTRACED_COMMANDRECORDER_H
+
+#include "ThreadPool.h"
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Frame command buffers, recorded by the main thread and a set of workers on the thread pool. Every frame slot has a
+// command pool for its primary and one per worker, each worker records one secondary command buffer from its own pool
+// and the main thread executes them from the primary. Pools are reset as a whole once the slot's fence signalled, a
+// pool is only ever touched by one thread at a time, so none of them needs external synchronisation.
+class CommandRecorder final {
+public:
+	// Records one chunk into a secondary command buffer that is already begun.
+	using RecordFunction = std::function<void(VkCommandBuffer commandBuffer, uint32_t chunk)>;
+
+	CommandRecorder() = default;
+
+	CommandRecorder(const CommandRecorder &) = delete;
+
+	CommandRecorder &operator=(const CommandRecorder &) = delete;
+
+	void Init(
+	        VkDevice device, uint32_t queueFamilyIndex, ThreadPool &threadPool, uint32_t frameCount,
+	        uint32_t workerCount
+	);
+
+	void Cleanup();
+
+	// Resets every pool of this frame slot and returns its primary, not begun yet. The slot's fence must already have
+	// been waited on.
+	[[nodiscard]]
+	VkCommandBuffer BeginFrame(uint32_t frameIndex);
+
+	// Records chunkCount secondaries on the workers and blocks until all of them are done, the result stays valid until
+	// the next BeginFrame of this slot. chunkCount is at most GetWorkerCount(). Rethrows the first exception a worker
+	// threw once every worker has finished.
+	[[nodiscard]]
+	std::span<const VkCommandBuffer> RecordSecondaries(
+	        const VkCommandBufferInheritanceInfo &inheritanceInfo, uint32_t chunkCount, const RecordFunction &record
+	);
+
+	[[nodiscard]]
+	uint32_t GetWorkerCount() const noexcept {
+		return m_WorkerCount;
+	}
+
+private:
+	struct FrameCommands {
+		VkCommandPool                primaryPool{};
+		VkCommandBuffer              primary{};
+		std::vector<VkCommandPool>   workerPools{};
+		std::vector<VkCommandBuffer> secondaries{};
+	};
+
+	[[nodiscard]]
+	VkCommandPool CreatePool(uint32_t queueFamilyIndex) const;
+
+	[[nodiscard]]
+	VkCommandBuffer AllocateCommandBuffer(VkCommandPool pool, VkCommandBufferLevel level) const;
+
+	VkDevice                   m_Device{};
+	ThreadPool                *m_pThreadPool{};
+	uint32_t                   m_WorkerCount{};
+	uint32_t                   m_CurrentFrame{};
+	std::vector<FrameCommands> m_Frames{};
+};
+
+
+#endif//PORTAL2RAYTRACED_COMMANDRECORDER_H
@@ -0,0 +1,191 @@
+#include "CookedScene.h"
+#include "Alignment.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Sections hold these byte for byte, any layout change has to bump CookedScene::VERSION
+static_assert(std::is_trivially_copyable_v<Vertex> && sizeof(Vertex) == 24);
+static_assert(std::is_trivially_copyable_v<BvhNode> && sizeof(BvhNode) == 32);
+static_assert(std::is_trivially_copyable_v<BvhTriangle> && sizeof(BvhTriangle) == 36);
+
+std::ostream &operator<<(std::ostream &ostream, const CookedSceneStatistics &statistics) {
+	return ostream << "Cooked scene: " << statistics.vertexCount << " vertices, " << statistics.triangleCount
+	               << " triangles (" << (statistics.wideIndices ? 32 : 16) << "-bit indices), "
+	               << statistics.bvhNodeCount << " BVH nodes mapped from " << statistics.fileBytes << " bytes";
+}
+
+CookedScene::CookedScene(const std::filesystem::path &path)
+    : m_File{path} {
+	const std::span<const std::byte> data{m_File.GetData()};
+
+	if (data.size() < sizeof(Header))
+		throw std::runtime_error{"Not a cooked scene: " + path.string()};
+
+	memcpy(&m_Header, data.data(), sizeof(Header));
+
+	if (m_Header.magic != MAGIC)
+		throw std::runtime_error{"Not a cooked scene: " + path.string()};
+
+	if (m_Header.version != VERSION)
+		throw std::runtime_error{
+		        path.string() + " is a version " + std::to_string(m_Header.version) + " cooked scene, expected version " +
+		        std::to_string(VERSION) + ", cook it again"
+		};
+
+	if (m_Header.alignment != ALIGNMENT || m_Header.instanceCount == 0 ||
+	    (m_Header.indexSize != sizeof(uint16_t) && m_Header.indexSize != sizeof(uint32_t)) ||
+	    m_Header.nameLength > m_Header.name.size())
+		throw std::runtime_error{"Malformed cooked scene header in " + path.string()};
+
+	for (uint32_t section{0}; section < SectionCount; ++section) {
+		const SectionEntry &entry{m_Header.sections[section]};
+
+		// The mapping starts on a page boundary, so aligned offsets are aligned addresses
+		if (entry.offset % ALIGNMENT != 0 || entry.offset > data.size() || entry.size > data.size() - entry.offset ||
+		    entry.size % GetElementSize(static_cast<Section>(section)) != 0)
+			throw std::runtime_error{"Malformed cooked scene section table in " + path.string()};
+	}
+
+	const size_t vertexCount{GetSection<Vertex>(Vertices).size()};
+	const size_t indexCount{m_Header.sections[Indices].size / m_Header.indexSize};
+	const size_t bvhTriangleCount{GetSection<BvhTriangle>(BvhTriangles).size()};
+
+	if (vertexCount == 0 || vertexCount > std::numeric_limits<uint32_t>::max() || indexCount == 0 || indexCount % 3 != 0 ||
+	    bvhTriangleCount != indexCount / 3 * m_Header.instanceCount ||
+	    GetSection<uint32_t>(BvhTriangleIndices).size() != bvhTriangleCount)
+		throw std::runtime_error{"Cooked scene sections in " + path.string() + " do not fit together"};
+
+	// Checked once here because the streams are uploaded straight from the mapping, out of range indices would have
+	// the GPU read past the end of the vertex buffer
+	const SceneStreams streams{GetStreams()};
+	uint32_t           maxIndex{0};
+	if (streams.HasWideIndices())
+		maxIndex = *std::max_element(streams.wideIndices.begin(), streams.wideIndices.end());
+	else
+		maxIndex = *std::max_element(streams.indices.begin(), streams.indices.end());
+
+	if (maxIndex >= vertexCount)
+		throw std::runtime_error{
+		        "Cooked scene index " + std::to_string(maxIndex) + " in " + path.string() + " has no vertex"
+		};
+
+	m_Statistics.fileBytes     = data.size();
+	m_Statistics.vertexCount   = static_cast<uint32_t>(vertexCount);
+	m_Statistics.triangleCount = static_cast<uint32_t>(indexCount / 3);
+	m_Statistics.bvhNodeCount  = static_cast<uint32_t>(GetSection<BvhNode>(BvhNodes).size());
+	m_Statistics.wideIndices   = m_Header.indexSize == sizeof(uint32_t);
+}
+
+Scene CookedScene::GetScene() const {
+	Scene scene{};
+	scene.name          = std::string{m_Header.name.data(), m_Header.nameLength};
+	scene.instanceCount = m_Header.instanceCount;
+
+	return scene;
+}
+
+SceneStreams CookedScene::GetStreams() const noexcept {
+	SceneStreams streams{};
+	streams.vertices = GetSection<Vertex>(Vertices);
+	if (m_Header.indexSize == sizeof(uint32_t))
+		streams.wideIndices = GetSection<uint32_t>(Indices);
+	else
+		streams.indices = GetSection<uint16_t>(Indices);
+
+	return streams;
+}
+
+void CookedScene::LoadBvh(Bvh &bvh) const {
+	bvh.Assign(
+	        GetSection<BvhNode>(BvhNodes), GetSection<BvhTriangle>(BvhTriangles),
+	        GetSection<uint32_t>(BvhTriangleIndices)
+	);
+}
+
+void CookedScene::Write(const std::filesystem::path &path, const Scene &scene, const Bvh &bvh) {
+	const SceneStreams streams{scene.GetStreams()};
+
+	if (bvh.GetTriangles().size() != streams.GetIndexCount() / 3 * scene.instanceCount)
+		throw std::runtime_error{"BVH was not built over the triangles of scene " + scene.name};
+
+	Header header{};
+	header.magic         = MAGIC;
+	header.version       = VERSION;
+	header.alignment     = ALIGNMENT;
+	header.instanceCount = scene.instanceCount;
+	header.indexSize     = streams.HasWideIndices() ? sizeof(uint32_t) : sizeof(uint16_t);
+	header.nameLength    = static_cast<uint32_t>(std::min(scene.name.size(), header.name.size()));
+	std::copy_n(scene.name.begin(), header.nameLength, header.name.begin());
+
+	std::array<std::span<const std::byte>, SectionCount> sections{};
+	sections[Vertices]           = std::as_bytes(streams.vertices);
+	sections[Indices]            = streams.HasWideIndices() ? std::as_bytes(streams.wideIndices)
+	                                                        : std::as_bytes(streams.indices);
+	sections[BvhNodes]           = std::as_bytes(std::span{bvh.GetNodes()});
+	sections[BvhTriangles]       = std::as_bytes(std::span{bvh.GetTriangles()});
+	sections[BvhTriangleIndices] = std::as_bytes(std::span{bvh.GetTriangleIndices()});
+
+	uint64_t offset{AlignUp(sizeof(Header), ALIGNMENT)};
+	for (uint32_t section{0}; section < SectionCount; ++section) {
+		header.sections[section] = SectionEntry{offset, sections[section].size()};
+		offset                   = AlignUp(offset + sections[section].size(), ALIGNMENT);
+	}
+
+	// Write next to the old file and swap it in, so a failed cook never leaves a torn file behind
+	std::filesystem::path temporaryPath{path};
+	temporaryPath += ".tmp";
+
+	{
+		std::ofstream file{temporaryPath, std::ios::binary | std::ios::trunc};
+		if (!file.is_open())
+			throw std::runtime_error{"Failed to open " + temporaryPath.string() + " for writing"};
+
+		file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+		const std::vector<char> padding(ALIGNMENT, '\0');
+		uint64_t                written{sizeof(header)};
+		for (uint32_t section{0}; section < SectionCount; ++section) {
+			const SectionEntry &entry{header.sections[section]};
+
+			const auto *const pSection{reinterpret_cast<const char *>(sections[section].data())};
+
+			file.write(padding.data(), static_cast<std::streamsize>(entry.offset - written));
+			file.write(pSection, static_cast<std::streamsize>(entry.size));
+			written = entry.offset + entry.size;
+		}
+
+		if (!file.flush())
+			throw std::runtime_error{"Failed to write " + temporaryPath.string()};
+	}
+
+	std::error_code errorCode{};
+	std::filesystem::rename(temporaryPath, path, errorCode);
+
+	if (errorCode)
+		throw std::runtime_error{"Failed to replace " + path.string() + ": " + errorCode.message()};
+}
+
+bool CookedScene::IsCookedSceneFile(const std::filesystem::path &path) {
+	return path.extension() == EXTENSION;
+}
+
+size_t CookedScene::GetElementSize(Section section) const noexcept {
+	switch (section) {
+		case Vertices:
+			return sizeof(Vertex);
+		case Indices:
+			return m_Header.indexSize;
+		case BvhNodes:
+			return sizeof(BvhNode);
+		case BvhTriangles:
+			return sizeof(BvhTriangle);
+		default:
+			return sizeof(uint32_t);
+	}
+}
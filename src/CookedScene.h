@@ -0,0 +1,127 @@
+#ifndef PORTAL2RAYTRACED_COOKEDSCENE_H
+#define PORTAL2RAYTRACED_COOKEDSCENE_H
+
+#include "Bvh.h"
+#include "MappedFile.h"
+#include "Scene.h"
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <span>
+#include <string_view>
+
+struct CookedSceneStatistics {
+	uint64_t fileBytes{};
+	uint32_t vertexCount{};
+	// Per instance, the BVH holds instanceCount times as many
+	uint32_t triangleCount{};
+	uint32_t bvhNodeCount{};
+	bool     wideIndices{};
+};
+
+std::ostream &operator<<(std::ostream &ostream, const CookedSceneStatistics &statistics);
+
+// Scene plus the CPU renderer's BVH over it, written once by the scene_cook tool and memory mapped at startup
+// instead of parsed and rebuilt. The file is a fixed header followed by one section per stream, every section
+// starting on an ALIGNMENT boundary so GetStreams and LoadBvh can view it in place, nothing is copied out of the
+// mapping. Sections are raw copies of the in-memory structs in native byte order, a change to any of them needs a new
+// VERSION.
+class CookedScene final {
+public:
+	CookedScene() = default;
+
+	// Maps the file and checks the header, the section table and every index. Throws std::runtime_error for anything
+	// that is not a cooked scene of this VERSION.
+	explicit CookedScene(const std::filesystem::path &path);
+
+	CookedScene(const CookedScene &) = delete;
+
+	CookedScene &operator=(const CookedScene &) = delete;
+
+	CookedScene(CookedScene &&) noexcept = default;
+
+	CookedScene &operator=(CookedScene &&) noexcept = default;
+
+	// Name and instancing only, the vectors stay empty. The geometry is read through GetStreams.
+	[[nodiscard]]
+	Scene GetScene() const;
+
+	// Views the vertex and index sections, valid as long as this CookedScene is.
+	[[nodiscard]]
+	SceneStreams GetStreams() const noexcept;
+
+	// Hands the stored hierarchy to bvh without rebuilding it, see Bvh::Assign. bvh views the mapping, so it must not
+	// outlive this CookedScene.
+	void LoadBvh(Bvh &bvh) const;
+
+	[[nodiscard]]
+	bool IsOpen() const noexcept {
+		return m_File.IsOpen();
+	}
+
+	[[nodiscard]]
+	const CookedSceneStatistics &GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+
+	// bvh has to be built over CpuRenderer::GetSceneTriangles(scene). Throws std::runtime_error when the file cannot
+	// be written, an existing file is only replaced once the new one is complete.
+	static void Write(const std::filesystem::path &path, const Scene &scene, const Bvh &bvh);
+
+	// Decided by the extension alone
+	[[nodiscard]]
+	static bool IsCookedSceneFile(const std::filesystem::path &path);
+
+	static constexpr std::string_view EXTENSION{".cooked"};
+	static constexpr uint32_t         VERSION{1};
+	// The common page size, larger pages are a multiple of it
+	static constexpr uint32_t ALIGNMENT{4096};
+
+private:
+	enum Section : uint32_t {
+		Vertices,
+		Indices,
+		BvhNodes,
+		BvhTriangles,
+		BvhTriangleIndices,
+		SectionCount
+	};
+
+	struct SectionEntry {
+		uint64_t offset{};
+		uint64_t size{};
+	};
+
+	struct Header {
+		uint32_t                               magic{};
+		uint32_t                               version{};
+		uint32_t                               alignment{};
+		uint32_t                               instanceCount{};
+		uint32_t                               indexSize{};
+		uint32_t                               nameLength{};
+		std::array<SectionEntry, SectionCount> sections{};
+		std::array<char, 64>                   name{};
+	};
+
+	template<typename T>
+	[[nodiscard]]
+	std::span<const T> GetSection(Section section) const noexcept {
+		const SectionEntry &entry{m_Header.sections[section]};
+
+		return {reinterpret_cast<const T *>(m_File.GetData().data() + entry.offset), entry.size / sizeof(T)};
+	}
+
+	[[nodiscard]]
+	size_t GetElementSize(Section section) const noexcept;
+
+	// "P2SC" read as a little-endian uint32_t, files from a machine with the other byte order fail this check
+	static constexpr uint32_t MAGIC{0x43533250};
+
+	MappedFile            m_File{};
+	Header                m_Header{};
+	CookedSceneStatistics m_Statistics{};
+};
+
+
+#endif//PORTAL2RAYTRACED_COOKEDSCENE_H
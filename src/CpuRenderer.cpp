@@ -0,0 +1,268 @@
+#include "CpuRenderer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+std::ostream &operator<<(std::ostream &ostream, const CpuRenderStatistics &statistics) {
+	return ostream << "CPU renderer: " << statistics.rayCount << " rays in " << statistics.renderMilliseconds
+	               << " ms\n"
+	               << statistics.bvh << '\n'
+	               << statistics.wideBvh << '\n'
+	               << statistics.tiles << (statistics.cancelled ? " (render cancelled)" : "") << '\n'
+	               << statistics.accumulation;
+}
+
+CpuRenderer::CpuRenderer(unsigned int threadCount)
+    : m_Scheduler{threadCount} {
+}
+
+void CpuRenderer::SetScene(const Scene &scene) {
+	// The binary tree is only the starting point for the wide one
+	Bvh bvh{};
+	bvh.Build(GetSceneTriangles(scene));
+
+	SetScene(scene, scene.GetStreams(), bvh);
+}
+
+void CpuRenderer::SetScene(const Scene &scene, const SceneStreams &streams, const Bvh &bvh) {
+	const size_t trianglesPerInstance{streams.GetIndexCount() / 3};
+	const size_t triangleCount{trianglesPerInstance * scene.instanceCount};
+
+	if (bvh.GetTriangles().size() != triangleCount)
+		throw std::invalid_argument{"BVH was not built over the triangles of scene " + scene.name};
+
+	// The BVH already holds the world space triangles, only in leaf order
+	m_Shading.resize(triangleCount);
+	for (size_t i{0}; i < triangleCount; ++i) {
+		const BvhTriangle &triangle{bvh.GetTriangles()[i]};
+		const size_t       firstIndex{bvh.GetTriangleIndices()[i] % trianglesPerInstance * 3};
+
+		TriangleShading &shading{m_Shading[bvh.GetTriangleIndices()[i]]};
+		shading.c0     = streams.vertices[streams.GetIndex(firstIndex)].color;
+		shading.c1     = streams.vertices[streams.GetIndex(firstIndex + 1)].color;
+		shading.c2     = streams.vertices[streams.GetIndex(firstIndex + 2)].color;
+		shading.normal = glm::normalize(glm::cross(triangle.v1 - triangle.v0, triangle.v2 - triangle.v0));
+	}
+
+	m_Bvh.Build(bvh);
+
+	m_Statistics.bvh     = bvh.GetStatistics();
+	m_Statistics.wideBvh = m_Bvh.GetStatistics();
+
+	m_Accumulation.Invalidate();
+}
+
+void CpuRenderer::SetProgressive(bool enabled, uint32_t targetSamplesPerPixel) noexcept {
+	m_Accumulation.Configure(enabled, targetSamplesPerPixel);
+}
+
+void CpuRenderer::Invalidate() noexcept {
+	m_Accumulation.Invalidate();
+}
+
+SimdLevel CpuRenderer::SetSimdLevel(SimdLevel simdLevel) noexcept {
+	const SimdLevel usedLevel{m_Bvh.SetSimdLevel(simdLevel)};
+	m_Statistics.wideBvh.simdLevel = usedLevel;
+
+	return usedLevel;
+}
+
+void CpuRenderer::SetTileSize(uint32_t tileSize) noexcept {
+	m_TileSize = std::max(tileSize, 1u);
+}
+
+std::vector<std::byte> CpuRenderer::Render(uint32_t width, uint32_t height) {
+	const auto renderStart{std::chrono::steady_clock::now()};
+
+	if (width != m_AccumulationWidth || height != m_AccumulationHeight) {
+		m_Accumulation.Invalidate();
+		m_AccumulatedColors.resize(static_cast<size_t>(width) * height);
+		m_AccumulationWidth  = width;
+		m_AccumulationHeight = height;
+	}
+
+	std::vector<std::byte> pixels(static_cast<size_t>(width) * height * 4);
+
+	// One counter per worker, so tiles never contend on a shared one
+	std::vector<uint64_t> rayCounts(m_Scheduler.GetThreadCount());
+
+	const uint32_t   sampleIndex{m_Accumulation.BeginSample()};
+	glm::vec3 *const pAccumulatedColors{m_AccumulatedColors.data()};
+	std::byte *const pPixels{pixels.data()};
+
+	const bool completed{m_Scheduler.Run(width, height, m_TileSize, [&](const Tile &tile, uint32_t thread) {
+		rayCounts[thread] += RenderTile(width, height, tile, sampleIndex, pAccumulatedColors, pPixels);
+	})};
+
+	// Tiles that never ran are missing this sample, so the sums no longer share one sample count
+	if (completed) {
+		m_Accumulation.EndSample();
+	} else {
+		m_Accumulation.Invalidate();
+	}
+
+	uint64_t rayCount{0};
+	for (const uint64_t threadRayCount: rayCounts) { rayCount += threadRayCount; }
+
+	const std::chrono::duration<double, std::milli> renderTime{std::chrono::steady_clock::now() - renderStart};
+	m_Statistics.tiles              = m_Scheduler.GetStatistics();
+	m_Statistics.accumulation       = m_Accumulation.GetStatistics();
+	m_Statistics.rayCount           = rayCount;
+	m_Statistics.renderMilliseconds = renderTime.count();
+	m_Statistics.cancelled          = !completed;
+
+	return pixels;
+}
+
+void CpuRenderer::Cancel() noexcept {
+	m_Scheduler.Cancel();
+}
+
+uint64_t CpuRenderer::RenderTile(
+        uint32_t width, uint32_t height, const Tile &tile, uint32_t sampleIndex, glm::vec3 *pAccumulatedColors,
+        std::byte *pPixels
+) const noexcept {
+	const glm::vec2 resolution{static_cast<float>(width), static_cast<float>(height)};
+	const uint32_t  sampleSeed{Hash(sampleIndex)};
+	const float     sampleWeight{1.f / static_cast<float>(sampleIndex + 1)};
+	uint64_t        rayCount{0};
+
+	for (uint32_t y{tile.y}; y < tile.y + tile.height; ++y) {
+		for (uint32_t x{tile.x}; x < tile.x + tile.width; ++x) {
+			const uint32_t pixel{y * width + x};
+			uint32_t       state{Hash(pixel ^ sampleSeed)};
+
+			// The first sample goes through the pixel center like raytrace.rgen, later ones anti-alias the edges
+			const glm::vec2 offset{
+			        sampleIndex == 0 ? glm::vec2{.5f, .5f} : glm::vec2{NextRandom(state), NextRandom(state)}
+			};
+			const glm::vec2 pixelPosition{static_cast<float>(x) + offset.x, static_cast<float>(y) + offset.y};
+			const glm::vec2 ndc{pixelPosition / resolution * 2.f - 1.f};
+
+			Ray ray{};
+			ray.origin    = glm::vec3{ndc, -1.f};
+			ray.direction = glm::vec3{0.f, 0.f, 1.f};
+			ray.tMax      = 2.f;
+
+			const glm::vec3 sample{Shade(ray, state, rayCount)};
+
+			glm::vec3 &accumulated{pAccumulatedColors[pixel]};
+			accumulated = sampleIndex == 0 ? sample : accumulated + sample;
+
+			const glm::vec3 color{accumulated * sampleWeight};
+
+			std::byte *const pPixel{pPixels + static_cast<size_t>(pixel) * 4};
+			pPixel[0] = EncodeSrgb(color.r);
+			pPixel[1] = EncodeSrgb(color.g);
+			pPixel[2] = EncodeSrgb(color.b);
+			pPixel[3] = std::byte{255};
+		}
+	}
+
+	return rayCount;
+}
+
+glm::vec3 CpuRenderer::Shade(const Ray &ray, uint32_t seed, uint64_t &rayCount) const noexcept {
+	++rayCount;
+
+	RayHit hit{};
+	if (!m_Bvh.Intersect(ray, hit))
+		return glm::vec3{0.f};
+
+	const TriangleShading &shading{m_Shading[hit.triangle]};
+	const glm::vec3        color{shading.c0 * (1.f - hit.u - hit.v) + shading.c1 * hit.u + shading.c2 * hit.v};
+
+	// Occlusion is gathered on the side the ray came from, the scene's triangles are all double sided
+	const glm::vec3 normal{glm::dot(shading.normal, ray.direction) > 0.f ? -shading.normal : shading.normal};
+	const glm::vec3 position{ray.origin + ray.direction * hit.distance};
+
+	return color * TraceOcclusion(position, normal, seed, rayCount);
+}
+
+float CpuRenderer::TraceOcclusion(
+        const glm::vec3 &position, const glm::vec3 &normal, uint32_t seed, uint64_t &rayCount
+) const noexcept {
+	// Orthonormal basis around the normal without any branches on its direction (Duff et al. 2017)
+	const float     sign{std::copysign(1.f, normal.z)};
+	const float     a{-1.f / (sign + normal.z)};
+	const float     b{normal.x * normal.y * a};
+	const glm::vec3 tangent{1.f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x};
+	const glm::vec3 bitangent{b, sign + normal.y * normal.y * a, -normal.y};
+
+	uint32_t state{seed};
+	uint32_t unoccludedCount{0};
+
+	for (uint32_t i{0}; i < OCCLUSION_RAY_COUNT; ++i) {
+		// Cosine weighted, so the unoccluded fraction is the ambient occlusion estimate without further weighting
+		const float radius{std::sqrt(NextRandom(state))};
+		const float angle{2.f * std::numbers::pi_v<float> * NextRandom(state)};
+		const float z{std::sqrt(std::max(0.f, 1.f - radius * radius))};
+
+		Ray occlusionRay{};
+		occlusionRay.origin = position + normal * RAY_EPSILON;
+		occlusionRay.direction =
+		        tangent * (radius * std::cos(angle)) + bitangent * (radius * std::sin(angle)) + normal * z;
+		occlusionRay.tMin = RAY_EPSILON;
+		occlusionRay.tMax = OCCLUSION_DISTANCE;
+
+		if (!m_Bvh.IsOccluded(occlusionRay))
+			++unoccludedCount;
+	}
+
+	rayCount += OCCLUSION_RAY_COUNT;
+
+	return static_cast<float>(unoccludedCount) / static_cast<float>(OCCLUSION_RAY_COUNT);
+}
+
+std::vector<BvhTriangle> CpuRenderer::GetSceneTriangles(const Scene &scene) {
+	const SceneStreams streams{scene.GetStreams()};
+
+	std::vector<BvhTriangle> triangles{};
+	triangles.reserve(streams.GetIndexCount() / 3 * scene.instanceCount);
+
+	for (uint32_t instance{0}; instance < scene.instanceCount; ++instance) {
+		const VkTransformMatrixKHR transform{scene.GetInstanceTransform(instance)};
+
+		const auto toWorld{[&transform](const Vertex &vertex) {
+			glm::vec3 position{};
+			for (int row{0}; row < 3; ++row) {
+				position[row] = transform.matrix[row][0] * vertex.pos.x + transform.matrix[row][1] * vertex.pos.y +
+				                transform.matrix[row][2] * vertex.pos.z + transform.matrix[row][3];
+			}
+
+			return position;
+		}};
+
+		for (size_t i{0}; i + 2 < streams.GetIndexCount(); i += 3) {
+			triangles.push_back(BvhTriangle{
+			        toWorld(streams.vertices[streams.GetIndex(i)]), toWorld(streams.vertices[streams.GetIndex(i + 1)]),
+			        toWorld(streams.vertices[streams.GetIndex(i + 2)])
+			});
+		}
+	}
+
+	return triangles;
+}
+
+uint32_t CpuRenderer::Hash(uint32_t value) noexcept {
+	// PCG output permutation, cheap and good enough to decorrelate neighbouring pixels
+	const uint32_t state{value * 747796405u + 2891336453u};
+	const uint32_t word{((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u};
+
+	return (word >> 22u) ^ word;
+}
+
+float CpuRenderer::NextRandom(uint32_t &state) noexcept {
+	state = Hash(state);
+
+	return static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+}
+
+std::byte CpuRenderer::EncodeSrgb(float linear) noexcept {
+	const float clamped{std::clamp(linear, 0.f, 1.f)};
+	const float encoded{clamped <= .0031308f ? clamped * 12.92f : 1.055f * std::pow(clamped, 1.f / 2.4f) - .055f};
+
+	return static_cast<std::byte>(static_cast<uint8_t>(encoded * 255.f + .5f));
+}
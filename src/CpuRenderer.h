@@ -0,0 +1,142 @@
+#ifndef PORTAL2RAYTRACED_CPURENDERER_H
+#define PORTAL2RAYTRACED_CPURENDERER_H
+
+#include "Bvh.h"
+#include "ProgressiveAccumulation.h"
+#include "Scene.h"
+#include "TileScheduler.h"
+#include "WideBvh.h"
+#include <cstddef>
+#include <cstdint>
+#include <glm\glm.hpp>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+struct CpuRenderStatistics {
+	BvhStatistics          bvh{};
+	WideBvhStatistics      wideBvh{};
+	TileStatistics         tiles{};
+	AccumulationStatistics accumulation{};
+	uint64_t               rayCount{};
+	double                 renderMilliseconds{};
+	// The last Render was cancelled, its image is missing the tiles that never ran
+	bool cancelled{};
+};
+
+std::ostream &operator<<(std::ostream &ostream, const CpuRenderStatistics &statistics);
+
+// Reference renderer that needs no GPU at all. Traces the same orthographic primary rays as raytrace.rgen against a
+// BVH over the flattened scene instances, plus a handful of ambient occlusion rays per hit. Flat scenes therefore
+// come out identical to the Vulkan renderers, which makes the output usable as a correctness reference.
+class CpuRenderer final {
+public:
+	explicit CpuRenderer(unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency()));
+
+	CpuRenderer(const CpuRenderer &) = delete;
+
+	CpuRenderer &operator=(const CpuRenderer &) = delete;
+
+	// Applies the instance transforms and builds the BVH, the scene itself is not referenced afterwards.
+	void SetScene(const Scene &scene);
+
+	// Skips the BVH build, bvh has to be built over GetSceneTriangles(scene). The geometry is read from streams, which
+	// lets a cooked scene pass its mapping instead of scene.GetStreams(). Throws std::invalid_argument when the BVH's
+	// triangle count does not match.
+	void SetScene(const Scene &scene, const SceneStreams &streams, const Bvh &bvh);
+
+	// Off by default. When on, every Render adds one jittered sample per pixel to the previous ones and returns the
+	// average, until SetScene, a new resolution, a Cancel or Invalidate starts over.
+	void SetProgressive(bool enabled, uint32_t targetSamplesPerPixel) noexcept;
+
+	// Discards the accumulated samples, for changes the renderer cannot see itself
+	void Invalidate() noexcept;
+
+	// Defaults to the widest kernels the CPU supports, see WideBvh::SetSimdLevel.
+	SimdLevel SetSimdLevel(SimdLevel simdLevel) noexcept;
+
+	// Edge length of the square tiles the image is split into, in pixels. Defaults to DEFAULT_TILE_SIZE.
+	void SetTileSize(uint32_t tileSize) noexcept;
+
+	// Tightly packed RGBA8 rows, sRGB encoded like the Vulkan renderers' targets. Every pixel seeds its own random
+	// sequence per sample, so the result depends on neither the thread count nor the tile size.
+	[[nodiscard]]
+	std::vector<std::byte> Render(uint32_t width, uint32_t height);
+
+	// Makes a Render running on another thread return early, for when the view changes mid frame. Tiles that never
+	// ran stay black.
+	void Cancel() noexcept;
+
+	[[nodiscard]]
+	const CpuRenderStatistics &GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+
+	[[nodiscard]]
+	const std::vector<TileTiming> &GetTileTimings() const noexcept {
+		return m_Scheduler.GetTileTimings();
+	}
+
+	[[nodiscard]]
+	uint32_t GetThreadCount() const noexcept {
+		return m_Scheduler.GetThreadCount();
+	}
+
+	// Every instance's triangles in world space, numbered the way SetScene numbers them
+	[[nodiscard]]
+	static std::vector<BvhTriangle> GetSceneTriangles(const Scene &scene);
+
+	static constexpr uint32_t DEFAULT_TILE_SIZE{32};
+
+private:
+	// The BVH reorders its triangles, so everything shading needs is kept here by original triangle index
+	struct TriangleShading {
+		glm::vec3 c0{};
+		glm::vec3 c1{};
+		glm::vec3 c2{};
+		glm::vec3 normal{};
+	};
+
+	// Adds one sample to every pixel of the tile and returns the number of rays traced
+	[[nodiscard]]
+	uint64_t RenderTile(
+	        uint32_t width, uint32_t height, const Tile &tile, uint32_t sampleIndex, glm::vec3 *pAccumulatedColors,
+	        std::byte *pPixels
+	) const noexcept;
+
+	[[nodiscard]]
+	glm::vec3 Shade(const Ray &ray, uint32_t seed, uint64_t &rayCount) const noexcept;
+
+	[[nodiscard]]
+	float TraceOcclusion(
+	        const glm::vec3 &position, const glm::vec3 &normal, uint32_t seed, uint64_t &rayCount
+	) const noexcept;
+
+	[[nodiscard]]
+	static uint32_t Hash(uint32_t value) noexcept;
+
+	[[nodiscard]]
+	static float NextRandom(uint32_t &state) noexcept;
+
+	[[nodiscard]]
+	static std::byte EncodeSrgb(float linear) noexcept;
+
+	static constexpr uint32_t OCCLUSION_RAY_COUNT{8};
+	// Occluders further away than this do not darken a hit, in scene units ([-1, 1] covers the screen)
+	static constexpr float    OCCLUSION_DISTANCE{.25f};
+	static constexpr float    RAY_EPSILON{1e-4f};
+
+	TileScheduler                m_Scheduler;
+	uint32_t                     m_TileSize{DEFAULT_TILE_SIZE};
+	WideBvh                      m_Bvh{};
+	std::vector<TriangleShading> m_Shading{};
+	ProgressiveAccumulation      m_Accumulation{};
+	// Sum of every sample taken since the last reset, in linear color
+	std::vector<glm::vec3> m_AccumulatedColors{};
+	uint32_t               m_AccumulationWidth{};
+	uint32_t               m_AccumulationHeight{};
+	CpuRenderStatistics    m_Statistics{};
+};
+
+
+#endif//PORTAL2RAYTRACED_CPURENDERER_H
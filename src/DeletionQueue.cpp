@@ -0,0 +1,64 @@
+#include "DeletionQueue.h"
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+std::ostream &operator<<(std::ostream &ostream, const DeletionQueueStatistics &statistics) {
+	return ostream << "Deletion queue: " << statistics.destroyedCount << " of " << statistics.enqueuedCount
+	               << " resources destroyed, at most " << statistics.peakPendingCount << " pending";
+}
+
+void DeletionQueue::Init(VkDevice device, MemoryAllocator &allocator) {
+	m_Device     = device;
+	m_pAllocator = &allocator;
+}
+
+void DeletionQueue::Cleanup() {
+	Collect(std::numeric_limits<uint64_t>::max());
+}
+
+void DeletionQueue::Enqueue(uint64_t frameValue, std::function<void()> destroy) {
+	m_Entries.push_back(Entry{frameValue, std::move(destroy)});
+
+	++m_Statistics.enqueuedCount;
+	m_Statistics.peakPendingCount = std::max(m_Statistics.peakPendingCount, m_Entries.size());
+}
+
+void DeletionQueue::DestroyBuffer(uint64_t frameValue, VkBuffer buffer, Allocation allocation) {
+	Enqueue(frameValue, [this, buffer, allocation]() mutable { m_pAllocator->DestroyBuffer(buffer, allocation); });
+}
+
+void DeletionQueue::DestroyImage(uint64_t frameValue, VkImage image, Allocation allocation) {
+	Enqueue(frameValue, [this, image, allocation]() mutable { m_pAllocator->DestroyImage(image, allocation); });
+}
+
+void DeletionQueue::DestroyImageView(uint64_t frameValue, VkImageView imageView) {
+	Enqueue(frameValue, [this, imageView] { vkDestroyImageView(m_Device, imageView, nullptr); });
+}
+
+void DeletionQueue::DestroyFramebuffer(uint64_t frameValue, VkFramebuffer framebuffer) {
+	Enqueue(frameValue, [this, framebuffer] { vkDestroyFramebuffer(m_Device, framebuffer, nullptr); });
+}
+
+void DeletionQueue::DestroyPipeline(uint64_t frameValue, VkPipeline pipeline) {
+	Enqueue(frameValue, [this, pipeline] { vkDestroyPipeline(m_Device, pipeline, nullptr); });
+}
+
+void DeletionQueue::DestroySwapChain(uint64_t frameValue, VkSwapchainKHR swapChain) {
+	Enqueue(frameValue, [this, swapChain] { vkDestroySwapchainKHR(m_Device, swapChain, nullptr); });
+}
+
+void DeletionQueue::Free(uint64_t frameValue, Allocation allocation) {
+	Enqueue(frameValue, [this, allocation]() mutable { m_pAllocator->Free(allocation); });
+}
+
+void DeletionQueue::Collect(uint64_t completedValue) {
+	while (!m_Entries.empty() && m_Entries.front().frameValue <= completedValue) {
+		// Popped first, so a destroy function may queue further resources
+		const std::function<void()> destroy{std::move(m_Entries.front().destroy)};
+		m_Entries.pop_front();
+
+		destroy();
+		++m_Statistics.destroyedCount;
+	}
+}
@@ -0,0 +1,81 @@
+#ifndef PORTAL2RAYTRACED_DELETIONQUEUE_H
+#define PORTAL2RAYTRACED_DELETIONQUEUE_H
+
+#include "MemoryAllocator.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <ostream>
+#include <vulkan/vulkan.h>
+
+struct DeletionQueueStatistics {
+	uint64_t enqueuedCount{};
+	uint64_t destroyedCount{};
+	// Most resources waiting at once
+	size_t peakPendingCount{};
+};
+
+std::ostream &operator<<(std::ostream &ostream, const DeletionQueueStatistics &statistics);
+
+// Defers destroying Vulkan objects until the GPU is done with them. Every resource is queued with the frame timeline
+// value of the last frame that may still use it and destroyed by the first Collect that sees the timeline past it, so
+// replacing a resource at runtime never needs a vkDeviceWaitIdle. Resources are destroyed in the order they were
+// queued, one queued with a smaller value than its predecessor simply waits for it.
+class DeletionQueue final {
+public:
+	DeletionQueue() = default;
+
+	DeletionQueue(const DeletionQueue &) = delete;
+
+	DeletionQueue &operator=(const DeletionQueue &) = delete;
+
+	void Init(VkDevice device, MemoryAllocator &allocator);
+
+	// Destroys everything still queued, the device has to be idle.
+	void Cleanup();
+
+	// destroy runs on the thread calling Collect once the timeline reached frameValue.
+	void Enqueue(uint64_t frameValue, std::function<void()> destroy);
+
+	void DestroyBuffer(uint64_t frameValue, VkBuffer buffer, Allocation allocation);
+
+	void DestroyImage(uint64_t frameValue, VkImage image, Allocation allocation);
+
+	void DestroyImageView(uint64_t frameValue, VkImageView imageView);
+
+	void DestroyFramebuffer(uint64_t frameValue, VkFramebuffer framebuffer);
+
+	void DestroyPipeline(uint64_t frameValue, VkPipeline pipeline);
+
+	void DestroySwapChain(uint64_t frameValue, VkSwapchainKHR swapChain);
+
+	// Returns a memory block sub-allocation that was bound to a resource destroyed separately.
+	void Free(uint64_t frameValue, Allocation allocation);
+
+	// Destroys everything queued with a value up to completedValue.
+	void Collect(uint64_t completedValue);
+
+	[[nodiscard]]
+	size_t GetPendingCount() const noexcept {
+		return m_Entries.size();
+	}
+
+	[[nodiscard]]
+	const DeletionQueueStatistics &GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+
+private:
+	struct Entry {
+		uint64_t              frameValue{};
+		std::function<void()> destroy{};
+	};
+
+	VkDevice                m_Device{};
+	MemoryAllocator        *m_pAllocator{};
+	std::deque<Entry>       m_Entries{};
+	DeletionQueueStatistics m_Statistics{};
+};
+
+
+#endif//PORTAL2RAYTRACED_DELETIONQUEUE_H
@@ -0,0 +1,123 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vulkan/vk_enum_string_helper.h>
+
+namespace {
+	// A present to a minimized or occluded window may never complete, waiting for it must not stall the frame loop
+	constexpr uint64_t PRESENT_WAIT_TIMEOUT{100'000'000};
+}// namespace
+
+std::ostream &operator<<(std::ostream &ostream, const PresentStatistics &statistics) {
+	const auto policyIterator{std::find_if(
+	        ApplicationConfig::PRESENT_POLICY_NAMES.cbegin(), ApplicationConfig::PRESENT_POLICY_NAMES.cend(),
+	        [&statistics](const auto &policy) { return policy.second == statistics.policy; }
+	)};
+
+	return ostream << "Present: " << policyIterator->first << " policy on "
+	               << string_VkPresentModeKHR(statistics.presentMode) << ", queue depth " << statistics.meanQueueDepth
+	               << " mean, " << statistics.maxQueueDepth << " max over " << statistics.frameCount
+	               << " frames, present wait " << (statistics.presentWait ? "on" : "unavailable");
+}
+
+void FramePacer::Init(VkDevice device, PresentPolicy policy, uint32_t maxFramesPerSecond, bool presentWait) {
+	m_Device           = device;
+	m_Policy           = policy;
+	m_MinFrameInterval = maxFramesPerSecond == 0 ? Clock::duration::zero()
+	                                             : Clock::duration{std::chrono::seconds{1}} / maxFramesPerSecond;
+
+	m_Statistics             = PresentStatistics{};
+	m_Statistics.policy      = policy;
+	m_Statistics.presentWait = presentWait;
+
+	if (presentWait) {
+		m_vkWaitForPresentKHR =
+		        reinterpret_cast<PFN_vkWaitForPresentKHR>(vkGetDeviceProcAddr(device, "vkWaitForPresentKHR"));
+
+		if (m_vkWaitForPresentKHR == nullptr)
+			throw std::runtime_error{"Failed to load vkWaitForPresentKHR"};
+	}
+}
+
+void FramePacer::BeginFrame(const FrameTimeline &timeline, Profiler &profiler) {
+	{
+		const auto scope{profiler.ScopeCpu("cpu/pace")};
+
+		if (m_MinFrameInterval != Clock::duration::zero()) {
+			std::this_thread::sleep_until(m_NextFrameStart);
+
+			// A frame that started late pushes the schedule back instead of letting the next ones catch up in a burst
+			m_NextFrameStart = std::max(m_NextFrameStart, Clock::now()) + m_MinFrameInterval;
+		}
+
+		if (m_Policy == PresentPolicy::LowLatency) {
+			timeline.WaitIdle();
+
+			if (m_vkWaitForPresentKHR != nullptr && !m_PendingPresents.empty())
+				CollectPresents(profiler, PRESENT_WAIT_TIMEOUT);
+		}
+	}
+
+	if (m_vkWaitForPresentKHR != nullptr)
+		CollectPresents(profiler, 0);
+
+	const uint64_t submittedValue{timeline.GetFrameValue() - 1};
+	const uint64_t queueDepth{submittedValue - std::min(timeline.GetCompletedValue(), submittedValue)};
+
+	++m_Statistics.frameCount;
+	m_QueueDepthSum += queueDepth;
+	m_Statistics.maxQueueDepth  = std::max(m_Statistics.maxQueueDepth, static_cast<uint32_t>(queueDepth));
+	m_Statistics.meanQueueDepth = static_cast<double>(m_QueueDepthSum) / static_cast<double>(m_Statistics.frameCount);
+
+	m_FrameStart = Clock::now();
+}
+
+void FramePacer::AddPresentId(VkSwapchainKHR swapChain, VkPresentInfoKHR &presentInfo, VkPresentIdKHR &presentId) {
+	if (m_vkWaitForPresentKHR == nullptr)
+		return;
+
+	// Deque elements keep their address, the id stays valid for vkQueuePresentKHR
+	m_PendingPresents.push_back(PendingPresent{swapChain, m_NextPresentId++, m_FrameStart});
+
+	presentId                = VkPresentIdKHR{};
+	presentId.sType          = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+	presentId.pNext          = presentInfo.pNext;
+	presentId.swapchainCount = 1;
+	presentId.pPresentIds    = &m_PendingPresents.back().presentId;
+
+	presentInfo.pNext = &presentId;
+}
+
+void FramePacer::CollectPresents(Profiler &profiler, uint64_t timeout) {
+	// Presents complete in order, waiting for the newest one covers all earlier ones
+	if (timeout != 0) {
+		const PendingPresent &newest{m_PendingPresents.back()};
+		m_vkWaitForPresentKHR(m_Device, newest.swapChain, newest.presentId, timeout);
+	}
+
+	while (!m_PendingPresents.empty()) {
+		const PendingPresent &present{m_PendingPresents.front()};
+
+		const VkResult result{m_vkWaitForPresentKHR(m_Device, present.swapChain, present.presentId, 0)};
+
+		if (result == VK_TIMEOUT)
+			return;
+
+		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_ERROR_SURFACE_LOST_KHR) {
+			// The swap chain is about to be recreated, none of its presents will be reported
+			m_PendingPresents.clear();
+			return;
+		}
+
+		if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+			throw std::runtime_error{std::string{"Failed to wait for present: "} + string_VkResult(result)};
+
+		profiler.AddSample(
+		        "cpu/present_latency",
+		        std::chrono::duration<double, std::milli>{Clock::now() - present.frameStart}.count()
+		);
+		m_PendingPresents.pop_front();
+	}
+}
@@ -0,0 +1,87 @@
+#ifndef PORTAL2RAYTRACED_FRAMEPACER_H
+#define PORTAL2RAYTRACED_FRAMEPACER_H
+
+#include "ApplicationConfig.h"
+#include "FrameTimeline.h"
+#include "Profiler.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <vulkan/vulkan.h>
+
+struct PresentStatistics {
+	PresentPolicy    policy{};
+	VkPresentModeKHR presentMode{};
+	// VK_KHR_present_id and VK_KHR_present_wait, without them there are no present latency samples
+	bool     presentWait{};
+	uint64_t frameCount{};
+	// Frames submitted but not finished on the GPU when the next one started
+	double   meanQueueDepth{};
+	uint32_t maxQueueDepth{};
+};
+
+std::ostream &operator<<(std::ostream &ostream, const PresentStatistics &statistics);
+
+// Decides when the CPU may start a frame. A non-zero frame rate limit spaces frame starts evenly, PresentPolicy::
+// LowLatency additionally holds every frame back until the previous one finished and, with present wait, is on screen,
+// so input is sampled as late as possible. Timings go to the profiler: "cpu/pace" is the time held back and
+// "cpu/present_latency" the time from a frame's start to its presentation. Without LowLatency presents are only
+// polled once per frame, so that latency is rounded up to the next frame start.
+class FramePacer final {
+public:
+	FramePacer() = default;
+
+	FramePacer(const FramePacer &) = delete;
+
+	FramePacer &operator=(const FramePacer &) = delete;
+
+	// presentWait enables the present latency samples, the device needs the presentId and presentWait features.
+	void Init(VkDevice device, PresentPolicy policy, uint32_t maxFramesPerSecond, bool presentWait);
+
+	// Call before polling input. Blocks as the policy and frame rate limit demand.
+	void BeginFrame(const FrameTimeline &timeline, Profiler &profiler);
+
+	// Chains presentId into presentInfo when present wait is enabled, both have to outlive vkQueuePresentKHR.
+	void AddPresentId(VkSwapchainKHR swapChain, VkPresentInfoKHR &presentInfo, VkPresentIdKHR &presentId);
+
+	// Presents to a replaced swap chain can no longer be waited for.
+	void OnSwapChainRecreated() noexcept {
+		m_PendingPresents.clear();
+	}
+
+	void SetPresentMode(VkPresentModeKHR presentMode) noexcept {
+		m_Statistics.presentMode = presentMode;
+	}
+
+	[[nodiscard]]
+	const PresentStatistics &GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct PendingPresent {
+		VkSwapchainKHR    swapChain{};
+		uint64_t          presentId{};
+		Clock::time_point frameStart{};
+	};
+
+	// Samples the presents that completed, timeout 0 only polls
+	void CollectPresents(Profiler &profiler, uint64_t timeout);
+
+	VkDevice                   m_Device{};
+	PFN_vkWaitForPresentKHR    m_vkWaitForPresentKHR{};
+	PresentPolicy              m_Policy{};
+	Clock::duration            m_MinFrameInterval{};
+	Clock::time_point          m_NextFrameStart{};
+	Clock::time_point          m_FrameStart{};
+	uint64_t                   m_NextPresentId{1};
+	std::deque<PendingPresent> m_PendingPresents{};
+	uint64_t                   m_QueueDepthSum{};
+	PresentStatistics          m_Statistics{};
+};
+
+
+#endif//PORTAL2RAYTRACED_FRAMEPACER_H
@@ -0,0 +1,95 @@
+#include "FrameRingBuffer.h"
+#include "Alignment.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+void FrameRingBuffer::Init(
+        VkPhysicalDevice physicalDevice, MemoryAllocator &allocator, uint32_t frameCount,
+        bool accelerationStructureInputs, VkDeviceSize regionSize
+) {
+	m_pAllocator = &allocator;
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+	m_UniformAlignment = properties.limits.minUniformBufferOffsetAlignment;
+	m_StorageAlignment = properties.limits.minStorageBufferOffsetAlignment;
+
+	// Keeping every region aligned to the strictest requirement lets each frame start at offset 0 of its region
+	const VkDeviceSize regionAlignment{std::max({m_UniformAlignment, m_StorageAlignment, VkDeviceSize{16}})};
+	m_RegionSize = AlignUp(regionSize, regionAlignment);
+
+	VkBufferUsageFlags usage{
+	        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+	        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+	};
+	if (accelerationStructureInputs)
+		usage |= VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
+		         VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+	m_pAllocator->CreateBuffer(
+	        m_RegionSize * frameCount, usage, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+	        m_Buffer, m_Allocation
+	);
+
+	m_DeviceAddress = accelerationStructureInputs ? m_pAllocator->GetDeviceAddress(m_Buffer) : 0;
+
+	BeginFrame(0);
+}
+
+void FrameRingBuffer::Cleanup() {
+	m_pAllocator->DestroyBuffer(m_Buffer, m_Allocation);
+}
+
+void FrameRingBuffer::BeginFrame(uint32_t frameIndex) noexcept {
+	m_RegionBegin = m_RegionSize * frameIndex;
+	m_Head        = m_RegionBegin;
+}
+
+FrameAllocation FrameRingBuffer::Allocate(VkDeviceSize size, FrameDataUsage usage) {
+	if (usage == FrameDataUsage::AccelerationStructureInput && m_DeviceAddress == 0)
+		throw std::runtime_error{"Frame ring buffer was created without acceleration structure inputs"};
+
+	const VkDeviceSize alignment{GetAlignment(usage)};
+	const VkDeviceSize offset{AlignUp(m_Head, alignment)};
+
+	if (offset + size > m_RegionBegin + m_RegionSize) {
+		throw std::runtime_error{
+		        "Frame ring buffer region exhausted: requested " + std::to_string(size) + " bytes with " +
+		        std::to_string(m_RegionBegin + m_RegionSize - m_Head) + " bytes left"
+		};
+	}
+
+	m_Head = offset + size;
+
+	FrameAllocation allocation{};
+	allocation.buffer  = m_Buffer;
+	allocation.offset  = offset;
+	allocation.size    = size;
+	allocation.pMapped = static_cast<std::byte *>(m_Allocation.pMapped) + offset;
+	if (m_DeviceAddress != 0)
+		allocation.deviceAddress = m_DeviceAddress + offset;
+
+	return allocation;
+}
+
+VkDeviceSize FrameRingBuffer::GetAlignment(FrameDataUsage usage) const noexcept {
+	switch (usage) {
+		case FrameDataUsage::Uniform:
+			return m_UniformAlignment;
+		case FrameDataUsage::Storage:
+			return m_StorageAlignment;
+		case FrameDataUsage::Vertex:
+			// Covers the largest vertex attribute component (vec4 of 32-bit floats)
+			return 16;
+		case FrameDataUsage::AccelerationStructureInput:
+			// Required for VkAccelerationStructureInstanceKHR arrays
+			return 16;
+		case FrameDataUsage::Index:
+			return 4;
+		case FrameDataUsage::TransferSource:
+		default:
+			return 4;
+	}
+}
@@ -0,0 +1,87 @@
+#ifndef PORTAL2RAYTRACED_FRAMERINGBUFFER_H
+#define PORTAL2RAYTRACED_FRAMERINGBUFFER_H
+
+#include "MemoryAllocator.h"
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vulkan/vulkan.h>
+
+enum class FrameDataUsage { Uniform, Storage, Vertex, Index, TransferSource, AccelerationStructureInput };
+
+struct FrameAllocation {
+	VkBuffer        buffer{};
+	VkDeviceSize    offset{};
+	VkDeviceSize    size{};
+	void           *pMapped{};
+	// Only set when the ring was created with accelerationStructureInputs
+	VkDeviceAddress deviceAddress{};
+};
+
+// One persistently mapped host-visible buffer split into a region per frame in flight.
+// Allocations are a bump of the current region's offset, the region is rewound once its frame's fence signalled.
+class FrameRingBuffer final {
+public:
+	FrameRingBuffer() = default;
+
+	FrameRingBuffer(const FrameRingBuffer &) = delete;
+
+	FrameRingBuffer &operator=(const FrameRingBuffer &) = delete;
+
+	// accelerationStructureInputs allows FrameDataUsage::AccelerationStructureInput, the allocator needs device
+	// addresses for it.
+	void Init(
+	        VkPhysicalDevice physicalDevice, MemoryAllocator &allocator, uint32_t frameCount,
+	        bool accelerationStructureInputs, VkDeviceSize regionSize = DEFAULT_REGION_SIZE
+	);
+
+	void Cleanup();
+
+	// Only call once the fence of the frame that last used this region has been waited on.
+	void BeginFrame(uint32_t frameIndex) noexcept;
+
+	[[nodiscard]]
+	FrameAllocation Allocate(VkDeviceSize size, FrameDataUsage usage);
+
+	template<typename T>
+	[[nodiscard]]
+	FrameAllocation Write(const T &data, FrameDataUsage usage) {
+		FrameAllocation allocation{Allocate(sizeof(T), usage)};
+		memcpy(allocation.pMapped, &data, sizeof(T));
+
+		return allocation;
+	}
+
+	template<typename T>
+	[[nodiscard]]
+	FrameAllocation WriteArray(std::span<const T> data, FrameDataUsage usage) {
+		FrameAllocation allocation{Allocate(data.size_bytes(), usage)};
+		memcpy(allocation.pMapped, data.data(), data.size_bytes());
+
+		return allocation;
+	}
+
+	[[nodiscard]]
+	VkDeviceSize GetUsedBytes() const noexcept {
+		return m_Head - m_RegionBegin;
+	}
+
+	static constexpr VkDeviceSize DEFAULT_REGION_SIZE{4ull * 1024 * 1024};
+
+private:
+	[[nodiscard]]
+	VkDeviceSize GetAlignment(FrameDataUsage usage) const noexcept;
+
+	MemoryAllocator *m_pAllocator{};
+	VkBuffer         m_Buffer{};
+	Allocation       m_Allocation{};
+	VkDeviceAddress  m_DeviceAddress{};
+	VkDeviceSize     m_RegionSize{};
+	VkDeviceSize     m_RegionBegin{};
+	VkDeviceSize     m_Head{};
+	VkDeviceSize     m_UniformAlignment{};
+	VkDeviceSize     m_StorageAlignment{};
+};
+
+
+#endif//PORTAL2RAYTRACED_FRAMERINGBUFFER_H
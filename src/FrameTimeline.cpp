@@ -0,0 +1,60 @@
+#include "FrameTimeline.h"
+#include <stdexcept>
+#include <string>
+#include <vulkan/vk_enum_string_helper.h>
+
+void FrameTimeline::Init(VkDevice device, uint32_t framesInFlight) {
+	m_Device         = device;
+	m_FramesInFlight = framesInFlight;
+	m_FrameValue     = 1;
+
+	VkSemaphoreTypeCreateInfo semaphoreTypeInfo{};
+	semaphoreTypeInfo.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	semaphoreTypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	semaphoreTypeInfo.initialValue  = 0;
+
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &semaphoreTypeInfo;
+
+	if (const VkResult result{vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &m_Semaphore)};
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to create frame timeline semaphore: "} + string_VkResult(result)};
+	}
+}
+
+void FrameTimeline::Cleanup() {
+	vkDestroySemaphore(m_Device, m_Semaphore, nullptr);
+	m_Semaphore = VK_NULL_HANDLE;
+}
+
+uint32_t FrameTimeline::BeginFrame() {
+	// The first framesInFlight frames find their slot unused, Wait(0) is a no-op for them
+	Wait(m_FrameValue > m_FramesInFlight ? m_FrameValue - m_FramesInFlight : 0);
+
+	return GetFrameSlot();
+}
+
+void FrameTimeline::Wait(uint64_t value) const {
+	if (value == 0)
+		return;
+
+	VkSemaphoreWaitInfo waitInfo{};
+	waitInfo.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores    = &m_Semaphore;
+	waitInfo.pValues        = &value;
+
+	if (const VkResult result{vkWaitSemaphores(m_Device, &waitInfo, UINT64_MAX)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to wait for frame: "} + string_VkResult(result)};
+	}
+}
+
+uint64_t FrameTimeline::GetCompletedValue() const {
+	uint64_t value{};
+	if (const VkResult result{vkGetSemaphoreCounterValue(m_Device, m_Semaphore, &value)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to query frame progress: "} + string_VkResult(result)};
+	}
+
+	return value;
+}
@@ -0,0 +1,79 @@
+#ifndef PORTAL2RAYTRACED_FRAMETIMELINE_H
+#define PORTAL2RAYTRACED_FRAMETIMELINE_H
+
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+// Frame pacing on a single timeline semaphore. Every submitted frame signals its frame number, so "the GPU is done
+// with frame n" is one counter comparison, and a frame slot may be reused once the frame framesInFlight before it
+// completed. 1 frame in flight trades throughput for the lowest latency, 3 keeps the GPU fed at the cost of latency.
+class FrameTimeline final {
+public:
+	FrameTimeline() = default;
+
+	FrameTimeline(const FrameTimeline &) = delete;
+
+	FrameTimeline &operator=(const FrameTimeline &) = delete;
+
+	// framesInFlight has to be between 1 and MAX_FRAMES_IN_FLIGHT.
+	void Init(VkDevice device, uint32_t framesInFlight);
+
+	void Cleanup();
+
+	// Blocks until the slot of the next frame is free again and returns it.
+	uint32_t BeginFrame();
+
+	// To be called once the frame that signals GetFrameValue() has been submitted, an abandoned frame keeps its number.
+	void EndFrame() noexcept {
+		++m_FrameValue;
+	}
+
+	// Blocks until the GPU has finished frame value, 0 returns immediately.
+	void Wait(uint64_t value) const;
+
+	// Blocks until every submitted frame has finished.
+	void WaitIdle() const {
+		Wait(m_FrameValue - 1);
+	}
+
+	[[nodiscard]]
+	uint64_t GetCompletedValue() const;
+
+	// Value the frame being recorded signals once it has finished on the GPU, starts at 1 and only ever grows.
+	[[nodiscard]]
+	uint64_t GetFrameValue() const noexcept {
+		return m_FrameValue;
+	}
+
+	[[nodiscard]]
+	uint32_t GetFrameSlot() const noexcept {
+		return static_cast<uint32_t>(m_FrameValue % m_FramesInFlight);
+	}
+
+	// Slot of the most recently submitted frame
+	[[nodiscard]]
+	uint32_t GetLastFrameSlot() const noexcept {
+		return static_cast<uint32_t>((m_FrameValue - 1) % m_FramesInFlight);
+	}
+
+	[[nodiscard]]
+	uint32_t GetFramesInFlight() const noexcept {
+		return m_FramesInFlight;
+	}
+
+	[[nodiscard]]
+	VkSemaphore GetSemaphore() const noexcept {
+		return m_Semaphore;
+	}
+
+	static constexpr uint32_t MAX_FRAMES_IN_FLIGHT{4};
+
+private:
+	VkDevice    m_Device{};
+	VkSemaphore m_Semaphore{};
+	uint32_t    m_FramesInFlight{};
+	uint64_t    m_FrameValue{1};
+};
+
+
+#endif//PORTAL2RAYTRACED_FRAMETIMELINE_H
@@ -0,0 +1,32 @@
+#include "ImageWriter.h"
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+void WriteImage(const std::filesystem::path &path, uint32_t width, uint32_t height, std::span<const std::byte> rgba) {
+	const size_t pixelCount{static_cast<size_t>(width) * height};
+
+	if (rgba.size() < pixelCount * 4)
+		throw std::invalid_argument{"Image data is smaller than width * height * 4"};
+
+	std::ofstream file{path, std::ios::binary | std::ios::trunc};
+	if (!file.is_open())
+		throw std::runtime_error{"Failed to open " + path.string() + " for writing"};
+
+	if (path.extension() != ".ppm") {
+		file.write(reinterpret_cast<const char *>(rgba.data()), static_cast<std::streamsize>(pixelCount * 4));
+		return;
+	}
+
+	file << "P6\n" << width << ' ' << height << "\n255\n";
+
+	std::vector<char> rgb(pixelCount * 3);
+	for (size_t i{0}; i < pixelCount; ++i) {
+		rgb[i * 3 + 0] = static_cast<char>(rgba[i * 4 + 0]);
+		rgb[i * 3 + 1] = static_cast<char>(rgba[i * 4 + 1]);
+		rgb[i * 3 + 2] = static_cast<char>(rgba[i * 4 + 2]);
+	}
+
+	file.write(rgb.data(), static_cast<std::streamsize>(rgb.size()));
+}
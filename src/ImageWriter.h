@@ -0,0 +1,14 @@
+#ifndef PORTAL2RAYTRACED_IMAGEWRITER_H
+#define PORTAL2RAYTRACED_IMAGEWRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+// Writes tightly packed RGBA8 rows. A .ppm extension produces a binary PPM (alpha dropped), any other extension
+// the raw bytes as they are.
+void WriteImage(const std::filesystem::path &path, uint32_t width, uint32_t height, std::span<const std::byte> rgba);
+
+
+#endif//PORTAL2RAYTRACED_IMAGEWRITER_H
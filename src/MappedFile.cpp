@@ -0,0 +1,119 @@
+#include "MappedFile.h"
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::filesystem::path &path) {
+#ifdef _WIN32
+	const HANDLE file{CreateFileW(
+	        path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+	)};
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error{"Failed to open file: " + path.string()};
+
+	LARGE_INTEGER fileSize{};
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		throw std::runtime_error{"Failed to query the size of file: " + path.string()};
+	}
+
+	m_Size = static_cast<size_t>(fileSize.QuadPart);
+
+	if (m_Size == 0) {
+		CloseHandle(file);
+		return;
+	}
+
+	const HANDLE mapping{CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr)};
+	CloseHandle(file);
+
+	if (mapping == nullptr)
+		throw std::runtime_error{"Failed to map file: " + path.string()};
+
+	// The view keeps the mapping object alive, so neither handle has to outlive this constructor
+	m_pData = static_cast<const std::byte *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	CloseHandle(mapping);
+#else
+	const int fileDescriptor{open(path.c_str(), O_RDONLY)};
+	if (fileDescriptor == -1)
+		throw std::runtime_error{"Failed to open file: " + path.string() + ": " + std::strerror(errno)};
+
+	struct stat fileStat {};
+	if (fstat(fileDescriptor, &fileStat) == -1) {
+		// close may overwrite errno
+		const int statError{errno};
+		close(fileDescriptor);
+		throw std::runtime_error{
+		        "Failed to query the size of file: " + path.string() + ": " + std::strerror(statError)
+		};
+	}
+
+	m_Size = static_cast<size_t>(fileStat.st_size);
+
+	if (m_Size == 0) {
+		close(fileDescriptor);
+		return;
+	}
+
+	void     *pData{mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0)};
+	const int mapError{errno};
+	close(fileDescriptor);
+
+	if (pData == MAP_FAILED) {
+		m_Size = 0;
+		throw std::runtime_error{"Failed to map file: " + path.string() + ": " + std::strerror(mapError)};
+	}
+
+	m_pData = static_cast<const std::byte *>(pData);
+#endif
+
+	if (m_pData == nullptr) {
+		m_Size = 0;
+		throw std::runtime_error{"Failed to map file: " + path.string()};
+	}
+}
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : m_pData{std::exchange(other.m_pData, nullptr)}
+    , m_Size{std::exchange(other.m_Size, 0)} {
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+	if (this != &other) {
+		Close();
+		m_pData = std::exchange(other.m_pData, nullptr);
+		m_Size  = std::exchange(other.m_Size, 0);
+	}
+
+	return *this;
+}
+
+void MappedFile::Close() noexcept {
+	if (m_pData == nullptr)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_pData);
+#else
+	munmap(const_cast<std::byte *>(m_pData), m_Size);
+#endif
+
+	m_pData = nullptr;
+	m_Size  = 0;
+}
@@ -0,0 +1,54 @@
+#ifndef PORTAL2RAYTRACED_MAPPEDFILE_H
+#define PORTAL2RAYTRACED_MAPPEDFILE_H
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+
+// Read-only memory mapping of a whole file. The OS pages the contents in on demand, nothing is copied to the heap.
+class MappedFile final {
+public:
+	MappedFile() = default;
+
+	explicit MappedFile(const std::filesystem::path &path);
+
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	MappedFile(MappedFile &&other) noexcept;
+
+	MappedFile &operator=(MappedFile &&other) noexcept;
+
+	[[nodiscard]]
+	std::span<const std::byte> GetData() const noexcept {
+		return {m_pData, m_Size};
+	}
+
+	// Mappings start on a page boundary, so any T with alignment up to the page size can be viewed in place.
+	template<typename T>
+	[[nodiscard]]
+	std::span<const T> As() const {
+		if (m_Size % sizeof(T) != 0)
+			throw std::runtime_error{"Mapped file size is not a multiple of the element size"};
+
+		return {reinterpret_cast<const T *>(m_pData), m_Size / sizeof(T)};
+	}
+
+	[[nodiscard]]
+	bool IsOpen() const noexcept {
+		return m_pData != nullptr;
+	}
+
+private:
+	void Close() noexcept;
+
+	const std::byte *m_pData{};
+	size_t           m_Size{};
+};
+
+
+#endif//PORTAL2RAYTRACED_MAPPEDFILE_H
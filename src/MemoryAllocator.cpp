@@ -0,0 +1,371 @@
+#include "MemoryAllocator.h"
+#include "Alignment.h"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vulkan/vk_enum_string_helper.h>
+
+float MemoryAllocatorStatistics::GetFragmentation() const noexcept {
+	const VkDeviceSize freeBytes{reservedBytes - usedBytes};
+
+	if (freeBytes == 0)
+		return 0.f;
+
+	return 1.f - static_cast<float>(largestFreeRange) / static_cast<float>(freeBytes);
+}
+
+std::ostream &operator<<(std::ostream &ostream, const MemoryAllocatorStatistics &statistics) {
+	return ostream << "Device memory: " << statistics.allocationCount << " allocations in " << statistics.blockCount
+	               << " blocks, " << statistics.usedBytes << '/' << statistics.reservedBytes << " bytes used (peak "
+	               << statistics.peakUsedBytes << "), " << statistics.freeRangeCount
+	               << " free ranges, largest free range " << statistics.largestFreeRange << " bytes, fragmentation "
+	               << statistics.GetFragmentation();
+}
+
+void MemoryAllocator::Init(VkPhysicalDevice physicalDevice, VkDevice device, bool deviceAddress) {
+	m_Device        = device;
+	m_DeviceAddress = deviceAddress;
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_MemoryProperties);
+
+	m_BlockSizes.resize(m_MemoryProperties.memoryTypeCount);
+	m_Pools.resize(m_MemoryProperties.memoryTypeCount * 2);
+
+	for (uint32_t i{0}; i < m_MemoryProperties.memoryTypeCount; ++i) {
+		// Small heaps (e.g. the 256 MiB host-visible device-local heap) shouldn't be eaten by a handful of blocks
+		const VkDeviceSize heapSize{m_MemoryProperties.memoryHeaps[m_MemoryProperties.memoryTypes[i].heapIndex].size};
+		m_BlockSizes[i] = std::min(DEFAULT_BLOCK_SIZE, heapSize / 8);
+
+		m_Pools[i * 2].memoryTypeIndex     = i;
+		m_Pools[i * 2 + 1].memoryTypeIndex = i;
+	}
+}
+
+void MemoryAllocator::Cleanup() {
+	std::lock_guard lock{m_Mutex};
+
+	for (auto &pool: m_Pools) {
+		for (auto &block: pool.blocks) {
+			if (block)
+				DestroyBlock(*block);
+		}
+
+		pool.blocks.clear();
+	}
+
+	m_UsedBytes       = 0;
+	m_AllocationCount = 0;
+}
+
+Allocation
+MemoryAllocator::Allocate(const VkMemoryRequirements &requirements, uint32_t memoryTypeIndex, ResourceTiling tiling) {
+	std::lock_guard lock{m_Mutex};
+
+	const uint32_t poolIndex{memoryTypeIndex * 2 + (tiling == ResourceTiling::Optimal ? 1 : 0)};
+	Pool          &pool{m_Pools.at(poolIndex)};
+
+	Allocation allocation{};
+	allocation.size      = requirements.size;
+	allocation.poolIndex = poolIndex;
+
+	const VkDeviceSize blockSize{m_BlockSizes[memoryTypeIndex]};
+
+	Block *pTargetBlock{};
+	if (requirements.size > blockSize / 2) {
+		// Large resources get a block of their own instead of wasting the tail of a shared one
+		pTargetBlock = &CreateBlock(pool, requirements.size, true, allocation.blockIndex);
+		pTargetBlock->freeRanges.clear();
+		allocation.offset = 0;
+	} else {
+		for (uint32_t i{0}; i < pool.blocks.size(); ++i) {
+			Block *pBlock{pool.blocks[i].get()};
+			if (pBlock == nullptr || pBlock->dedicated)
+				continue;
+
+			if (TryAllocateFromBlock(*pBlock, requirements.size, requirements.alignment, allocation.offset)) {
+				pTargetBlock          = pBlock;
+				allocation.blockIndex = i;
+				break;
+			}
+		}
+
+		if (pTargetBlock == nullptr) {
+			pTargetBlock = &CreateBlock(pool, blockSize, false, allocation.blockIndex);
+
+			if (!TryAllocateFromBlock(*pTargetBlock, requirements.size, requirements.alignment, allocation.offset)) {
+				throw std::runtime_error{"Failed to sub-allocate from a fresh memory block"};
+			}
+		}
+	}
+
+	++pTargetBlock->allocationCount;
+	allocation.memory  = pTargetBlock->memory;
+	allocation.pMapped = pTargetBlock->pMapped ? pTargetBlock->pMapped + allocation.offset : nullptr;
+
+	++m_AllocationCount;
+	m_UsedBytes += allocation.size;
+	m_PeakUsedBytes = std::max(m_PeakUsedBytes, m_UsedBytes);
+
+	return allocation;
+}
+
+void MemoryAllocator::Free(Allocation &allocation) {
+	if (!allocation.IsValid())
+		return;
+
+	std::lock_guard lock{m_Mutex};
+
+	Pool  &pool{m_Pools.at(allocation.poolIndex)};
+	auto  &pBlock{pool.blocks.at(allocation.blockIndex)};
+	Block &block{*pBlock};
+
+	--m_AllocationCount;
+	m_UsedBytes -= allocation.size;
+
+	const bool keepBlock{
+	        !block.dedicated &&
+	        (block.allocationCount > 1 || std::count_if(pool.blocks.cbegin(), pool.blocks.cend(), [](const auto &b) {
+		         return b && !b->dedicated;
+	         }) == 1)
+	};
+
+	if (!keepBlock) {
+		DestroyBlock(block);
+		pBlock.reset();
+		allocation = {};
+		return;
+	}
+
+	--block.allocationCount;
+
+	VkDeviceSize offset{allocation.offset};
+	VkDeviceSize size{allocation.size};
+
+	auto next{block.freeRanges.lower_bound(offset)};
+	if (next != block.freeRanges.end() && offset + size == next->first) {
+		size += next->second;
+		next = block.freeRanges.erase(next);
+	}
+
+	if (next != block.freeRanges.begin()) {
+		auto previous{std::prev(next)};
+		if (previous->first + previous->second == offset) {
+			offset = previous->first;
+			size += previous->second;
+			block.freeRanges.erase(previous);
+		}
+	}
+
+	block.freeRanges.emplace(offset, size);
+
+	allocation = {};
+}
+
+void MemoryAllocator::CreateBuffer(
+        VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer,
+        Allocation &bufferAllocation
+) {
+	VkBufferCreateInfo bufferInfo{};
+	bufferInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size        = size;
+	bufferInfo.usage       = usage;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if (const VkResult result{vkCreateBuffer(m_Device, &bufferInfo, nullptr, &buffer)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to create buffer: "} + string_VkResult(result)};
+	}
+
+	VkMemoryRequirements memoryRequirements;
+	vkGetBufferMemoryRequirements(m_Device, buffer, &memoryRequirements);
+
+	bufferAllocation = Allocate(
+	        memoryRequirements, FindMemoryType(memoryRequirements.memoryTypeBits, properties), ResourceTiling::Linear
+	);
+
+	if (const VkResult result{
+	            vkBindBufferMemory(m_Device, buffer, bufferAllocation.memory, bufferAllocation.offset)
+	    };
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to bind buffer memory: "} + string_VkResult(result)};
+	}
+}
+
+void MemoryAllocator::DestroyBuffer(VkBuffer &buffer, Allocation &bufferAllocation) {
+	vkDestroyBuffer(m_Device, buffer, nullptr);
+	buffer = VK_NULL_HANDLE;
+
+	Free(bufferAllocation);
+}
+
+VkDeviceAddress MemoryAllocator::GetDeviceAddress(VkBuffer buffer) const {
+	VkBufferDeviceAddressInfo addressInfo{};
+	addressInfo.sType  = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+	addressInfo.buffer = buffer;
+
+	return vkGetBufferDeviceAddress(m_Device, &addressInfo);
+}
+
+void MemoryAllocator::CreateImage(
+        const VkImageCreateInfo &createInfo, VkMemoryPropertyFlags properties, VkImage &image,
+        Allocation &imageAllocation
+) {
+	if (const VkResult result{vkCreateImage(m_Device, &createInfo, nullptr, &image)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to create image: "} + string_VkResult(result)};
+	}
+
+	VkMemoryRequirements memoryRequirements;
+	vkGetImageMemoryRequirements(m_Device, image, &memoryRequirements);
+
+	imageAllocation = Allocate(
+	        memoryRequirements, FindMemoryType(memoryRequirements.memoryTypeBits, properties),
+	        createInfo.tiling == VK_IMAGE_TILING_OPTIMAL ? ResourceTiling::Optimal : ResourceTiling::Linear
+	);
+
+	if (const VkResult result{vkBindImageMemory(m_Device, image, imageAllocation.memory, imageAllocation.offset)};
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to bind image memory: "} + string_VkResult(result)};
+	}
+}
+
+void MemoryAllocator::DestroyImage(VkImage &image, Allocation &imageAllocation) {
+	vkDestroyImage(m_Device, image, nullptr);
+	image = VK_NULL_HANDLE;
+
+	Free(imageAllocation);
+}
+
+uint32_t MemoryAllocator::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+	//TODO: prefer vram resource
+	for (uint32_t i{0}; i < m_MemoryProperties.memoryTypeCount; i++) {
+		if (typeFilter & (1 << i) && (m_MemoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+			return i;
+		}
+	}
+
+	throw std::runtime_error{"Failed to find a suitable memory type"};
+}
+
+MemoryAllocatorStatistics MemoryAllocator::GetStatistics() const {
+	std::lock_guard lock{m_Mutex};
+
+	MemoryAllocatorStatistics statistics{};
+	statistics.allocationCount = m_AllocationCount;
+	statistics.usedBytes       = m_UsedBytes;
+	statistics.peakUsedBytes   = m_PeakUsedBytes;
+
+	for (const auto &pool: m_Pools) {
+		for (const auto &pBlock: pool.blocks) {
+			if (!pBlock)
+				continue;
+
+			++statistics.blockCount;
+			statistics.reservedBytes += pBlock->size;
+			statistics.freeRangeCount += pBlock->freeRanges.size();
+
+			for (const auto &[offset, size]: pBlock->freeRanges) {
+				statistics.largestFreeRange = std::max(statistics.largestFreeRange, size);
+			}
+		}
+	}
+
+	return statistics;
+}
+
+MemoryAllocator::Block &
+MemoryAllocator::CreateBlock(Pool &pool, VkDeviceSize size, bool dedicated, uint32_t &blockIndex) {
+	auto pBlock{std::make_unique<Block>()};
+	pBlock->size      = size;
+	pBlock->dedicated = dedicated;
+	pBlock->freeRanges.emplace(0, size);
+
+	VkMemoryAllocateFlagsInfo allocateFlagsInfo{};
+	allocateFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+	allocateFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+
+	VkMemoryAllocateInfo memoryAllocateInfo{};
+	memoryAllocateInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memoryAllocateInfo.pNext           = m_DeviceAddress ? &allocateFlagsInfo : nullptr;
+	memoryAllocateInfo.allocationSize  = size;
+	memoryAllocateInfo.memoryTypeIndex = pool.memoryTypeIndex;
+
+	if (const VkResult result{vkAllocateMemory(m_Device, &memoryAllocateInfo, nullptr, &pBlock->memory)};
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to allocate memory block: "} + string_VkResult(result)};
+	}
+
+	if (m_MemoryProperties.memoryTypes[pool.memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+		// Host-visible blocks stay mapped for their whole lifetime, a VkDeviceMemory can only be mapped once
+		void *data;
+		if (const VkResult result{vkMapMemory(m_Device, pBlock->memory, 0, VK_WHOLE_SIZE, 0, &data)};
+		    result != VK_SUCCESS) {
+			vkFreeMemory(m_Device, pBlock->memory, nullptr);
+			throw std::runtime_error{std::string{"Failed to map memory block: "} + string_VkResult(result)};
+		}
+
+		pBlock->pMapped = static_cast<std::byte *>(data);
+	}
+
+	const auto freeSlot{std::find(pool.blocks.begin(), pool.blocks.end(), nullptr)};
+	if (freeSlot != pool.blocks.end()) {
+		blockIndex = static_cast<uint32_t>(std::distance(pool.blocks.begin(), freeSlot));
+		*freeSlot  = std::move(pBlock);
+	} else {
+		blockIndex = static_cast<uint32_t>(pool.blocks.size());
+		pool.blocks.emplace_back(std::move(pBlock));
+	}
+
+	return *pool.blocks[blockIndex];
+}
+
+void MemoryAllocator::DestroyBlock(Block &block) {
+	if (block.pMapped)
+		vkUnmapMemory(m_Device, block.memory);
+
+	vkFreeMemory(m_Device, block.memory, nullptr);
+	block.memory = VK_NULL_HANDLE;
+}
+
+bool MemoryAllocator::TryAllocateFromBlock(
+        Block &block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &allocatedOffset
+) {
+	// Best fit: the smallest free range that still fits once aligned keeps large ranges intact
+	auto         bestRange{block.freeRanges.end()};
+	VkDeviceSize bestWaste{std::numeric_limits<VkDeviceSize>::max()};
+
+	for (auto it{block.freeRanges.begin()}; it != block.freeRanges.end(); ++it) {
+		const auto &[rangeOffset, rangeSize]{*it};
+
+		const VkDeviceSize alignedOffset{AlignUp(rangeOffset, alignment)};
+		const VkDeviceSize padding{alignedOffset - rangeOffset};
+
+		if (padding + size > rangeSize)
+			continue;
+
+		const VkDeviceSize waste{rangeSize - size};
+		if (waste < bestWaste) {
+			bestRange = it;
+			bestWaste = waste;
+		}
+	}
+
+	if (bestRange == block.freeRanges.end())
+		return false;
+
+	const VkDeviceSize rangeOffset{bestRange->first};
+	const VkDeviceSize rangeSize{bestRange->second};
+	const VkDeviceSize alignedOffset{AlignUp(rangeOffset, alignment)};
+	const VkDeviceSize rangeEnd{rangeOffset + rangeSize};
+	const VkDeviceSize allocationEnd{alignedOffset + size};
+
+	block.freeRanges.erase(bestRange);
+
+	if (alignedOffset > rangeOffset)
+		block.freeRanges.emplace(rangeOffset, alignedOffset - rangeOffset);
+
+	if (rangeEnd > allocationEnd)
+		block.freeRanges.emplace(allocationEnd, rangeEnd - allocationEnd);
+
+	allocatedOffset = alignedOffset;
+	return true;
+}
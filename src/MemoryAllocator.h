@@ -0,0 +1,130 @@
+#ifndef PORTAL2RAYTRACED_MEMORYALLOCATOR_H
+#define PORTAL2RAYTRACED_MEMORYALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Linear resources (buffers, linear images) and optimal images are kept in separate blocks so
+// bufferImageGranularity never has to be padded in between them.
+enum class ResourceTiling { Linear, Optimal };
+
+struct Allocation {
+	VkDeviceMemory memory{VK_NULL_HANDLE};
+	VkDeviceSize   offset{};
+	VkDeviceSize   size{};
+	void          *pMapped{};
+	uint32_t       poolIndex{};
+	uint32_t       blockIndex{};
+
+	[[nodiscard]]
+	bool IsValid() const noexcept {
+		return memory != VK_NULL_HANDLE;
+	}
+};
+
+struct MemoryAllocatorStatistics {
+	size_t       blockCount{};
+	size_t       allocationCount{};
+	size_t       freeRangeCount{};
+	VkDeviceSize reservedBytes{};
+	VkDeviceSize usedBytes{};
+	VkDeviceSize peakUsedBytes{};
+	VkDeviceSize largestFreeRange{};
+
+	// 0 when all free space is one contiguous range, approaching 1 as it gets split up.
+	[[nodiscard]]
+	float GetFragmentation() const noexcept;
+};
+
+std::ostream &operator<<(std::ostream &ostream, const MemoryAllocatorStatistics &statistics);
+
+class MemoryAllocator final {
+public:
+	MemoryAllocator() = default;
+
+	MemoryAllocator(const MemoryAllocator &) = delete;
+
+	MemoryAllocator &operator=(const MemoryAllocator &) = delete;
+
+	// With deviceAddress every block is allocated with VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, so buffers created
+	// with VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT can live in any of them. Needs the bufferDeviceAddress feature.
+	void Init(VkPhysicalDevice physicalDevice, VkDevice device, bool deviceAddress = false);
+
+	void Cleanup();
+
+	[[nodiscard]]
+	Allocation Allocate(const VkMemoryRequirements &requirements, uint32_t memoryTypeIndex, ResourceTiling tiling);
+
+	void Free(Allocation &allocation);
+
+	void CreateBuffer(
+	        VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer,
+	        Allocation &bufferAllocation
+	);
+
+	void DestroyBuffer(VkBuffer &buffer, Allocation &bufferAllocation);
+
+	[[nodiscard]]
+	VkDeviceAddress GetDeviceAddress(VkBuffer buffer) const;
+
+	void CreateImage(
+	        const VkImageCreateInfo &createInfo, VkMemoryPropertyFlags properties, VkImage &image,
+	        Allocation &imageAllocation
+	);
+
+	void DestroyImage(VkImage &image, Allocation &imageAllocation);
+
+	[[nodiscard]]
+	uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
+	[[nodiscard]]
+	MemoryAllocatorStatistics GetStatistics() const;
+
+private:
+	struct Block {
+		VkDeviceMemory memory{VK_NULL_HANDLE};
+		VkDeviceSize   size{};
+		std::byte     *pMapped{};
+		bool           dedicated{false};
+		size_t         allocationCount{};
+
+		// Free ranges keyed by offset, so neighbours can be merged on free.
+		std::map<VkDeviceSize, VkDeviceSize> freeRanges{};
+	};
+
+	struct Pool {
+		uint32_t                            memoryTypeIndex{};
+		std::vector<std::unique_ptr<Block>> blocks{};
+	};
+
+	[[nodiscard]]
+	Block &CreateBlock(Pool &pool, VkDeviceSize size, bool dedicated, uint32_t &blockIndex);
+
+	void DestroyBlock(Block &block);
+
+	[[nodiscard]]
+	static bool TryAllocateFromBlock(
+	        Block &block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &allocatedOffset
+	);
+
+	static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE{64ull * 1024 * 1024};
+
+	VkDevice                         m_Device{};
+	bool                             m_DeviceAddress{false};
+	VkPhysicalDeviceMemoryProperties m_MemoryProperties{};
+	std::vector<VkDeviceSize>        m_BlockSizes{};
+	std::vector<Pool>                m_Pools{};
+	VkDeviceSize                     m_UsedBytes{};
+	VkDeviceSize                     m_PeakUsedBytes{};
+	size_t                           m_AllocationCount{};
+	mutable std::mutex               m_Mutex{};
+};
+
+
+#endif//PORTAL2RAYTRACED_MEMORYALLOCATOR_H
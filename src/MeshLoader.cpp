@@ -0,0 +1,1030 @@
+#include "MeshLoader.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+std::ostream &operator<<(std::ostream &ostream, const MeshLoadStatistics &statistics) {
+	return ostream << "Mesh: " << statistics.vertexCount << " vertices, " << statistics.triangleCount << " triangles ("
+	               << (statistics.wideIndices ? 32 : 16) << "-bit indices) from " << statistics.fileBytes
+	               << " bytes in " << statistics.loadMilliseconds << " ms";
+}
+
+namespace {
+	// Waits for every job before rethrowing the first failure, the others may still reference the caller's locals
+	void WaitForJobs(std::vector<std::future<void>> &jobs) {
+		for (std::future<void> &job: jobs) { job.wait(); }
+		for (std::future<void> &job: jobs) { job.get(); }
+
+		jobs.clear();
+	}
+
+	// Calls function(begin, end) for consecutive ranges of at most rangeSize covering [0, count). Every job gets its
+	// own copy of function, so it may be a temporary of the caller.
+	template<typename Function>
+	void SubmitRanges(
+	        ThreadPool &threadPool, std::vector<std::future<void>> &jobs, size_t count, size_t rangeSize,
+	        const Function &function
+	) {
+		for (size_t begin{0}; begin < count; begin += rangeSize) {
+			const size_t end{std::min(begin + rangeSize, count)};
+			jobs.emplace_back(threadPool.Submit([function, begin, end] { function(begin, end); }));
+		}
+	}
+
+	std::string GetLowercaseExtension(const std::filesystem::path &path) {
+		std::string extension{path.extension().string()};
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char character) {
+			return static_cast<char>(std::tolower(character));
+		});
+
+		return extension;
+	}
+
+	// Front faces are counter-clockwise in both formats and clockwise in the raster pipeline, so b and c swap places
+	void WriteTriangle(Scene &scene, size_t triangle, uint32_t a, uint32_t b, uint32_t c) noexcept {
+		if (scene.GetStreams().HasWideIndices()) {
+			scene.wideIndices[triangle * 3]     = a;
+			scene.wideIndices[triangle * 3 + 1] = c;
+			scene.wideIndices[triangle * 3 + 2] = b;
+		} else {
+			scene.indices[triangle * 3]     = static_cast<uint16_t>(a);
+			scene.indices[triangle * 3 + 1] = static_cast<uint16_t>(c);
+			scene.indices[triangle * 3 + 2] = static_cast<uint16_t>(b);
+		}
+	}
+
+	// ---- Wavefront OBJ ----
+
+	// A run of whole lines, parsed by one job
+	struct ObjChunk {
+		std::string_view text{};
+		size_t           vertexCount{};
+		size_t           triangleCount{};
+		size_t           firstVertex{};
+		size_t           firstTriangle{};
+		bool             hasColors{};
+	};
+
+	[[nodiscard]]
+	bool IsObjSpace(char character) noexcept {
+		return character == ' ' || character == '\t' || character == '\r';
+	}
+
+	// Splits off the next whitespace separated token, empty once the line is used up
+	[[nodiscard]]
+	std::string_view NextObjToken(std::string_view &line) noexcept {
+		size_t begin{0};
+		while (begin < line.size() && IsObjSpace(line[begin])) { ++begin; }
+
+		size_t end{begin};
+		while (end < line.size() && !IsObjSpace(line[end])) { ++end; }
+
+		const std::string_view token{line.substr(begin, end - begin)};
+		line.remove_prefix(end);
+
+		return token;
+	}
+
+	// Lines are cut at '#', so both passes see the same tokens whether a comment has a line of its own or not
+	template<typename Function>
+	void ForEachObjLine(std::string_view text, const Function &function) {
+		while (!text.empty()) {
+			const size_t     lineEnd{text.find('\n')};
+			std::string_view line{text.substr(0, lineEnd)};
+			line = line.substr(0, line.find('#'));
+			function(line);
+
+			if (lineEnd == std::string_view::npos)
+				return;
+
+			text.remove_prefix(lineEnd + 1);
+		}
+	}
+
+	[[nodiscard]]
+	float ParseObjFloat(std::string_view token) {
+		float value{};
+		const auto [end, errorCode]{std::from_chars(token.data(), token.data() + token.size(), value)};
+
+		if (token.empty() || errorCode != std::errc{} || end != token.data() + token.size())
+			throw std::runtime_error{"Malformed number in OBJ file: " + std::string{token}};
+
+		return value;
+	}
+
+	// Face corners look like v, v/vt, v//vn or v/vt/vn, only v matters. Negative indices count back from the last
+	// vertex read so far.
+	[[nodiscard]]
+	uint32_t ParseObjIndex(std::string_view token, size_t verticesSoFar, size_t vertexCount) {
+		const std::string_view position{token.substr(0, token.find('/'))};
+
+		int64_t index{};
+		const auto [end, errorCode]{std::from_chars(position.data(), position.data() + position.size(), index)};
+
+		if (position.empty() || errorCode != std::errc{} || end != position.data() + position.size() || index == 0)
+			throw std::runtime_error{"Malformed face in OBJ file: " + std::string{token}};
+
+		const int64_t resolved{index > 0 ? index - 1 : static_cast<int64_t>(verticesSoFar) + index};
+		if (resolved < 0 || resolved >= static_cast<int64_t>(vertexCount))
+			throw std::runtime_error{"OBJ face references a vertex that does not exist: " + std::string{token}};
+
+		return static_cast<uint32_t>(resolved);
+	}
+
+	// ---- Binary glTF ----
+
+	// Just enough JSON for a glTF document. Strings are views into the mapped file with escapes left in, glTF only
+	// uses them for names and URIs.
+	struct JsonValue {
+		enum class Type {
+			Null,
+			Boolean,
+			Number,
+			String,
+			Array,
+			Object
+		};
+
+		Type             type{Type::Null};
+		bool             boolean{};
+		double           number{};
+		std::string_view string{};
+		// Array elements or object member values, for objects keys[i] names elements[i]
+		std::vector<JsonValue>        elements{};
+		std::vector<std::string_view> keys{};
+
+		[[nodiscard]]
+		const JsonValue *Find(std::string_view key) const noexcept {
+			for (size_t i{0}; i < keys.size(); ++i) {
+				if (keys[i] == key)
+					return &elements[i];
+			}
+
+			return nullptr;
+		}
+	};
+
+	class JsonParser final {
+	public:
+		explicit JsonParser(std::string_view text)
+		    : m_Text{text} {
+		}
+
+		[[nodiscard]]
+		JsonValue Parse() {
+			JsonValue value{ParseValue(0)};
+
+			SkipWhitespace();
+			if (m_Position != m_Text.size())
+				Fail();
+
+			return value;
+		}
+
+	private:
+		[[nodiscard]]
+		JsonValue ParseValue(uint32_t depth) {
+			if (depth > MAX_DEPTH)
+				Fail();
+
+			SkipWhitespace();
+			if (m_Position >= m_Text.size())
+				Fail();
+
+			JsonValue value{};
+
+			switch (m_Text[m_Position]) {
+				case '{':
+					value.type = JsonValue::Type::Object;
+					ParseMembers(value, depth);
+					break;
+				case '[':
+					value.type = JsonValue::Type::Array;
+					ParseElements(value, depth);
+					break;
+				case '"':
+					value.type   = JsonValue::Type::String;
+					value.string = ParseString();
+					break;
+				case 't':
+					ExpectLiteral("true");
+					value.type    = JsonValue::Type::Boolean;
+					value.boolean = true;
+					break;
+				case 'f':
+					ExpectLiteral("false");
+					value.type = JsonValue::Type::Boolean;
+					break;
+				case 'n':
+					ExpectLiteral("null");
+					break;
+				default:
+					value.type   = JsonValue::Type::Number;
+					value.number = ParseNumber();
+					break;
+			}
+
+			return value;
+		}
+
+		void ParseMembers(JsonValue &object, uint32_t depth) {
+			++m_Position;
+
+			SkipWhitespace();
+			if (TryConsume('}'))
+				return;
+
+			do {
+				SkipWhitespace();
+				if (m_Position >= m_Text.size() || m_Text[m_Position] != '"')
+					Fail();
+
+				object.keys.push_back(ParseString());
+
+				SkipWhitespace();
+				if (!TryConsume(':'))
+					Fail();
+
+				object.elements.push_back(ParseValue(depth + 1));
+				SkipWhitespace();
+			} while (TryConsume(','));
+
+			if (!TryConsume('}'))
+				Fail();
+		}
+
+		void ParseElements(JsonValue &array, uint32_t depth) {
+			++m_Position;
+
+			SkipWhitespace();
+			if (TryConsume(']'))
+				return;
+
+			do {
+				array.elements.push_back(ParseValue(depth + 1));
+				SkipWhitespace();
+			} while (TryConsume(','));
+
+			if (!TryConsume(']'))
+				Fail();
+		}
+
+		[[nodiscard]]
+		std::string_view ParseString() {
+			const size_t begin{++m_Position};
+
+			while (m_Position < m_Text.size() && m_Text[m_Position] != '"') {
+				m_Position += m_Text[m_Position] == '\\' ? 2 : 1;
+			}
+
+			if (m_Position >= m_Text.size())
+				Fail();
+
+			return m_Text.substr(begin, m_Position++ - begin);
+		}
+
+		[[nodiscard]]
+		double ParseNumber() {
+			double value{};
+			const char *const pEnd{m_Text.data() + m_Text.size()};
+			const auto [end, errorCode]{std::from_chars(m_Text.data() + m_Position, pEnd, value)};
+
+			if (errorCode != std::errc{})
+				Fail();
+
+			m_Position = static_cast<size_t>(end - m_Text.data());
+
+			return value;
+		}
+
+		void ExpectLiteral(std::string_view literal) {
+			if (m_Text.substr(m_Position, literal.size()) != literal)
+				Fail();
+
+			m_Position += literal.size();
+		}
+
+		[[nodiscard]]
+		bool TryConsume(char character) noexcept {
+			if (m_Position >= m_Text.size() || m_Text[m_Position] != character)
+				return false;
+
+			++m_Position;
+			return true;
+		}
+
+		void SkipWhitespace() noexcept {
+			while (m_Position < m_Text.size() &&
+			       (m_Text[m_Position] == ' ' || m_Text[m_Position] == '\t' || m_Text[m_Position] == '\n' ||
+			        m_Text[m_Position] == '\r')) {
+				++m_Position;
+			}
+		}
+
+		[[noreturn]]
+		void Fail() const {
+			throw std::runtime_error{"Malformed glTF JSON at offset " + std::to_string(m_Position)};
+		}
+
+		// glTF documents are shallow, anything deeper is broken or malicious
+		static constexpr uint32_t MAX_DEPTH{64};
+
+		std::string_view m_Text;
+		size_t           m_Position{0};
+	};
+
+	constexpr uint32_t GLB_MAGIC{0x46546C67};// "glTF"
+	constexpr uint32_t GLB_VERSION{2};
+	constexpr uint32_t GLB_JSON_CHUNK{0x4E4F534A};
+	constexpr uint32_t GLB_BINARY_CHUNK{0x004E4942};
+	constexpr uint32_t GLTF_TRIANGLES{4};
+
+	enum GltfComponentType : uint32_t {
+		UnsignedByte  = 5121,
+		UnsignedShort = 5123,
+		UnsignedInt   = 5125,
+		Float         = 5126
+	};
+
+	constexpr VkTransformMatrixKHR IDENTITY_TRANSFORM{
+	        {{1.f, 0.f, 0.f, 0.f}, {0.f, 1.f, 0.f, 0.f}, {0.f, 0.f, 1.f, 0.f}}
+	};
+
+	// One accessor resolved down to the bytes in the binary chunk
+	struct GltfAccessor {
+		const std::byte *pData{};
+		size_t           count{};
+		size_t           stride{};
+		uint32_t         componentType{};
+		uint32_t         componentCount{};
+	};
+
+	// A mesh primitive as placed by one node, with its slice of the scene's vertex and index arrays
+	struct GlbPrimitive {
+		VkTransformMatrixKHR transform{};
+		GltfAccessor         positions{};
+		GltfAccessor         colors{};
+		GltfAccessor         indices{};
+		size_t               firstVertex{};
+		size_t               firstTriangle{};
+		size_t               triangleCount{};
+	};
+
+	[[nodiscard]]
+	uint32_t ReadUint32(std::span<const std::byte> data, size_t offset) {
+		if (offset + sizeof(uint32_t) > data.size())
+			throw std::runtime_error{"Truncated .glb file"};
+
+		uint32_t value{};
+		memcpy(&value, data.data() + offset, sizeof(value));
+
+		return value;
+	}
+
+	[[nodiscard]]
+	const JsonValue &GetMember(const JsonValue &object, std::string_view key) {
+		const JsonValue *pMember{object.Find(key)};
+		if (pMember == nullptr)
+			throw std::runtime_error{"glTF object is missing \"" + std::string{key} + '"'};
+
+		return *pMember;
+	}
+
+	[[nodiscard]]
+	size_t GetSize(const JsonValue &value) {
+		if (value.type != JsonValue::Type::Number || value.number < 0.0 ||
+		    value.number > static_cast<double>(std::numeric_limits<uint32_t>::max()) ||
+		    value.number != static_cast<double>(static_cast<size_t>(value.number)))
+			throw std::runtime_error{"glTF index or size is not a non-negative integer"};
+
+		return static_cast<size_t>(value.number);
+	}
+
+	[[nodiscard]]
+	size_t GetOptionalSize(const JsonValue &object, std::string_view key, size_t fallback) {
+		const JsonValue *pMember{object.Find(key)};
+
+		return pMember == nullptr ? fallback : GetSize(*pMember);
+	}
+
+	[[nodiscard]]
+	const JsonValue &GetElement(const JsonValue &document, std::string_view arrayName, size_t index) {
+		const JsonValue &array{GetMember(document, arrayName)};
+		if (array.type != JsonValue::Type::Array || index >= array.elements.size())
+			throw std::runtime_error{"glTF " + std::string{arrayName} + " index out of range"};
+
+		return array.elements[index];
+	}
+
+	[[nodiscard]]
+	GltfAccessor GetAccessor(const JsonValue &document, size_t accessorIndex, std::span<const std::byte> binary) {
+		const JsonValue &accessor{GetElement(document, "accessors", accessorIndex)};
+
+		if (accessor.Find("sparse") != nullptr || accessor.Find("bufferView") == nullptr)
+			throw std::runtime_error{"Sparse glTF accessors are not supported"};
+
+		const JsonValue &bufferView{GetElement(document, "bufferViews", GetSize(GetMember(accessor, "bufferView")))};
+		const JsonValue &buffer{GetElement(document, "buffers", GetSize(GetMember(bufferView, "buffer")))};
+
+		if (GetSize(GetMember(bufferView, "buffer")) != 0 || buffer.Find("uri") != nullptr)
+			throw std::runtime_error{"Only self-contained .glb files are supported, found an external buffer"};
+
+		GltfAccessor result{};
+		result.count         = GetSize(GetMember(accessor, "count"));
+		result.componentType = static_cast<uint32_t>(GetSize(GetMember(accessor, "componentType")));
+
+		const std::string_view type{GetMember(accessor, "type").string};
+		if (type == "SCALAR") {
+			result.componentCount = 1;
+		} else if (type == "VEC2") {
+			result.componentCount = 2;
+		} else if (type == "VEC3") {
+			result.componentCount = 3;
+		} else if (type == "VEC4") {
+			result.componentCount = 4;
+		} else {
+			throw std::runtime_error{"Unsupported glTF accessor type: " + std::string{type}};
+		}
+
+		size_t componentSize{};
+		switch (result.componentType) {
+			case UnsignedByte:
+				componentSize = 1;
+				break;
+			case UnsignedShort:
+				componentSize = 2;
+				break;
+			case UnsignedInt:
+			case Float:
+				componentSize = 4;
+				break;
+			default:
+				throw std::runtime_error{
+				        "Unsupported glTF component type: " + std::to_string(result.componentType)
+				};
+		}
+
+		const size_t elementSize{componentSize * result.componentCount};
+		const size_t viewOffset{GetOptionalSize(bufferView, "byteOffset", 0)};
+		const size_t viewLength{GetSize(GetMember(bufferView, "byteLength"))};
+		const size_t accessorOffset{GetOptionalSize(accessor, "byteOffset", 0)};
+		result.stride = GetOptionalSize(bufferView, "byteStride", elementSize);
+
+		if (viewOffset + viewLength > binary.size() ||
+		    (result.count > 0 && accessorOffset + result.stride * (result.count - 1) + elementSize > viewLength))
+			throw std::runtime_error{"glTF accessor reaches past the end of the binary chunk"};
+
+		result.pData = binary.data() + viewOffset + accessorOffset;
+
+		return result;
+	}
+
+	[[nodiscard]]
+	float ReadComponent(const GltfAccessor &accessor, size_t element, uint32_t component) noexcept {
+		const std::byte *const pElement{accessor.pData + element * accessor.stride};
+
+		switch (accessor.componentType) {
+			case UnsignedByte:
+				return static_cast<float>(std::to_integer<uint8_t>(pElement[component])) / 255.f;
+			case UnsignedShort: {
+				uint16_t value{};
+				memcpy(&value, pElement + component * sizeof(value), sizeof(value));
+				return static_cast<float>(value) / 65535.f;
+			}
+			default: {
+				float value{};
+				memcpy(&value, pElement + component * sizeof(value), sizeof(value));
+				return value;
+			}
+		}
+	}
+
+	[[nodiscard]]
+	uint32_t ReadIndex(const GltfAccessor &accessor, size_t element) noexcept {
+		const std::byte *const pElement{accessor.pData + element * accessor.stride};
+
+		switch (accessor.componentType) {
+			case UnsignedByte:
+				return std::to_integer<uint32_t>(pElement[0]);
+			case UnsignedShort: {
+				uint16_t value{};
+				memcpy(&value, pElement, sizeof(value));
+				return value;
+			}
+			default: {
+				uint32_t value{};
+				memcpy(&value, pElement, sizeof(value));
+				return value;
+			}
+		}
+	}
+
+	// Both are affine, the result applies b first
+	[[nodiscard]]
+	VkTransformMatrixKHR Multiply(const VkTransformMatrixKHR &a, const VkTransformMatrixKHR &b) noexcept {
+		VkTransformMatrixKHR result{};
+		for (int row{0}; row < 3; ++row) {
+			for (int column{0}; column < 4; ++column) {
+				const float translation{column == 3 ? a.matrix[row][3] : 0.f};
+
+				result.matrix[row][column] = a.matrix[row][0] * b.matrix[0][column] +
+				                             a.matrix[row][1] * b.matrix[1][column] +
+				                             a.matrix[row][2] * b.matrix[2][column] + translation;
+			}
+		}
+
+		return result;
+	}
+
+	[[nodiscard]]
+	glm::vec3 TransformPoint(const VkTransformMatrixKHR &transform, const glm::vec3 &point) noexcept {
+		glm::vec3 result{};
+		for (int row{0}; row < 3; ++row) {
+			result[row] = transform.matrix[row][0] * point.x + transform.matrix[row][1] * point.y +
+			              transform.matrix[row][2] * point.z + transform.matrix[row][3];
+		}
+
+		return result;
+	}
+
+	// Mirroring transforms turn the winding around
+	[[nodiscard]]
+	bool IsMirrored(const VkTransformMatrixKHR &transform) noexcept {
+		const auto &m{transform.matrix};
+		const float determinant{
+		        m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+		        m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0])
+		};
+
+		return determinant < 0.f;
+	}
+
+	[[nodiscard]]
+	float GetNumber(const JsonValue &array, size_t index) {
+		if (array.type != JsonValue::Type::Array || index >= array.elements.size() ||
+		    array.elements[index].type != JsonValue::Type::Number)
+			throw std::runtime_error{"Malformed glTF node transform"};
+
+		return static_cast<float>(array.elements[index].number);
+	}
+
+	// Either a column-major matrix or translation * rotation * scale
+	[[nodiscard]]
+	VkTransformMatrixKHR GetNodeTransform(const JsonValue &node) {
+		VkTransformMatrixKHR transform{IDENTITY_TRANSFORM};
+
+		if (const JsonValue *pMatrix{node.Find("matrix")}; pMatrix != nullptr) {
+			for (int row{0}; row < 3; ++row) {
+				for (int column{0}; column < 4; ++column) {
+					transform.matrix[row][column] = GetNumber(*pMatrix, static_cast<size_t>(column * 4 + row));
+				}
+			}
+
+			return transform;
+		}
+
+		glm::vec3 scale{1.f, 1.f, 1.f};
+		if (const JsonValue *pScale{node.Find("scale")}; pScale != nullptr)
+			scale = glm::vec3{GetNumber(*pScale, 0), GetNumber(*pScale, 1), GetNumber(*pScale, 2)};
+
+		if (const JsonValue *pRotation{node.Find("rotation")}; pRotation != nullptr) {
+			const float x{GetNumber(*pRotation, 0)};
+			const float y{GetNumber(*pRotation, 1)};
+			const float z{GetNumber(*pRotation, 2)};
+			const float w{GetNumber(*pRotation, 3)};
+
+			transform.matrix[0][0] = 1.f - 2.f * (y * y + z * z);
+			transform.matrix[0][1] = 2.f * (x * y - z * w);
+			transform.matrix[0][2] = 2.f * (x * z + y * w);
+			transform.matrix[1][0] = 2.f * (x * y + z * w);
+			transform.matrix[1][1] = 1.f - 2.f * (x * x + z * z);
+			transform.matrix[1][2] = 2.f * (y * z - x * w);
+			transform.matrix[2][0] = 2.f * (x * z - y * w);
+			transform.matrix[2][1] = 2.f * (y * z + x * w);
+			transform.matrix[2][2] = 1.f - 2.f * (x * x + y * y);
+		}
+
+		for (int row{0}; row < 3; ++row) {
+			for (int column{0}; column < 3; ++column) { transform.matrix[row][column] *= scale[column]; }
+		}
+
+		if (const JsonValue *pTranslation{node.Find("translation")}; pTranslation != nullptr) {
+			for (int row{0}; row < 3; ++row) {
+				transform.matrix[row][3] = GetNumber(*pTranslation, static_cast<size_t>(row));
+			}
+		}
+
+		return transform;
+	}
+
+	void CollectPrimitives(
+	        const JsonValue &document, std::span<const std::byte> binary, size_t meshIndex,
+	        const VkTransformMatrixKHR &transform, std::vector<GlbPrimitive> &primitives
+	) {
+		const JsonValue &mesh{GetElement(document, "meshes", meshIndex)};
+
+		for (const JsonValue &primitive: GetMember(mesh, "primitives").elements) {
+			const JsonValue &attributes{GetMember(primitive, "attributes")};
+			const JsonValue *pPosition{attributes.Find("POSITION")};
+
+			// Points and lines have nothing for a ray to hit
+			if (GetOptionalSize(primitive, "mode", GLTF_TRIANGLES) != GLTF_TRIANGLES || pPosition == nullptr)
+				continue;
+
+			GlbPrimitive &result{primitives.emplace_back()};
+			result.transform = transform;
+			result.positions = GetAccessor(document, GetSize(*pPosition), binary);
+
+			if (result.positions.componentType != Float || result.positions.componentCount != 3)
+				throw std::runtime_error{"glTF positions have to be float vec3"};
+
+			if (const JsonValue *pColor{attributes.Find("COLOR_0")}; pColor != nullptr) {
+				result.colors = GetAccessor(document, GetSize(*pColor), binary);
+
+				if (result.colors.componentCount < 3 || result.colors.componentType == UnsignedInt ||
+				    result.colors.count < result.positions.count)
+					throw std::runtime_error{"Unsupported glTF vertex color format"};
+			}
+
+			size_t indexCount{result.positions.count};
+			if (const JsonValue *pIndices{primitive.Find("indices")}; pIndices != nullptr) {
+				result.indices = GetAccessor(document, GetSize(*pIndices), binary);
+				indexCount     = result.indices.count;
+
+				if (result.indices.componentType == Float || result.indices.componentCount != 1)
+					throw std::runtime_error{"glTF indices have to be unsigned scalars"};
+			}
+
+			result.triangleCount = indexCount / 3;
+		}
+	}
+
+	void CollectNode(
+	        const JsonValue &document, std::span<const std::byte> binary, size_t nodeIndex,
+	        const VkTransformMatrixKHR &parentTransform, uint32_t depth, std::vector<GlbPrimitive> &primitives
+	) {
+		const JsonValue &nodes{GetMember(document, "nodes")};
+
+		// Deeper than there are nodes means a node is its own ancestor
+		if (depth > nodes.elements.size())
+			throw std::runtime_error{"glTF node hierarchy contains a cycle"};
+
+		const JsonValue           &node{GetElement(document, "nodes", nodeIndex)};
+		const VkTransformMatrixKHR transform{Multiply(parentTransform, GetNodeTransform(node))};
+
+		if (const JsonValue *pMesh{node.Find("mesh")}; pMesh != nullptr)
+			CollectPrimitives(document, binary, GetSize(*pMesh), transform, primitives);
+
+		if (const JsonValue *pChildren{node.Find("children")}; pChildren != nullptr) {
+			for (const JsonValue &child: pChildren->elements) {
+				CollectNode(document, binary, GetSize(child), transform, depth + 1, primitives);
+			}
+		}
+	}
+}// namespace
+
+MeshLoader::MeshLoader(ThreadPool &threadPool)
+    : m_ThreadPool{threadPool} {
+}
+
+Scene MeshLoader::Load(const std::filesystem::path &path) {
+	const auto loadStart{std::chrono::steady_clock::now()};
+
+	const MappedFile file{path};
+
+	Scene scene{};
+	scene.name = path.stem().string();
+
+	const std::string extension{GetLowercaseExtension(path)};
+	if (extension == ".obj") {
+		LoadObj(file, scene);
+	} else if (extension == ".glb") {
+		LoadGlb(file, scene);
+	} else {
+		throw std::runtime_error{"Unsupported mesh format: " + path.string()};
+	}
+
+	const std::chrono::duration<double, std::milli> loadTime{std::chrono::steady_clock::now() - loadStart};
+	m_Statistics.fileBytes        = file.GetData().size();
+	m_Statistics.vertexCount      = static_cast<uint32_t>(scene.vertices.size());
+	m_Statistics.triangleCount    = static_cast<uint32_t>(scene.GetStreams().GetIndexCount() / 3);
+	m_Statistics.wideIndices      = scene.GetStreams().HasWideIndices();
+	m_Statistics.loadMilliseconds = loadTime.count();
+
+	return scene;
+}
+
+bool MeshLoader::IsMeshFile(const std::filesystem::path &path) {
+	const std::string extension{GetLowercaseExtension(path)};
+
+	return extension == ".obj" || extension == ".glb";
+}
+
+void MeshLoader::LoadObj(const MappedFile &file, Scene &scene) {
+	const std::span<const std::byte> data{file.GetData()};
+	const std::string_view           text{reinterpret_cast<const char *>(data.data()), data.size()};
+
+	// Every chunk ends right after a line break, so no line is split between two jobs
+	std::vector<ObjChunk> chunks(std::max<size_t>(1, text.size() / OBJ_BYTES_PER_JOB));
+	size_t                chunkBegin{0};
+	for (size_t i{0}; i < chunks.size(); ++i) {
+		size_t chunkEnd{text.size()};
+		if (i + 1 < chunks.size()) {
+			const size_t lineBreak{text.find('\n', std::max(chunkBegin, text.size() * (i + 1) / chunks.size()))};
+			chunkEnd = lineBreak == std::string_view::npos ? text.size() : lineBreak + 1;
+		}
+
+		chunks[i].text = text.substr(chunkBegin, chunkEnd - chunkBegin);
+		chunkBegin     = chunkEnd;
+	}
+
+	std::vector<std::future<void>> jobs{};
+
+	// First pass only counts, so the second one knows where each chunk's output goes
+	for (ObjChunk &chunk: chunks) {
+		jobs.emplace_back(m_ThreadPool.Submit([&chunk] {
+			ForEachObjLine(chunk.text, [&chunk](std::string_view line) {
+				const std::string_view keyword{NextObjToken(line)};
+
+				if (keyword == "v") {
+					++chunk.vertexCount;
+				} else if (keyword == "f") {
+					size_t cornerCount{0};
+					while (!NextObjToken(line).empty()) { ++cornerCount; }
+
+					// Polygons become triangle fans
+					if (cornerCount >= 3)
+						chunk.triangleCount += cornerCount - 2;
+				}
+			});
+		}));
+	}
+
+	WaitForJobs(jobs);
+
+	size_t vertexCount{0};
+	size_t triangleCount{0};
+	for (ObjChunk &chunk: chunks) {
+		chunk.firstVertex   = vertexCount;
+		chunk.firstTriangle = triangleCount;
+		vertexCount += chunk.vertexCount;
+		triangleCount += chunk.triangleCount;
+	}
+
+	if (triangleCount == 0)
+		throw std::runtime_error{"OBJ file contains no faces"};
+
+	AllocateGeometry(scene, vertexCount, triangleCount * 3);
+
+	for (ObjChunk &chunk: chunks) {
+		jobs.emplace_back(m_ThreadPool.Submit([&chunk, &scene, vertexCount] {
+			size_t vertex{chunk.firstVertex};
+			size_t triangle{chunk.firstTriangle};
+
+			ForEachObjLine(chunk.text, [&](std::string_view line) {
+				const std::string_view keyword{NextObjToken(line)};
+
+				if (keyword == "v") {
+					Vertex &result{scene.vertices[vertex++]};
+					result.pos.x = ParseObjFloat(NextObjToken(line));
+					result.pos.y = ParseObjFloat(NextObjToken(line));
+					result.pos.z = ParseObjFloat(NextObjToken(line));
+
+					// Vertex colors are a common extension, x y z r g b. A lone fourth value is the standard's optional
+					// w, it is ignored like anything else that is not exactly three extra values
+					std::array<std::string_view, 3> extra{};
+					size_t                          extraCount{0};
+					for (std::string_view token{NextObjToken(line)}; !token.empty(); token = NextObjToken(line)) {
+						if (extraCount < extra.size())
+							extra[extraCount] = token;
+
+						++extraCount;
+					}
+
+					if (extraCount == extra.size()) {
+						result.color.r  = ParseObjFloat(extra[0]);
+						result.color.g  = ParseObjFloat(extra[1]);
+						result.color.b  = ParseObjFloat(extra[2]);
+						chunk.hasColors = true;
+					} else {
+						result.color = glm::vec3{1.f, 1.f, 1.f};
+					}
+				} else if (keyword == "f") {
+					uint32_t first{};
+					uint32_t previous{};
+					size_t   corner{0};
+
+					for (std::string_view token{NextObjToken(line)}; !token.empty(); token = NextObjToken(line)) {
+						const uint32_t index{ParseObjIndex(token, vertex, vertexCount)};
+
+						if (corner == 0) {
+							first = index;
+						} else if (corner >= 2) {
+							WriteTriangle(scene, triangle++, first, previous, index);
+						}
+
+						previous = index;
+						++corner;
+					}
+				}
+			});
+		}));
+	}
+
+	WaitForJobs(jobs);
+
+	const bool hasColors{
+	        std::any_of(chunks.cbegin(), chunks.cend(), [](const ObjChunk &chunk) { return chunk.hasColors; })
+	};
+	FitToView(scene, hasColors);
+}
+
+void MeshLoader::LoadGlb(const MappedFile &file, Scene &scene) {
+	const std::span<const std::byte> data{file.GetData()};
+
+	if (ReadUint32(data, 0) != GLB_MAGIC || ReadUint32(data, 4) != GLB_VERSION)
+		throw std::runtime_error{"Not a glTF 2.0 binary file"};
+
+	// The JSON chunk always comes first, the binary one is optional and second
+	const size_t jsonLength{ReadUint32(data, 12)};
+	if (ReadUint32(data, 16) != GLB_JSON_CHUNK || 20 + jsonLength > data.size())
+		throw std::runtime_error{"Malformed .glb JSON chunk"};
+
+	std::span<const std::byte> binary{};
+	if (const size_t binaryHeader{20 + jsonLength}; binaryHeader + 8 <= data.size()) {
+		const size_t binaryLength{ReadUint32(data, binaryHeader)};
+
+		if (ReadUint32(data, binaryHeader + 4) != GLB_BINARY_CHUNK || binaryHeader + 8 + binaryLength > data.size())
+			throw std::runtime_error{"Malformed .glb binary chunk"};
+
+		binary = data.subspan(binaryHeader + 8, binaryLength);
+	}
+
+	const JsonValue document{
+	        JsonParser{std::string_view{reinterpret_cast<const char *>(data.data() + 20), jsonLength}}.Parse()
+	};
+
+	std::vector<GlbPrimitive> primitives{};
+	if (const JsonValue *pScenes{document.Find("scenes")}; pScenes != nullptr && !pScenes->elements.empty()) {
+		const JsonValue &rootScene{GetElement(document, "scenes", GetOptionalSize(document, "scene", 0))};
+
+		if (const JsonValue *pRoots{rootScene.Find("nodes")}; pRoots != nullptr) {
+			for (const JsonValue &root: pRoots->elements) {
+				CollectNode(document, binary, GetSize(root), IDENTITY_TRANSFORM, 0, primitives);
+			}
+		}
+	} else if (const JsonValue *pMeshes{document.Find("meshes")}; pMeshes != nullptr) {
+		// Without a scene there is nothing placing the meshes, so each is used once as is
+		for (size_t mesh{0}; mesh < pMeshes->elements.size(); ++mesh) {
+			CollectPrimitives(document, binary, mesh, IDENTITY_TRANSFORM, primitives);
+		}
+	}
+
+	size_t vertexCount{0};
+	size_t triangleCount{0};
+	bool   hasColors{false};
+	for (GlbPrimitive &primitive: primitives) {
+		primitive.firstVertex   = vertexCount;
+		primitive.firstTriangle = triangleCount;
+		vertexCount += primitive.positions.count;
+		triangleCount += primitive.triangleCount;
+		hasColors = hasColors || primitive.colors.pData != nullptr;
+	}
+
+	if (triangleCount == 0)
+		throw std::runtime_error{".glb file contains no triangles"};
+
+	AllocateGeometry(scene, vertexCount, triangleCount * 3);
+
+	std::vector<std::future<void>> jobs{};
+
+	// Big primitives are split up too, so one huge mesh still spreads over every worker
+	for (const GlbPrimitive &primitive: primitives) {
+		const auto writeVertices{[&primitive, &scene](size_t begin, size_t end) {
+			for (size_t i{begin}; i < end; ++i) {
+				Vertex &vertex{scene.vertices[primitive.firstVertex + i]};
+
+				const glm::vec3 position{
+				        ReadComponent(primitive.positions, i, 0), ReadComponent(primitive.positions, i, 1),
+				        ReadComponent(primitive.positions, i, 2)
+				};
+				vertex.pos = TransformPoint(primitive.transform, position);
+
+				if (primitive.colors.pData == nullptr) {
+					vertex.color = glm::vec3{1.f, 1.f, 1.f};
+				} else {
+					vertex.color = glm::vec3{
+					        ReadComponent(primitive.colors, i, 0), ReadComponent(primitive.colors, i, 1),
+					        ReadComponent(primitive.colors, i, 2)
+					};
+				}
+			}
+		}};
+
+		const auto writeTriangles{[&primitive, &scene](size_t begin, size_t end) {
+			const bool   mirrored{IsMirrored(primitive.transform)};
+			const size_t vertexCount{primitive.positions.count};
+
+			for (size_t triangle{begin}; triangle < end; ++triangle) {
+				std::array<uint32_t, 3> corners{};
+				for (uint32_t corner{0}; corner < 3; ++corner) {
+					const size_t element{triangle * 3 + corner};
+					corners[corner] = primitive.indices.pData == nullptr ? static_cast<uint32_t>(element)
+					                                                      : ReadIndex(primitive.indices, element);
+
+					if (corners[corner] >= vertexCount)
+						throw std::runtime_error{"glTF index references a vertex that does not exist"};
+
+					corners[corner] += static_cast<uint32_t>(primitive.firstVertex);
+				}
+
+				if (mirrored)
+					std::swap(corners[1], corners[2]);
+
+				WriteTriangle(scene, primitive.firstTriangle + triangle, corners[0], corners[1], corners[2]);
+			}
+		}};
+
+		SubmitRanges(m_ThreadPool, jobs, primitive.positions.count, ELEMENTS_PER_JOB, writeVertices);
+		SubmitRanges(m_ThreadPool, jobs, primitive.triangleCount, ELEMENTS_PER_JOB, writeTriangles);
+	}
+
+	WaitForJobs(jobs);
+
+	FitToView(scene, hasColors);
+}
+
+void MeshLoader::AllocateGeometry(Scene &scene, size_t vertexCount, size_t indexCount) {
+	if (vertexCount > std::numeric_limits<uint32_t>::max() || indexCount > std::numeric_limits<uint32_t>::max())
+		throw std::runtime_error{"Mesh has more vertices or indices than 32-bit indices can address"};
+
+	// Every element is written by exactly one job, the value initialization is only there to size the arrays
+	scene.vertices.resize(vertexCount);
+
+	if (vertexCount > Scene::MAX_NARROW_VERTEX_COUNT) {
+		scene.wideIndices.resize(indexCount);
+	} else {
+		scene.indices.resize(indexCount);
+	}
+}
+
+void MeshLoader::FitToView(Scene &scene, bool hasColors) {
+	const size_t jobCount{(scene.vertices.size() + ELEMENTS_PER_JOB - 1) / ELEMENTS_PER_JOB};
+
+	std::vector<glm::vec3>         minimums(jobCount, glm::vec3{std::numeric_limits<float>::max()});
+	std::vector<glm::vec3>         maximums(jobCount, glm::vec3{std::numeric_limits<float>::lowest()});
+	std::vector<std::future<void>> jobs{};
+
+	const auto gatherBounds{[&scene, &minimums, &maximums](size_t begin, size_t end) {
+		const size_t job{begin / ELEMENTS_PER_JOB};
+
+		for (size_t i{begin}; i < end; ++i) {
+			minimums[job] = glm::min(minimums[job], scene.vertices[i].pos);
+			maximums[job] = glm::max(maximums[job], scene.vertices[i].pos);
+		}
+	}};
+
+	SubmitRanges(m_ThreadPool, jobs, scene.vertices.size(), ELEMENTS_PER_JOB, gatherBounds);
+	WaitForJobs(jobs);
+
+	glm::vec3 minimum{std::numeric_limits<float>::max()};
+	glm::vec3 maximum{std::numeric_limits<float>::lowest()};
+	for (size_t job{0}; job < jobCount; ++job) {
+		minimum = glm::min(minimum, minimums[job]);
+		maximum = glm::max(maximum, maximums[job]);
+	}
+
+	const glm::vec3 center{(minimum + maximum) * .5f};
+	const glm::vec3 extent{maximum - minimum};
+	const float     largestExtent{std::max({extent.x, extent.y, extent.z})};
+	const float     scale{largestExtent > 0.f ? 1.8f / largestExtent : 1.f};
+
+	// Half a turn around x, so a y-up mesh faces the viewer looking down +z with y pointing down
+	const glm::vec3 orientation{scale, -scale, -scale};
+
+	const auto moveIntoView{[&scene, center, orientation, hasColors](size_t begin, size_t end) {
+		for (size_t i{begin}; i < end; ++i) {
+			Vertex &vertex{scene.vertices[i]};
+			vertex.pos = (vertex.pos - center) * orientation;
+
+			if (!hasColors)
+				vertex.color = glm::vec3{
+				        vertex.pos.x / 1.8f + .5f, vertex.pos.y / 1.8f + .5f, vertex.pos.z / 1.8f + .5f
+				};
+		}
+	}};
+
+	SubmitRanges(m_ThreadPool, jobs, scene.vertices.size(), ELEMENTS_PER_JOB, moveIntoView);
+	WaitForJobs(jobs);
+}
@@ -0,0 +1,69 @@
+#ifndef PORTAL2RAYTRACED_MESHLOADER_H
+#define PORTAL2RAYTRACED_MESHLOADER_H
+
+#include "MappedFile.h"
+#include "Scene.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+
+struct MeshLoadStatistics {
+	uint64_t fileBytes{};
+	uint32_t vertexCount{};
+	uint32_t triangleCount{};
+	bool     wideIndices{};
+	double   loadMilliseconds{};
+};
+
+std::ostream &operator<<(std::ostream &ostream, const MeshLoadStatistics &statistics);
+
+// Turns a Wavefront OBJ or binary glTF 2.0 (.glb) file into a Scene. The file is memory mapped and parsed on the
+// thread pool. A first pass sizes the output, a second writes every vertex and index straight into the scene's final
+// arrays at precomputed offsets. Indices only become 32-bit when there are more vertices than 16 bits can address.
+//
+// The renderers look down +z with y pointing down, so meshes are turned to face them the way a y-up, -z forward
+// camera would see them, then centered and scaled into the [-0.9, 0.9] cube like the built-in scenes. Vertex colors
+// are used when present. Otherwise the normalized position doubles as the color.
+class MeshLoader final {
+public:
+	explicit MeshLoader(ThreadPool &threadPool);
+
+	MeshLoader(const MeshLoader &) = delete;
+
+	MeshLoader &operator=(const MeshLoader &) = delete;
+
+	// Throws std::runtime_error when the file cannot be read or uses something the loader does not support.
+	[[nodiscard]]
+	Scene Load(const std::filesystem::path &path);
+
+	[[nodiscard]]
+	const MeshLoadStatistics &GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+
+	// Decided by the extension alone, .obj or .glb
+	[[nodiscard]]
+	static bool IsMeshFile(const std::filesystem::path &path);
+
+private:
+	void LoadObj(const MappedFile &file, Scene &scene);
+
+	void LoadGlb(const MappedFile &file, Scene &scene);
+
+	// Sizes the index array that fits vertexCount vertices
+	static void AllocateGeometry(Scene &scene, size_t vertexCount, size_t indexCount);
+
+	// Moves the mesh into view and fills in missing colors
+	void FitToView(Scene &scene, bool hasColors);
+
+	// Work per job, large enough that scheduling is noise next to parsing
+	static constexpr size_t OBJ_BYTES_PER_JOB{size_t{4} << 20};
+	static constexpr size_t ELEMENTS_PER_JOB{size_t{1} << 16};
+
+	ThreadPool        &m_ThreadPool;
+	MeshLoadStatistics m_Statistics{};
+};
+
+
+#endif//PORTAL2RAYTRACED_MESHLOADER_H
@@ -0,0 +1,206 @@
+#include "PipelineBuilder.h"
+#include <stdexcept>
+#include <vulkan/vk_enum_string_helper.h>
+
+void PipelineBuilder::Init(
+        VkDevice device, ThreadPool &threadPool, PipelineCache &pipelineCache, ShaderLibrary &shaderLibrary,
+        const RayTracingFunctions &rayTracingFunctions
+) {
+	m_Device               = device;
+	m_pThreadPool          = &threadPool;
+	m_pPipelineCache       = &pipelineCache;
+	m_pShaderLibrary       = &shaderLibrary;
+	m_pRayTracingFunctions = &rayTracingFunctions;
+}
+
+void PipelineBuilder::Cleanup() {
+	std::lock_guard lock{m_Mutex};
+
+	for (auto &[name, shaderModule]: m_ShaderModules) {
+		// A module whose creation threw has nothing to destroy
+		try {
+			vkDestroyShaderModule(m_Device, shaderModule.get(), nullptr);
+		} catch (const std::exception &) {}
+	}
+
+	m_ShaderModules.clear();
+	m_Pipelines.clear();
+}
+
+std::shared_future<VkShaderModule> PipelineBuilder::RequestShaderModule(std::string_view name) {
+	std::lock_guard lock{m_Mutex};
+
+	if (const auto it{m_ShaderModules.find(name)}; it != m_ShaderModules.end())
+		return it->second;
+
+	std::shared_future<VkShaderModule> shaderModule{
+	        m_pThreadPool->Submit([this, name = std::string{name}] { return CreateShaderModule(name); })
+	};
+	m_ShaderModules.emplace(name, shaderModule);
+
+	return shaderModule;
+}
+
+std::shared_future<VkPipeline> PipelineBuilder::BuildGraphicsPipeline(GraphicsPipelineDescription description) {
+	// Module jobs are queued before the pipeline job, so waiting on them from inside the pool can't deadlock
+	std::vector<std::shared_future<VkShaderModule>> shaderModules{RequestShaderModules(description.stages)};
+
+	std::shared_future<VkPipeline> pipeline{m_pThreadPool->Submit(
+	        [this, description = std::move(description), shaderModules = std::move(shaderModules)] {
+		        return CreateGraphicsPipeline(description, shaderModules);
+	        }
+	)};
+
+	std::lock_guard lock{m_Mutex};
+	m_Pipelines.emplace_back(pipeline);
+
+	return pipeline;
+}
+
+std::shared_future<VkPipeline> PipelineBuilder::BuildRayTracingPipeline(RayTracingPipelineDescription description) {
+	std::vector<std::shared_future<VkShaderModule>> shaderModules{RequestShaderModules(description.stages)};
+
+	std::shared_future<VkPipeline> pipeline{m_pThreadPool->Submit(
+	        [this, description = std::move(description), shaderModules = std::move(shaderModules)] {
+		        return CreateRayTracingPipeline(description, shaderModules);
+	        }
+	)};
+
+	std::lock_guard lock{m_Mutex};
+	m_Pipelines.emplace_back(pipeline);
+
+	return pipeline;
+}
+
+void PipelineBuilder::WaitAll() {
+	std::vector<std::shared_future<VkPipeline>> pipelines{};
+
+	{
+		std::lock_guard lock{m_Mutex};
+		pipelines = m_Pipelines;
+	}
+
+	for (const auto &pipeline: pipelines) { static_cast<void>(pipeline.get()); }
+
+	std::lock_guard lock{m_Mutex};
+	for (const auto &[name, shaderModule]: m_ShaderModules) { static_cast<void>(shaderModule.get()); }
+}
+
+VkShaderModule PipelineBuilder::CreateShaderModule(std::string_view name) {
+	const std::span<const uint32_t> code{m_pShaderLibrary->GetCode(name)};
+
+	VkShaderModuleCreateInfo createInfo{};
+	createInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	createInfo.codeSize = code.size_bytes();
+	createInfo.pCode    = code.data();
+
+	VkShaderModule shaderModule{};
+	if (const VkResult result{vkCreateShaderModule(m_Device, &createInfo, nullptr, &shaderModule)};
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{
+		        "Failed to create shader module " + std::string{name} + ": " + string_VkResult(result)
+		};
+	}
+
+	return shaderModule;
+}
+
+VkPipeline PipelineBuilder::CreateGraphicsPipeline(
+        const GraphicsPipelineDescription                     &description,
+        const std::vector<std::shared_future<VkShaderModule>> &shaderModules
+) {
+	const std::vector<VkPipelineShaderStageCreateInfo> shaderStages{GetShaderStages(description.stages, shaderModules)};
+
+	VkPipelineDynamicStateCreateInfo dynamicStateInfo{};
+	dynamicStateInfo.sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicStateInfo.dynamicStateCount = description.dynamicStates.size();
+	dynamicStateInfo.pDynamicStates    = description.dynamicStates.data();
+
+	VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+	vertexInputInfo.sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertexInputInfo.vertexBindingDescriptionCount   = description.vertexBindings.size();
+	vertexInputInfo.pVertexBindingDescriptions      = description.vertexBindings.data();
+	vertexInputInfo.vertexAttributeDescriptionCount = description.vertexAttributes.size();
+	vertexInputInfo.pVertexAttributeDescriptions    = description.vertexAttributes.data();
+
+	// Viewport and scissor are dynamic, only their count is baked in
+	VkPipelineViewportStateCreateInfo viewportStateInfo{};
+	viewportStateInfo.sType         = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewportStateInfo.viewportCount = 1;
+	viewportStateInfo.scissorCount  = 1;
+
+	VkPipelineColorBlendStateCreateInfo colorBlending{description.colorBlend};
+	colorBlending.attachmentCount = description.colorBlendAttachments.size();
+	colorBlending.pAttachments    = description.colorBlendAttachments.data();
+
+	const bool hasDepthStencil{
+	        description.depthStencil.sType == VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO
+	};
+
+	VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
+	pipelineCreateInfo.sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineCreateInfo.stageCount          = shaderStages.size();
+	pipelineCreateInfo.pStages             = shaderStages.data();
+	pipelineCreateInfo.pVertexInputState   = &vertexInputInfo;
+	pipelineCreateInfo.pInputAssemblyState = &description.inputAssembly;
+	pipelineCreateInfo.pViewportState      = &viewportStateInfo;
+	pipelineCreateInfo.pRasterizationState = &description.rasterization;
+	pipelineCreateInfo.pMultisampleState   = &description.multisample;
+	pipelineCreateInfo.pDepthStencilState  = hasDepthStencil ? &description.depthStencil : nullptr;
+	pipelineCreateInfo.pColorBlendState    = &colorBlending;
+	pipelineCreateInfo.pDynamicState       = &dynamicStateInfo;
+	pipelineCreateInfo.layout              = description.layout;
+	pipelineCreateInfo.renderPass          = description.renderPass;
+	pipelineCreateInfo.subpass             = description.subpass;
+	pipelineCreateInfo.basePipelineHandle  = VK_NULL_HANDLE;
+	pipelineCreateInfo.basePipelineIndex   = -1;
+
+	return m_pPipelineCache->CreateGraphicsPipeline(pipelineCreateInfo, description.name);
+}
+
+VkPipeline PipelineBuilder::CreateRayTracingPipeline(
+        const RayTracingPipelineDescription                   &description,
+        const std::vector<std::shared_future<VkShaderModule>> &shaderModules
+) {
+	const std::vector<VkPipelineShaderStageCreateInfo> shaderStages{GetShaderStages(description.stages, shaderModules)};
+
+	VkRayTracingPipelineCreateInfoKHR pipelineCreateInfo{};
+	pipelineCreateInfo.sType                        = VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_CREATE_INFO_KHR;
+	pipelineCreateInfo.stageCount                   = shaderStages.size();
+	pipelineCreateInfo.pStages                      = shaderStages.data();
+	pipelineCreateInfo.groupCount                   = description.groups.size();
+	pipelineCreateInfo.pGroups                      = description.groups.data();
+	pipelineCreateInfo.maxPipelineRayRecursionDepth = description.maxRecursionDepth;
+	pipelineCreateInfo.layout                       = description.layout;
+	pipelineCreateInfo.basePipelineHandle           = VK_NULL_HANDLE;
+	pipelineCreateInfo.basePipelineIndex            = -1;
+
+	return m_pPipelineCache->CreateRayTracingPipeline(*m_pRayTracingFunctions, pipelineCreateInfo, description.name);
+}
+
+std::vector<std::shared_future<VkShaderModule>> PipelineBuilder::RequestShaderModules(
+        const std::vector<ShaderStageDescription> &stages
+) {
+	std::vector<std::shared_future<VkShaderModule>> shaderModules{};
+	shaderModules.reserve(stages.size());
+
+	for (const auto &stage: stages) { shaderModules.emplace_back(RequestShaderModule(stage.shaderName)); }
+
+	return shaderModules;
+}
+
+std::vector<VkPipelineShaderStageCreateInfo> PipelineBuilder::GetShaderStages(
+        const std::vector<ShaderStageDescription>             &stages,
+        const std::vector<std::shared_future<VkShaderModule>> &shaderModules
+) {
+	std::vector<VkPipelineShaderStageCreateInfo> shaderStages(stages.size());
+
+	for (size_t i{0}; i < shaderStages.size(); ++i) {
+		shaderStages[i].sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shaderStages[i].stage  = stages[i].stage;
+		shaderStages[i].module = shaderModules[i].get();
+		shaderStages[i].pName  = "main";
+	}
+
+	return shaderStages;
+}
@@ -0,0 +1,119 @@
+#ifndef PORTAL2RAYTRACED_PIPELINEBUILDER_H
+#define PORTAL2RAYTRACED_PIPELINEBUILDER_H
+
+#include "PipelineCache.h"
+#include "RayTracingFunctions.h"
+#include "ShaderLibrary.h"
+#include "ThreadPool.h"
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+struct ShaderStageDescription {
+	VkShaderStageFlagBits stage{};
+	std::string           shaderName{};
+};
+
+// Owns every array a VkGraphicsPipelineCreateInfo points into, so the create info can be assembled on a worker.
+struct GraphicsPipelineDescription {
+	std::string                                      name{};
+	std::vector<ShaderStageDescription>              stages{};
+	std::vector<VkVertexInputBindingDescription>     vertexBindings{};
+	std::vector<VkVertexInputAttributeDescription>   vertexAttributes{};
+	std::vector<VkDynamicState>                      dynamicStates{};
+	VkPipelineInputAssemblyStateCreateInfo           inputAssembly{};
+	VkPipelineRasterizationStateCreateInfo           rasterization{};
+	VkPipelineMultisampleStateCreateInfo             multisample{};
+	// Left zeroed for render passes without a depth attachment
+	VkPipelineDepthStencilStateCreateInfo            depthStencil{};
+	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments{};
+	VkPipelineColorBlendStateCreateInfo              colorBlend{};
+	VkPipelineLayout                                 layout{};
+	VkRenderPass                                     renderPass{};
+	uint32_t                                         subpass{};
+};
+
+// Groups reference stages by index, the same way VkRayTracingPipelineCreateInfoKHR does.
+struct RayTracingPipelineDescription {
+	std::string                                       name{};
+	std::vector<ShaderStageDescription>               stages{};
+	std::vector<VkRayTracingShaderGroupCreateInfoKHR> groups{};
+	uint32_t                                          maxRecursionDepth{1};
+	VkPipelineLayout                                  layout{};
+};
+
+// Spreads shader module and pipeline creation over the thread pool. All builds share one VkPipelineCache, which is
+// internally synchronised, so workers never contend on anything but the driver itself.
+class PipelineBuilder final {
+public:
+	PipelineBuilder() = default;
+
+	PipelineBuilder(const PipelineBuilder &) = delete;
+
+	PipelineBuilder &operator=(const PipelineBuilder &) = delete;
+
+	void Init(
+	        VkDevice device, ThreadPool &threadPool, PipelineCache &pipelineCache, ShaderLibrary &shaderLibrary,
+	        const RayTracingFunctions &rayTracingFunctions
+	);
+
+	// Destroys the shader modules, only call once no more pipelines are being built from them.
+	void Cleanup();
+
+	// Modules are created once per name, later requests share the same future.
+	[[nodiscard]]
+	std::shared_future<VkShaderModule> RequestShaderModule(std::string_view name);
+
+	[[nodiscard]]
+	std::shared_future<VkPipeline> BuildGraphicsPipeline(GraphicsPipelineDescription description);
+
+	[[nodiscard]]
+	std::shared_future<VkPipeline> BuildRayTracingPipeline(RayTracingPipelineDescription description);
+
+	// Blocks until every requested module and pipeline exists, rethrowing the first failure.
+	void WaitAll();
+
+private:
+	[[nodiscard]]
+	VkShaderModule CreateShaderModule(std::string_view name);
+
+	[[nodiscard]]
+	VkPipeline CreateGraphicsPipeline(
+	        const GraphicsPipelineDescription                     &description,
+	        const std::vector<std::shared_future<VkShaderModule>> &shaderModules
+	);
+
+	[[nodiscard]]
+	VkPipeline CreateRayTracingPipeline(
+	        const RayTracingPipelineDescription                   &description,
+	        const std::vector<std::shared_future<VkShaderModule>> &shaderModules
+	);
+
+	[[nodiscard]]
+	std::vector<std::shared_future<VkShaderModule>> RequestShaderModules(
+	        const std::vector<ShaderStageDescription> &stages
+	);
+
+	[[nodiscard]]
+	static std::vector<VkPipelineShaderStageCreateInfo> GetShaderStages(
+	        const std::vector<ShaderStageDescription>             &stages,
+	        const std::vector<std::shared_future<VkShaderModule>> &shaderModules
+	);
+
+	VkDevice                   m_Device{};
+	ThreadPool                *m_pThreadPool{};
+	PipelineCache             *m_pPipelineCache{};
+	ShaderLibrary             *m_pShaderLibrary{};
+	const RayTracingFunctions *m_pRayTracingFunctions{};
+
+	std::map<std::string, std::shared_future<VkShaderModule>, std::less<>> m_ShaderModules{};
+	std::vector<std::shared_future<VkPipeline>>                            m_Pipelines{};
+	std::mutex                                                             m_Mutex{};
+};
+
+
+#endif//PORTAL2RAYTRACED_PIPELINEBUILDER_H
@@ -0,0 +1,221 @@
+#include "PipelineCache.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <vulkan/vk_enum_string_helper.h>
+
+std::ostream &operator<<(std::ostream &ostream, const PipelineCacheStatistics &statistics) {
+	const uint32_t missCount{statistics.pipelineCount - statistics.cacheHits - statistics.unknownCount};
+
+	ostream << "Pipeline cache: " << statistics.loadResult << ", " << statistics.cacheHits << '/'
+	        << statistics.pipelineCount << " pipelines hit (" << statistics.hitMilliseconds << " ms), " << missCount
+	        << " missed (" << statistics.missMilliseconds << " ms), ";
+
+	if (statistics.unknownCount > 0)
+		ostream << statistics.unknownCount << " unknown (" << statistics.unknownMilliseconds << " ms"
+		        << (statistics.creationFeedback ? "" : ", no creation feedback") << "), ";
+
+	return ostream << statistics.savedBytes << " bytes saved";
+}
+
+void PipelineCache::Init(
+        VkPhysicalDevice physicalDevice, VkDevice device, std::filesystem::path path, bool creationFeedback
+) {
+	m_Device                      = device;
+	m_Path                        = std::move(path);
+	m_CreationFeedback            = creationFeedback;
+	m_Statistics.creationFeedback = creationFeedback;
+	vkGetPhysicalDeviceProperties(physicalDevice, &m_DeviceProperties);
+
+	std::vector<char> initialData{};
+
+	if (std::ifstream file{m_Path, std::ios::ate | std::ios::binary}; file.is_open()) {
+		initialData.resize(static_cast<size_t>(file.tellg()));
+
+		file.seekg(0);
+		file.read(initialData.data(), static_cast<std::streamsize>(initialData.size()));
+
+		if (std::string rejectReason{ValidateHeader(initialData)}; !rejectReason.empty()) {
+			m_Statistics.loadResult = "rejected " + m_Path.string() + " (" + rejectReason + ")";
+			initialData.clear();
+		} else {
+			m_Statistics.loadedBytes = initialData.size();
+			m_Statistics.loadResult  = "loaded " + std::to_string(initialData.size()) + " bytes from " + m_Path.string();
+		}
+	} else {
+		m_Statistics.loadResult = "no cache at " + m_Path.string();
+	}
+
+	VkPipelineCacheCreateInfo createInfo{};
+	createInfo.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	createInfo.initialDataSize = initialData.size();
+	createInfo.pInitialData    = initialData.data();
+
+	if (const VkResult result{vkCreatePipelineCache(m_Device, &createInfo, nullptr, &m_Cache)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to create pipeline cache: "} + string_VkResult(result)};
+	}
+
+	std::cout << "Pipeline cache: " << m_Statistics.loadResult << '\n';
+}
+
+void PipelineCache::Cleanup() {
+	Save();
+
+	std::cout << m_Statistics << '\n';
+
+	vkDestroyPipelineCache(m_Device, m_Cache, nullptr);
+}
+
+template<typename CreateInfo, typename CreateFunction>
+VkPipeline PipelineCache::CreateWithFeedback(
+        const CreateInfo &createInfo, std::string_view name, std::string_view kind, CreateFunction create
+) {
+	VkPipelineCreationFeedback feedback{};
+
+	VkPipelineCreationFeedbackCreateInfo feedbackInfo{};
+	feedbackInfo.sType                     = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+	feedbackInfo.pNext                     = createInfo.pNext;
+	feedbackInfo.pPipelineCreationFeedback = &feedback;
+
+	CreateInfo feedbackCreateInfo{createInfo};
+	if (m_CreationFeedback)
+		feedbackCreateInfo.pNext = &feedbackInfo;
+
+	VkPipeline pipeline{};
+
+	const auto start{std::chrono::steady_clock::now()};
+
+	if (const VkResult result{create(feedbackCreateInfo, pipeline)}; result != VK_SUCCESS) {
+		throw std::runtime_error{
+		        "Failed to create " + std::string{kind} + " pipeline " + std::string{name} + ": " +
+		        string_VkResult(result)
+		};
+	}
+
+	const std::chrono::duration<double, std::milli> elapsed{std::chrono::steady_clock::now() - start};
+	RecordCreation(name, feedback, elapsed.count());
+
+	return pipeline;
+}
+
+VkPipeline PipelineCache::CreateGraphicsPipeline(const VkGraphicsPipelineCreateInfo &createInfo, std::string_view name) {
+	return CreateWithFeedback(
+	        createInfo, name, "graphics",
+	        [this](const VkGraphicsPipelineCreateInfo &info, VkPipeline &pipeline) {
+		        return vkCreateGraphicsPipelines(m_Device, m_Cache, 1, &info, nullptr, &pipeline);
+	        }
+	);
+}
+
+VkPipeline PipelineCache::CreateRayTracingPipeline(
+        const RayTracingFunctions &functions, const VkRayTracingPipelineCreateInfoKHR &createInfo,
+        std::string_view name
+) {
+	return CreateWithFeedback(
+	        createInfo, name, "ray tracing",
+	        [this, &functions](const VkRayTracingPipelineCreateInfoKHR &info, VkPipeline &pipeline) {
+		        return functions.vkCreateRayTracingPipelinesKHR(
+		                m_Device, VK_NULL_HANDLE, m_Cache, 1, &info, nullptr, &pipeline
+		        );
+	        }
+	);
+}
+
+std::string PipelineCache::ValidateHeader(const std::vector<char> &data) const {
+	VkPipelineCacheHeaderVersionOne header{};
+
+	if (data.size() < sizeof(header))
+		return "truncated header";
+
+	memcpy(&header, data.data(), sizeof(header));
+
+	if (header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE || header.headerSize < sizeof(header))
+		return "unknown header version";
+
+	if (header.vendorID != m_DeviceProperties.vendorID)
+		return "vendor mismatch";
+
+	if (header.deviceID != m_DeviceProperties.deviceID)
+		return "device mismatch";
+
+	if (memcmp(header.pipelineCacheUUID, m_DeviceProperties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+		return "pipelineCacheUUID mismatch, driver changed";
+
+	return {};
+}
+
+void PipelineCache::Save() {
+	size_t dataSize{};
+	if (const VkResult result{vkGetPipelineCacheData(m_Device, m_Cache, &dataSize, nullptr)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to query pipeline cache size: "} + string_VkResult(result)};
+	}
+
+	std::vector<char> data(dataSize);
+	if (const VkResult result{vkGetPipelineCacheData(m_Device, m_Cache, &dataSize, data.data())};
+	    result != VK_SUCCESS) {
+		std::cerr << "Failed to read back pipeline cache: " << string_VkResult(result) << '\n';
+		return;
+	}
+
+	// Write next to the old cache and swap it in, so a crash mid-write never leaves a torn file behind
+	std::filesystem::path temporaryPath{m_Path};
+	temporaryPath += ".tmp";
+
+	{
+		std::ofstream file{temporaryPath, std::ios::binary | std::ios::trunc};
+		if (!file.is_open()) {
+			std::cerr << "Failed to open " << temporaryPath << " for writing\n";
+			return;
+		}
+
+		file.write(data.data(), static_cast<std::streamsize>(dataSize));
+
+		// A short write must not replace a good cache with a truncated one
+		if (!file.flush()) {
+			file.close();
+			std::error_code errorCode{};
+			std::filesystem::remove(temporaryPath, errorCode);
+
+			std::cerr << "Failed to write " << temporaryPath << ", keeping the previous pipeline cache\n";
+			return;
+		}
+	}
+
+	std::error_code errorCode{};
+	std::filesystem::rename(temporaryPath, m_Path, errorCode);
+
+	if (errorCode) {
+		std::cerr << "Failed to replace pipeline cache " << m_Path << ": " << errorCode.message() << '\n';
+		return;
+	}
+
+	m_Statistics.savedBytes = dataSize;
+}
+
+void PipelineCache::RecordCreation(
+        std::string_view name, const VkPipelineCreationFeedback &feedback, double milliseconds
+) {
+	const bool feedbackValid{(feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT) != 0};
+	const bool cacheHit{
+	        feedbackValid && (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT) != 0
+	};
+
+	std::lock_guard lock{m_StatisticsMutex};
+
+	++m_Statistics.pipelineCount;
+
+	if (!feedbackValid) {
+		++m_Statistics.unknownCount;
+		m_Statistics.unknownMilliseconds += milliseconds;
+	} else if (cacheHit) {
+		++m_Statistics.cacheHits;
+		m_Statistics.hitMilliseconds += milliseconds;
+	} else {
+		m_Statistics.missMilliseconds += milliseconds;
+	}
+
+	std::cout << "Pipeline " << name << " created in " << milliseconds << " ms ("
+	          << (feedbackValid ? (cacheHit ? "cache hit" : "cache miss") : "cache hit unknown") << ")\n";
+}
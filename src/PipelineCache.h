@@ -0,0 +1,92 @@
+#ifndef PORTAL2RAYTRACED_PIPELINECACHE_H
+#define PORTAL2RAYTRACED_PIPELINECACHE_H
+
+#include "RayTracingFunctions.h"
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+struct PipelineCacheStatistics {
+	size_t      loadedBytes{};
+	size_t      savedBytes{};
+	std::string loadResult{};
+	// Without creation feedback cache hits are unknown, every pipeline is counted in unknownCount
+	bool        creationFeedback{};
+	uint32_t    pipelineCount{};
+	uint32_t    cacheHits{};
+	uint32_t    unknownCount{};
+	double      hitMilliseconds{};
+	double      missMilliseconds{};
+	double      unknownMilliseconds{};
+};
+
+std::ostream &operator<<(std::ostream &ostream, const PipelineCacheStatistics &statistics);
+
+// VkPipelineCache that is seeded from and written back to disk. Stale blobs (other driver, other GPU) are rejected
+// by comparing the cache header against the physical device instead of being handed to the driver.
+// Pipelines may be created from several threads at once.
+class PipelineCache final {
+public:
+	PipelineCache() = default;
+
+	PipelineCache(const PipelineCache &) = delete;
+
+	PipelineCache &operator=(const PipelineCache &) = delete;
+
+	// creationFeedback says whether the device has pipeline creation feedback, core in Vulkan 1.3 and
+	// VK_EXT_pipeline_creation_feedback before. Without it no feedback is chained and cache hits are unknown.
+	void Init(VkPhysicalDevice physicalDevice, VkDevice device, std::filesystem::path path, bool creationFeedback);
+
+	// Writes the cache back to disk and destroys it.
+	void Cleanup();
+
+	[[nodiscard]]
+	VkPipeline CreateGraphicsPipeline(const VkGraphicsPipelineCreateInfo &createInfo, std::string_view name);
+
+	[[nodiscard]]
+	VkPipeline CreateRayTracingPipeline(
+	        const RayTracingFunctions &functions, const VkRayTracingPipelineCreateInfoKHR &createInfo,
+	        std::string_view name
+	);
+
+	[[nodiscard]]
+	VkPipelineCache Get() const noexcept {
+		return m_Cache;
+	}
+
+	[[nodiscard]]
+	const PipelineCacheStatistics &GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+
+private:
+	[[nodiscard]]
+	std::string ValidateHeader(const std::vector<char> &data) const;
+
+	void Save();
+
+	// Chains creation feedback into createInfo where available, times create and records whether the cache was hit.
+	template<typename CreateInfo, typename CreateFunction>
+	[[nodiscard]]
+	VkPipeline CreateWithFeedback(
+	        const CreateInfo &createInfo, std::string_view name, std::string_view kind, CreateFunction create
+	);
+
+	void RecordCreation(std::string_view name, const VkPipelineCreationFeedback &feedback, double milliseconds);
+
+	VkDevice                   m_Device{};
+	VkPhysicalDeviceProperties m_DeviceProperties{};
+	std::filesystem::path      m_Path{};
+	bool                       m_CreationFeedback{};
+	VkPipelineCache            m_Cache{};
+	PipelineCacheStatistics    m_Statistics{};
+	std::mutex                 m_StatisticsMutex{};
+};
+
+
+#endif//PORTAL2RAYTRACED_PIPELINECACHE_H
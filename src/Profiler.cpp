@@ -0,0 +1,216 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <vulkan/vk_enum_string_helper.h>
+
+namespace {
+	// Nearest-rank percentile of an already sorted range.
+	double Percentile(const std::vector<double> &sortedSamples, double percentile) {
+		const auto rank{static_cast<size_t>(std::ceil(percentile / 100.0 * static_cast<double>(sortedSamples.size())))};
+
+		return sortedSamples[std::clamp<size_t>(rank, 1, sortedSamples.size()) - 1];
+	}
+}// namespace
+
+std::ostream &operator<<(std::ostream &ostream, const TimingStatistics &statistics) {
+	return ostream << statistics.name << ": mean " << statistics.meanMilliseconds << " ms, p50 "
+	               << statistics.p50Milliseconds << " ms, p95 " << statistics.p95Milliseconds << " ms, p99 "
+	               << statistics.p99Milliseconds << " ms, max " << statistics.maxMilliseconds << " ms ("
+	               << statistics.sampleCount << " samples)";
+}
+
+Profiler::CpuScope::CpuScope(Profiler &profiler, std::string_view name)
+    : m_Profiler{profiler}
+    , m_Name{name}
+    , m_Start{Clock::now()} {
+}
+
+Profiler::CpuScope::~CpuScope() {
+	const std::chrono::duration<double, std::milli> elapsed{Clock::now() - m_Start};
+	m_Profiler.AddSample(m_Name, elapsed.count());
+}
+
+void Profiler::Init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamilyIndex, uint32_t frameCount) {
+	m_Device = device;
+	m_FrameQueries.resize(frameCount);
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+	uint32_t queueFamilyCount{0};
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+	const uint32_t validBits{queueFamilies.at(queueFamilyIndex).timestampValidBits};
+	if (validBits == 0)
+		return;
+
+	m_TimestampPeriod = properties.limits.timestampPeriod;
+	m_TimestampMask   = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+	VkQueryPoolCreateInfo queryPoolInfo{};
+	queryPoolInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+	queryPoolInfo.queryCount = GetFirstQuery(frameCount);
+
+	if (const VkResult result{vkCreateQueryPool(m_Device, &queryPoolInfo, nullptr, &m_QueryPool)};
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to create timestamp query pool: "} + string_VkResult(result)};
+	}
+}
+
+void Profiler::Cleanup() {
+	vkDestroyQueryPool(m_Device, m_QueryPool, nullptr);
+	m_QueryPool = VK_NULL_HANDLE;
+}
+
+void Profiler::BeginFrame(uint32_t frameIndex) {
+	const Clock::time_point now{Clock::now()};
+	if (m_LastFrameStart != Clock::time_point{}) {
+		const std::chrono::duration<double, std::milli> frameTime{now - m_LastFrameStart};
+		AddSample("cpu/frame", frameTime.count());
+	}
+
+	m_LastFrameStart = now;
+	m_CurrentFrame   = frameIndex;
+
+	CollectGpuTimings(frameIndex);
+}
+
+void Profiler::ResetQueries(VkCommandBuffer commandBuffer) {
+	if (m_QueryPool == VK_NULL_HANDLE)
+		return;
+
+	vkCmdResetQueryPool(commandBuffer, m_QueryPool, GetFirstQuery(m_CurrentFrame), MAX_GPU_SCOPES_PER_FRAME * 2);
+	m_FrameQueries[m_CurrentFrame].recorded = true;
+}
+
+uint32_t Profiler::BeginGpuScope(VkCommandBuffer commandBuffer, std::string_view name) {
+	FrameQueries &frameQueries{m_FrameQueries[m_CurrentFrame]};
+
+	if (m_QueryPool == VK_NULL_HANDLE || frameQueries.scopeNames.size() == MAX_GPU_SCOPES_PER_FRAME)
+		return MAX_GPU_SCOPES_PER_FRAME;
+
+	const auto scope{static_cast<uint32_t>(frameQueries.scopeNames.size())};
+	frameQueries.scopeNames.emplace_back("gpu/").append(name);
+
+	vkCmdWriteTimestamp(
+	        commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_QueryPool, GetFirstQuery(m_CurrentFrame) + scope * 2
+	);
+
+	return scope;
+}
+
+void Profiler::EndGpuScope(VkCommandBuffer commandBuffer, uint32_t scope) {
+	if (scope >= MAX_GPU_SCOPES_PER_FRAME)
+		return;
+
+	vkCmdWriteTimestamp(
+	        commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_QueryPool,
+	        GetFirstQuery(m_CurrentFrame) + scope * 2 + 1
+	);
+}
+
+void Profiler::AddSample(std::string_view name, double milliseconds) {
+	auto it{m_Histories.find(name)};
+	if (it == m_Histories.end())
+		it = m_Histories.emplace(std::string{name}, History{}).first;
+
+	History &history{it->second};
+	history.samples[history.next] = milliseconds;
+	history.next                  = (history.next + 1) % HISTORY_SIZE;
+	history.count                 = std::min(history.count + 1, HISTORY_SIZE);
+}
+
+std::vector<TimingStatistics> Profiler::GetStatistics() const {
+	std::vector<TimingStatistics> statistics{};
+	statistics.reserve(m_Histories.size());
+
+	std::vector<double> sortedSamples{};
+	for (const auto &[name, history]: m_Histories) {
+		if (history.count == 0)
+			continue;
+
+		sortedSamples.assign(history.samples.cbegin(), history.samples.cbegin() + history.count);
+		std::sort(sortedSamples.begin(), sortedSamples.end());
+
+		TimingStatistics &timing{statistics.emplace_back()};
+		timing.name             = name;
+		timing.sampleCount      = sortedSamples.size();
+		timing.meanMilliseconds = std::accumulate(sortedSamples.cbegin(), sortedSamples.cend(), 0.0) /
+		                          static_cast<double>(sortedSamples.size());
+		timing.p50Milliseconds  = Percentile(sortedSamples, 50.0);
+		timing.p95Milliseconds  = Percentile(sortedSamples, 95.0);
+		timing.p99Milliseconds  = Percentile(sortedSamples, 99.0);
+		timing.maxMilliseconds  = sortedSamples.back();
+	}
+
+	return statistics;
+}
+
+void Profiler::Dump(const std::filesystem::path &path) const {
+	std::ofstream file{path, std::ios::trunc};
+	if (!file.is_open()) {
+		throw std::runtime_error{"Failed to open profile output " + path.string()};
+	}
+
+	if (path.extension() == ".json") {
+		WriteJson(file);
+	} else {
+		WriteCsv(file);
+	}
+}
+
+void Profiler::CollectGpuTimings(uint32_t frameIndex) {
+	FrameQueries &frameQueries{m_FrameQueries[frameIndex]};
+
+	if (m_QueryPool != VK_NULL_HANDLE && frameQueries.recorded && !frameQueries.scopeNames.empty()) {
+		const auto queryCount{static_cast<uint32_t>(frameQueries.scopeNames.size() * 2)};
+
+		std::array<uint64_t, MAX_GPU_SCOPES_PER_FRAME * 2> timestamps{};
+		// The fence was waited on, so VK_NOT_READY only happens if a scope was opened and never closed
+		if (const VkResult result{vkGetQueryPoolResults(
+		            m_Device, m_QueryPool, GetFirstQuery(frameIndex), queryCount, queryCount * sizeof(uint64_t),
+		            timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT
+		    )};
+		    result == VK_SUCCESS) {
+			for (size_t i{0}; i < frameQueries.scopeNames.size(); ++i) {
+				const uint64_t ticks{(timestamps[i * 2 + 1] - timestamps[i * 2]) & m_TimestampMask};
+				AddSample(frameQueries.scopeNames[i], static_cast<double>(ticks) * m_TimestampPeriod / 1'000'000.0);
+			}
+		}
+	}
+
+	frameQueries.scopeNames.clear();
+	frameQueries.recorded = false;
+}
+
+void Profiler::WriteCsv(std::ostream &ostream) const {
+	ostream << "name,samples,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+
+	for (const TimingStatistics &timing: GetStatistics()) {
+		ostream << timing.name << ',' << timing.sampleCount << ',' << timing.meanMilliseconds << ','
+		        << timing.p50Milliseconds << ',' << timing.p95Milliseconds << ',' << timing.p99Milliseconds << ','
+		        << timing.maxMilliseconds << '\n';
+	}
+}
+
+void Profiler::WriteJson(std::ostream &ostream) const {
+	const std::vector<TimingStatistics> statistics{GetStatistics()};
+
+	ostream << "{\n  \"timers\": [";
+	for (size_t i{0}; i < statistics.size(); ++i) {
+		const TimingStatistics &timing{statistics[i]};
+
+		ostream << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << timing.name
+		        << "\", \"samples\": " << timing.sampleCount << ", \"mean_ms\": " << timing.meanMilliseconds
+		        << ", \"p50_ms\": " << timing.p50Milliseconds << ", \"p95_ms\": " << timing.p95Milliseconds
+		        << ", \"p99_ms\": " << timing.p99Milliseconds << ", \"max_ms\": " << timing.maxMilliseconds << '}';
+	}
+	ostream << "\n  ]\n}\n";
+}
@@ -0,0 +1,122 @@
+#ifndef PORTAL2RAYTRACED_PROFILER_H
+#define PORTAL2RAYTRACED_PROFILER_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+struct TimingStatistics {
+	std::string name{};
+	size_t      sampleCount{};
+	double      meanMilliseconds{};
+	double      p50Milliseconds{};
+	double      p95Milliseconds{};
+	double      p99Milliseconds{};
+	double      maxMilliseconds{};
+};
+
+std::ostream &operator<<(std::ostream &ostream, const TimingStatistics &statistics);
+
+// Per-frame CPU and GPU timings with rolling percentiles over the last HISTORY_SIZE samples of every timer.
+// GPU scopes are timestamp query pairs, read back once the frame slot's fence has been waited on so collecting them
+// never stalls. Timers are keyed by name, CPU timers are prefixed with "cpu/" and GPU scopes with "gpu/".
+class Profiler final {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	class CpuScope final {
+	public:
+		CpuScope(Profiler &profiler, std::string_view name);
+
+		CpuScope(const CpuScope &) = delete;
+
+		CpuScope &operator=(const CpuScope &) = delete;
+
+		~CpuScope();
+
+	private:
+		Profiler         &m_Profiler;
+		std::string_view  m_Name;
+		Clock::time_point m_Start;
+	};
+
+	Profiler() = default;
+
+	Profiler(const Profiler &) = delete;
+
+	Profiler &operator=(const Profiler &) = delete;
+
+	// GPU scopes are silently disabled when the queue family cannot write timestamps.
+	void Init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamilyIndex, uint32_t frameCount);
+
+	void Cleanup();
+
+	// Collects the GPU timings last recorded into this frame slot. Its fence must already have been waited on.
+	void BeginFrame(uint32_t frameIndex);
+
+	// Has to be recorded outside of a render pass, before the frame's first GPU scope.
+	void ResetQueries(VkCommandBuffer commandBuffer);
+
+	[[nodiscard]]
+	uint32_t BeginGpuScope(VkCommandBuffer commandBuffer, std::string_view name);
+
+	void EndGpuScope(VkCommandBuffer commandBuffer, uint32_t scope);
+
+	[[nodiscard]]
+	CpuScope ScopeCpu(std::string_view name) {
+		return CpuScope{*this, name};
+	}
+
+	void AddSample(std::string_view name, double milliseconds);
+
+	[[nodiscard]]
+	std::vector<TimingStatistics> GetStatistics() const;
+
+	// Writes JSON when the path ends in .json, CSV otherwise.
+	void Dump(const std::filesystem::path &path) const;
+
+private:
+	static constexpr size_t   HISTORY_SIZE{1024};
+	static constexpr uint32_t MAX_GPU_SCOPES_PER_FRAME{16};
+
+	struct History {
+		std::array<double, HISTORY_SIZE> samples{};
+		size_t                           count{};
+		size_t                           next{};
+	};
+
+	struct FrameQueries {
+		std::vector<std::string> scopeNames{};
+		bool                     recorded{false};
+	};
+
+	[[nodiscard]]
+	uint32_t GetFirstQuery(uint32_t frameIndex) const noexcept {
+		return frameIndex * MAX_GPU_SCOPES_PER_FRAME * 2;
+	}
+
+	void CollectGpuTimings(uint32_t frameIndex);
+
+	void WriteCsv(std::ostream &ostream) const;
+
+	void WriteJson(std::ostream &ostream) const;
+
+	VkDevice                                    m_Device{};
+	VkQueryPool                                 m_QueryPool{};
+	double                                      m_TimestampPeriod{};
+	uint64_t                                    m_TimestampMask{};
+	std::vector<FrameQueries>                   m_FrameQueries{};
+	uint32_t                                    m_CurrentFrame{};
+	Clock::time_point                           m_LastFrameStart{};
+	std::map<std::string, History, std::less<>> m_Histories{};
+};
+
+
+#endif//PORTAL2RAYTRACED_PROFILER_H
@@ -0,0 +1,50 @@
+#include "ProgressiveAccumulation.h"
+#include <algorithm>
+
+std::ostream &operator<<(std::ostream &ostream, const AccumulationStatistics &statistics) {
+	ostream << "Accumulation: " << statistics.samplesPerPixel << " samples per pixel, " << statistics.resetCount
+	        << " resets, ";
+
+	if (!statistics.timeToTargetMilliseconds.has_value())
+		return ostream << statistics.targetSamplesPerPixel << " spp not reached";
+
+	return ostream << statistics.targetSamplesPerPixel << " spp after " << *statistics.timeToTargetMilliseconds
+	               << " ms";
+}
+
+void ProgressiveAccumulation::Configure(bool enabled, uint32_t targetSamplesPerPixel) noexcept {
+	m_Enabled                          = enabled;
+	m_Statistics.targetSamplesPerPixel = std::max(targetSamplesPerPixel, 1u);
+
+	Invalidate();
+}
+
+void ProgressiveAccumulation::Invalidate() noexcept {
+	if (m_Statistics.samplesPerPixel > 0)
+		++m_Statistics.resetCount;
+
+	m_Statistics.samplesPerPixel = 0;
+	m_Statistics.timeToTargetMilliseconds.reset();
+}
+
+uint32_t ProgressiveAccumulation::BeginSample() noexcept {
+	// Rendering from scratch every frame is the same as a sum that never grows past one sample
+	if (!m_Enabled) {
+		m_Statistics.samplesPerPixel = 0;
+		m_Statistics.timeToTargetMilliseconds.reset();
+	}
+
+	if (m_Statistics.samplesPerPixel == 0)
+		m_ResetTime = Clock::now();
+
+	return m_Statistics.samplesPerPixel;
+}
+
+void ProgressiveAccumulation::EndSample() noexcept {
+	++m_Statistics.samplesPerPixel;
+
+	if (m_Statistics.samplesPerPixel == m_Statistics.targetSamplesPerPixel) {
+		const std::chrono::duration<double, std::milli> convergenceTime{Clock::now() - m_ResetTime};
+		m_Statistics.timeToTargetMilliseconds = convergenceTime.count();
+	}
+}
@@ -0,0 +1,58 @@
+#ifndef PORTAL2RAYTRACED_PROGRESSIVEACCUMULATION_H
+#define PORTAL2RAYTRACED_PROGRESSIVEACCUMULATION_H
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+
+struct AccumulationStatistics {
+	uint32_t samplesPerPixel{};
+	uint32_t targetSamplesPerPixel{};
+	// Invalidations that threw away at least one sample
+	uint32_t resetCount{};
+	// From the last reset until targetSamplesPerPixel samples were taken, empty while still converging
+	std::optional<double> timeToTargetMilliseconds{};
+};
+
+std::ostream &operator<<(std::ostream &ostream, const AccumulationStatistics &statistics);
+
+// Bookkeeping for an image that averages one new sample per pixel every frame for as long as nothing it depends on
+// changes. Renderers ask for the index of the sample to take, 0 meaning the accumulated sum has to be overwritten
+// instead of added to. Anything that changes the picture, be it the scene, the camera or the resolution, calls
+// Invalidate. With progressive mode off every sample is sample 0, so each frame renders from scratch.
+class ProgressiveAccumulation final {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	void Configure(bool enabled, uint32_t targetSamplesPerPixel) noexcept;
+
+	void Invalidate() noexcept;
+
+	// Index of the sample the current frame takes
+	[[nodiscard]]
+	uint32_t BeginSample() noexcept;
+
+	// The sample from BeginSample is in the accumulated sum
+	void EndSample() noexcept;
+
+	[[nodiscard]]
+	bool IsEnabled() const noexcept {
+		return m_Enabled;
+	}
+
+	[[nodiscard]]
+	const AccumulationStatistics &GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+
+	static constexpr uint32_t DEFAULT_TARGET_SAMPLES_PER_PIXEL{64};
+
+private:
+	bool                   m_Enabled{false};
+	Clock::time_point      m_ResetTime{};
+	AccumulationStatistics m_Statistics{0, DEFAULT_TARGET_SAMPLES_PER_PIXEL};
+};
+
+
+#endif//PORTAL2RAYTRACED_PROGRESSIVEACCUMULATION_H
@@ -0,0 +1,28 @@
+#include "RayTracingFunctions.h"
+#include <stdexcept>
+#include <string>
+
+namespace {
+	template<typename Function>
+	void LoadFunction(VkDevice device, const char *pName, Function &function) {
+		function = reinterpret_cast<Function>(vkGetDeviceProcAddr(device, pName));
+
+		if (function == nullptr)
+			throw std::runtime_error{std::string{"Failed to load device function "} + pName};
+	}
+}// namespace
+
+void RayTracingFunctions::Load(VkDevice device) {
+	LoadFunction(device, "vkCreateAccelerationStructureKHR", vkCreateAccelerationStructureKHR);
+	LoadFunction(device, "vkDestroyAccelerationStructureKHR", vkDestroyAccelerationStructureKHR);
+	LoadFunction(device, "vkGetAccelerationStructureBuildSizesKHR", vkGetAccelerationStructureBuildSizesKHR);
+	LoadFunction(device, "vkGetAccelerationStructureDeviceAddressKHR", vkGetAccelerationStructureDeviceAddressKHR);
+	LoadFunction(device, "vkCmdBuildAccelerationStructuresKHR", vkCmdBuildAccelerationStructuresKHR);
+	LoadFunction(device, "vkCmdCopyAccelerationStructureKHR", vkCmdCopyAccelerationStructureKHR);
+	LoadFunction(
+	        device, "vkCmdWriteAccelerationStructuresPropertiesKHR", vkCmdWriteAccelerationStructuresPropertiesKHR
+	);
+	LoadFunction(device, "vkCreateRayTracingPipelinesKHR", vkCreateRayTracingPipelinesKHR);
+	LoadFunction(device, "vkGetRayTracingShaderGroupHandlesKHR", vkGetRayTracingShaderGroupHandlesKHR);
+	LoadFunction(device, "vkCmdTraceRaysKHR", vkCmdTraceRaysKHR);
+}
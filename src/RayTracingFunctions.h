@@ -0,0 +1,25 @@
+#ifndef PORTAL2RAYTRACED_RAYTRACINGFUNCTIONS_H
+#define PORTAL2RAYTRACED_RAYTRACINGFUNCTIONS_H
+
+#include <vulkan/vulkan.h>
+
+// Entry points of the ray tracing extensions. The loader does not export them, so they are fetched through
+// vkGetDeviceProcAddr once the device exists.
+struct RayTracingFunctions {
+	PFN_vkCreateAccelerationStructureKHR              vkCreateAccelerationStructureKHR{};
+	PFN_vkDestroyAccelerationStructureKHR             vkDestroyAccelerationStructureKHR{};
+	PFN_vkGetAccelerationStructureBuildSizesKHR       vkGetAccelerationStructureBuildSizesKHR{};
+	PFN_vkGetAccelerationStructureDeviceAddressKHR    vkGetAccelerationStructureDeviceAddressKHR{};
+	PFN_vkCmdBuildAccelerationStructuresKHR           vkCmdBuildAccelerationStructuresKHR{};
+	PFN_vkCmdCopyAccelerationStructureKHR             vkCmdCopyAccelerationStructureKHR{};
+	PFN_vkCmdWriteAccelerationStructuresPropertiesKHR vkCmdWriteAccelerationStructuresPropertiesKHR{};
+	PFN_vkCreateRayTracingPipelinesKHR                vkCreateRayTracingPipelinesKHR{};
+	PFN_vkGetRayTracingShaderGroupHandlesKHR          vkGetRayTracingShaderGroupHandlesKHR{};
+	PFN_vkCmdTraceRaysKHR                             vkCmdTraceRaysKHR{};
+
+	// Throws std::runtime_error when the device does not expose one of the functions.
+	void Load(VkDevice device);
+};
+
+
+#endif//PORTAL2RAYTRACED_RAYTRACINGFUNCTIONS_H
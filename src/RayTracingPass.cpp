@@ -0,0 +1,335 @@
+#include "RayTracingPass.h"
+#include "Alignment.h"
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <vulkan/vk_enum_string_helper.h>
+
+void RayTracingPass::Init(
+        VkPhysicalDevice physicalDevice, VkDevice device, MemoryAllocator &allocator,
+        const RayTracingFunctions &functions, PipelineBuilder &pipelineBuilder, BindlessTable &bindlessTable,
+        DeletionQueue &deletionQueue, VkExtent2D extent
+) {
+	m_Device         = device;
+	m_pAllocator     = &allocator;
+	m_pFunctions     = &functions;
+	m_pBindlessTable = &bindlessTable;
+	m_pDeletionQueue = &deletionQueue;
+	m_Extent         = extent;
+
+	m_PipelineProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_PROPERTIES_KHR;
+
+	VkPhysicalDeviceProperties2 properties{};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &m_PipelineProperties;
+	vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+	CreatePipelineLayout();
+	CreateStorageImages();
+
+	RayTracingPipelineDescription description{};
+	description.name = "ray_tracing";
+	description.stages.emplace_back(VK_SHADER_STAGE_RAYGEN_BIT_KHR, "raytrace.rgen.spv");
+	description.stages.emplace_back(VK_SHADER_STAGE_MISS_BIT_KHR, "raytrace.rmiss.spv");
+	description.stages.emplace_back(VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, "raytrace.rchit.spv");
+	description.layout = m_PipelineLayout;
+
+	// Group order matches the shader binding table layout: ray gen, miss, hit
+	VkRayTracingShaderGroupCreateInfoKHR group{};
+	group.sType              = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
+	group.type               = VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR;
+	group.generalShader      = 0;
+	group.closestHitShader   = VK_SHADER_UNUSED_KHR;
+	group.anyHitShader       = VK_SHADER_UNUSED_KHR;
+	group.intersectionShader = VK_SHADER_UNUSED_KHR;
+	description.groups.emplace_back(group);
+
+	group.generalShader = 1;
+	description.groups.emplace_back(group);
+
+	group.type             = VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR;
+	group.generalShader    = VK_SHADER_UNUSED_KHR;
+	group.closestHitShader = 2;
+	description.groups.emplace_back(group);
+
+	m_PipelineFuture = pipelineBuilder.BuildRayTracingPipeline(std::move(description));
+}
+
+void RayTracingPass::Cleanup() {
+	m_pAllocator->DestroyBuffer(m_ShaderBindingTable, m_ShaderBindingTableAllocation);
+	DestroyStorageImages();
+
+	vkDestroyPipeline(m_Device, m_Pipeline, nullptr);
+	vkDestroyPipelineLayout(m_Device, m_PipelineLayout, nullptr);
+}
+
+void RayTracingPass::FinishPipeline() {
+	m_Pipeline = m_PipelineFuture.get();
+
+	CreateShaderBindingTable();
+}
+
+void RayTracingPass::UpdateDescriptors(
+        const AccelerationStructure &tlas, VkBuffer vertexBuffer, VkBuffer indexBuffer, VkIndexType indexType
+) {
+	m_PushConstants.wideIndices  = indexType == VK_INDEX_TYPE_UINT32 ? 1 : 0;
+	m_PushConstants.topLevelAS   = m_pBindlessTable->AddAccelerationStructure(tlas.handle);
+	m_PushConstants.vertexBuffer = m_pBindlessTable->AddStorageBuffer(vertexBuffer);
+	m_PushConstants.indexBuffer  = m_pBindlessTable->AddStorageBuffer(indexBuffer);
+}
+
+void RayTracingPass::Resize(VkExtent2D extent, uint64_t retireValue) {
+	m_pBindlessTable->Remove(BindlessResource::StorageImage, m_PushConstants.outputImage, retireValue);
+	m_pBindlessTable->Remove(BindlessResource::StorageImage, m_PushConstants.accumulationImage, retireValue);
+
+	m_pDeletionQueue->DestroyImageView(retireValue, m_AccumulationImageView);
+	m_pDeletionQueue->DestroyImage(retireValue, m_AccumulationImage, m_AccumulationImageAllocation);
+	m_pDeletionQueue->DestroyImageView(retireValue, m_StorageImageView);
+	m_pDeletionQueue->DestroyImage(retireValue, m_StorageImage, m_StorageImageAllocation);
+
+	m_Extent = extent;
+	CreateStorageImages();
+
+	m_Accumulation.Invalidate();
+}
+
+void RayTracingPass::ConfigureAccumulation(bool progressive, uint32_t targetSamplesPerPixel) noexcept {
+	m_Accumulation.Configure(progressive, targetSamplesPerPixel);
+}
+
+void RayTracingPass::ResetAccumulation() noexcept {
+	m_Accumulation.Invalidate();
+}
+
+void RayTracingPass::Record(VkCommandBuffer commandBuffer, VkImage targetImage, VkImageLayout finalLayout) {
+	VkImageSubresourceRange subresourceRange{};
+	subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	subresourceRange.levelCount = 1;
+	subresourceRange.layerCount = 1;
+
+	PushConstants pushConstants{m_PushConstants};
+	pushConstants.sampleIndex = m_Accumulation.BeginSample();
+
+	// The previous frame's blit may still be reading the storage image
+	VkImageMemoryBarrier storageWriteBarrier{};
+	storageWriteBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	storageWriteBarrier.srcAccessMask       = VK_ACCESS_TRANSFER_READ_BIT;
+	storageWriteBarrier.dstAccessMask       = VK_ACCESS_SHADER_WRITE_BIT;
+	storageWriteBarrier.oldLayout           = m_StorageImageLayout;
+	storageWriteBarrier.newLayout           = VK_IMAGE_LAYOUT_GENERAL;
+	storageWriteBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	storageWriteBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	storageWriteBarrier.image               = m_StorageImage;
+	storageWriteBarrier.subresourceRange    = subresourceRange;
+
+	// And the previous frame's trace may still be adding to the accumulation image. The first sample overwrites it,
+	// so its contents can be discarded then.
+	const bool firstSample{pushConstants.sampleIndex == 0};
+
+	VkImageMemoryBarrier accumulationBarrier{storageWriteBarrier};
+	accumulationBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	accumulationBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	accumulationBarrier.oldLayout     = firstSample ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_GENERAL;
+	accumulationBarrier.image         = m_AccumulationImage;
+
+	const std::array<VkImageMemoryBarrier, 2> traceBarriers{storageWriteBarrier, accumulationBarrier};
+	vkCmdPipelineBarrier(
+	        commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+	        VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, 0, 0, nullptr, 0, nullptr,
+	        static_cast<uint32_t>(traceBarriers.size()), traceBarriers.data()
+	);
+	m_StorageImageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, m_Pipeline);
+	m_pBindlessTable->Bind(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, m_PipelineLayout);
+	vkCmdPushConstants(
+	        commandBuffer, m_PipelineLayout, PUSH_CONSTANT_STAGES, 0, sizeof(pushConstants), &pushConstants
+	);
+
+	m_pFunctions->vkCmdTraceRaysKHR(
+	        commandBuffer, &m_Regions.rayGen, &m_Regions.miss, &m_Regions.hit, &m_Regions.callable, m_Extent.width,
+	        m_Extent.height, 1
+	);
+
+	// The target is waited on at the transfer stage, so its transition chains onto the acquire semaphore
+	std::array<VkImageMemoryBarrier, 2> blitBarriers{};
+	blitBarriers[0]               = storageWriteBarrier;
+	blitBarriers[0].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	blitBarriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	blitBarriers[0].oldLayout     = VK_IMAGE_LAYOUT_GENERAL;
+
+	blitBarriers[1]               = storageWriteBarrier;
+	blitBarriers[1].srcAccessMask = 0;
+	blitBarriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	blitBarriers[1].oldLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+	blitBarriers[1].newLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	blitBarriers[1].image         = targetImage;
+	vkCmdPipelineBarrier(
+	        commandBuffer, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_TRANSFER_BIT,
+	        VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(blitBarriers.size()),
+	        blitBarriers.data()
+	);
+
+	VkImageBlit blit{};
+	blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	blit.srcSubresource.layerCount = 1;
+	blit.srcOffsets[1]             = {static_cast<int32_t>(m_Extent.width), static_cast<int32_t>(m_Extent.height), 1};
+	blit.dstSubresource            = blit.srcSubresource;
+	blit.dstOffsets[1]             = blit.srcOffsets[1];
+	vkCmdBlitImage(
+	        commandBuffer, m_StorageImage, VK_IMAGE_LAYOUT_GENERAL, targetImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+	        1, &blit, VK_FILTER_NEAREST
+	);
+
+	// Presentation needs no access mask, a readback copy does
+	const bool readBack{finalLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL};
+
+	VkImageMemoryBarrier finalBarrier{blitBarriers[1]};
+	finalBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	finalBarrier.dstAccessMask = readBack ? VK_ACCESS_TRANSFER_READ_BIT : 0;
+	finalBarrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	finalBarrier.newLayout     = finalLayout;
+	vkCmdPipelineBarrier(
+	        commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+	        readBack ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr,
+	        1, &finalBarrier
+	);
+
+	m_Accumulation.EndSample();
+}
+
+void RayTracingPass::CreatePipelineLayout() {
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = PUSH_CONSTANT_STAGES;
+	pushConstantRange.offset     = 0;
+	pushConstantRange.size       = sizeof(PushConstants);
+
+	const VkDescriptorSetLayout bindlessLayout{m_pBindlessTable->GetLayout()};
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+	pipelineLayoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount         = 1;
+	pipelineLayoutInfo.pSetLayouts            = &bindlessLayout;
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	pipelineLayoutInfo.pPushConstantRanges    = &pushConstantRange;
+
+	if (const VkResult result{vkCreatePipelineLayout(m_Device, &pipelineLayoutInfo, nullptr, &m_PipelineLayout)};
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{
+		        std::string{"Failed to create ray tracing pipeline layout: "} + string_VkResult(result)
+		};
+	}
+}
+
+void RayTracingPass::CreateStorageImages() {
+	CreateStorageImage(
+	        STORAGE_FORMAT, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, m_StorageImage,
+	        m_StorageImageAllocation, m_StorageImageView
+	);
+	m_StorageImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	CreateStorageImage(
+	        ACCUMULATION_FORMAT, VK_IMAGE_USAGE_STORAGE_BIT, m_AccumulationImage, m_AccumulationImageAllocation,
+	        m_AccumulationImageView
+	);
+
+	m_PushConstants.outputImage       = m_pBindlessTable->AddStorageImage(m_StorageImageView);
+	m_PushConstants.accumulationImage = m_pBindlessTable->AddStorageImage(m_AccumulationImageView);
+}
+
+void RayTracingPass::DestroyStorageImages() {
+	vkDestroyImageView(m_Device, m_AccumulationImageView, nullptr);
+	m_pAllocator->DestroyImage(m_AccumulationImage, m_AccumulationImageAllocation);
+
+	vkDestroyImageView(m_Device, m_StorageImageView, nullptr);
+	m_pAllocator->DestroyImage(m_StorageImage, m_StorageImageAllocation);
+}
+
+void RayTracingPass::CreateStorageImage(
+        VkFormat format, VkImageUsageFlags usage, VkImage &image, Allocation &allocation, VkImageView &imageView
+) {
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType     = VK_IMAGE_TYPE_2D;
+	imageInfo.format        = format;
+	imageInfo.extent        = {m_Extent.width, m_Extent.height, 1};
+	imageInfo.mipLevels     = 1;
+	imageInfo.arrayLayers   = 1;
+	imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage         = usage;
+	imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	m_pAllocator->CreateImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, allocation);
+
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType                       = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image                       = image;
+	viewInfo.viewType                    = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format                      = format;
+	viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.layerCount = 1;
+
+	if (const VkResult result{vkCreateImageView(m_Device, &viewInfo, nullptr, &imageView)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to create storage image view: "} + string_VkResult(result)};
+	}
+}
+
+void RayTracingPass::CreateShaderBindingTable() {
+	const uint32_t     handleSize{m_PipelineProperties.shaderGroupHandleSize};
+	const VkDeviceSize baseAlignment{m_PipelineProperties.shaderGroupBaseAlignment};
+	const VkDeviceSize handleStride{AlignUp(handleSize, m_PipelineProperties.shaderGroupHandleAlignment)};
+	const uint32_t     groupCount{RAY_GEN_GROUP_COUNT + MISS_GROUP_COUNT + HIT_GROUP_COUNT};
+
+	std::vector<std::byte> handles(static_cast<size_t>(groupCount) * handleSize);
+	if (const VkResult result{m_pFunctions->vkGetRayTracingShaderGroupHandlesKHR(
+	            m_Device, m_Pipeline, 0, groupCount, handles.size(), handles.data()
+	    )};
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to get shader group handles: "} + string_VkResult(result)};
+	}
+
+	// Every region starts on a base alignment boundary, the ray gen region has to be exactly one record big
+	m_Regions.rayGen.stride = AlignUp(handleStride, baseAlignment);
+	m_Regions.rayGen.size   = m_Regions.rayGen.stride;
+	m_Regions.miss.stride   = handleStride;
+	m_Regions.miss.size     = AlignUp(MISS_GROUP_COUNT * handleStride, baseAlignment);
+	m_Regions.hit.stride    = handleStride;
+	m_Regions.hit.size      = AlignUp(HIT_GROUP_COUNT * handleStride, baseAlignment);
+
+	// Over-allocated by one base alignment so the start address can be rounded up
+	m_pAllocator->CreateBuffer(
+	        m_Regions.rayGen.size + m_Regions.miss.size + m_Regions.hit.size + baseAlignment,
+	        VK_BUFFER_USAGE_SHADER_BINDING_TABLE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+	        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_ShaderBindingTable,
+	        m_ShaderBindingTableAllocation
+	);
+
+	const VkDeviceAddress bufferAddress{m_pAllocator->GetDeviceAddress(m_ShaderBindingTable)};
+	const VkDeviceAddress tableAddress{AlignUp(bufferAddress, baseAlignment)};
+
+	m_Regions.rayGen.deviceAddress = tableAddress;
+	m_Regions.miss.deviceAddress   = m_Regions.rayGen.deviceAddress + m_Regions.rayGen.size;
+	m_Regions.hit.deviceAddress    = m_Regions.miss.deviceAddress + m_Regions.miss.size;
+
+	std::byte *const pTable{
+	        static_cast<std::byte *>(m_ShaderBindingTableAllocation.pMapped) + (tableAddress - bufferAddress)
+	};
+	for (uint32_t group{0}; group < groupCount; ++group) {
+		VkDeviceSize recordOffset{};
+		if (group < RAY_GEN_GROUP_COUNT) {
+			recordOffset = group * m_Regions.rayGen.stride;
+		} else if (group < RAY_GEN_GROUP_COUNT + MISS_GROUP_COUNT) {
+			recordOffset = m_Regions.rayGen.size + (group - RAY_GEN_GROUP_COUNT) * handleStride;
+		} else {
+			recordOffset = m_Regions.rayGen.size + m_Regions.miss.size +
+			               (group - RAY_GEN_GROUP_COUNT - MISS_GROUP_COUNT) * handleStride;
+		}
+
+		memcpy(pTable + recordOffset, handles.data() + static_cast<size_t>(group) * handleSize, handleSize);
+	}
+}
@@ -0,0 +1,135 @@
+#ifndef PORTAL2RAYTRACED_RAYTRACINGPASS_H
+#define PORTAL2RAYTRACED_RAYTRACINGPASS_H
+
+#include "AccelerationStructure.h"
+#include "BindlessTable.h"
+#include "DeletionQueue.h"
+#include "MemoryAllocator.h"
+#include "PipelineBuilder.h"
+#include "ProgressiveAccumulation.h"
+#include "RayTracingFunctions.h"
+#include <cstdint>
+#include <future>
+#include <vulkan/vulkan.h>
+
+// Traces the scene into a storage image and blits the result onto the frame's target image. The pipeline is built
+// through the PipelineBuilder like the raster one, the shader binding table is only created once it exists. Every
+// resource is reached through the BindlessTable, the handles go to the shaders as push constants.
+// In progressive mode every frame adds one sample per pixel to a 32-bit float accumulation image and the blit shows
+// the average, so a static view keeps converging instead of staying at one sample per pixel.
+class RayTracingPass final {
+public:
+	RayTracingPass() = default;
+
+	RayTracingPass(const RayTracingPass &) = delete;
+
+	RayTracingPass &operator=(const RayTracingPass &) = delete;
+
+	// Creates the pipeline layout and the storage images, and queues the pipeline build. The bindless table needs
+	// acceleration structures.
+	void Init(
+	        VkPhysicalDevice physicalDevice, VkDevice device, MemoryAllocator &allocator,
+	        const RayTracingFunctions &functions, PipelineBuilder &pipelineBuilder, BindlessTable &bindlessTable,
+	        DeletionQueue &deletionQueue, VkExtent2D extent
+	);
+
+	void Cleanup();
+
+	// Collects the pipeline queued in Init and fills the shader binding table from its group handles.
+	void FinishPipeline();
+
+	// Adds the TLAS and the geometry to the bindless table, only called once. indexType is SceneStreams::GetIndexType
+	// of the geometry in indexBuffer
+	void UpdateDescriptors(
+	        const AccelerationStructure &tlas, VkBuffer vertexBuffer, VkBuffer indexBuffer, VkIndexType indexType
+	);
+
+	// Creates storage images for a new target size while frames up to retireValue may still trace into the old ones,
+	// those and their handles go to the deletion queue. The TLAS and geometry handles are kept.
+	void Resize(VkExtent2D extent, uint64_t retireValue);
+
+	// Off after Init. Changing it starts the accumulation over.
+	void ConfigureAccumulation(bool progressive, uint32_t targetSamplesPerPixel) noexcept;
+
+	// Has to be called whenever the traced picture changes, e.g. after a TLAS update. Resize resets by itself.
+	void ResetAccumulation() noexcept;
+
+	[[nodiscard]]
+	const AccumulationStatistics &GetAccumulationStatistics() const noexcept {
+		return m_Accumulation.GetStatistics();
+	}
+
+	// Traces and blits into targetImage, which is expected in VK_IMAGE_LAYOUT_UNDEFINED and left in finalLayout.
+	// The first access to targetImage happens in VK_PIPELINE_STAGE_TRANSFER_BIT. A sample counts as taken once
+	// recorded, so the time to the target sample count runs ahead of the GPU by the frames in flight.
+	void Record(VkCommandBuffer commandBuffer, VkImage targetImage, VkImageLayout finalLayout);
+
+private:
+	// Matches the push constant blocks in raytrace.rgen and raytrace.rchit
+	struct PushConstants {
+		uint32_t       sampleIndex{};
+		uint32_t       wideIndices{};
+		BindlessHandle topLevelAS{};
+		BindlessHandle outputImage{};
+		BindlessHandle accumulationImage{};
+		BindlessHandle vertexBuffer{};
+		BindlessHandle indexBuffer{};
+	};
+
+	struct ShaderBindingTableRegions {
+		VkStridedDeviceAddressRegionKHR rayGen{};
+		VkStridedDeviceAddressRegionKHR miss{};
+		VkStridedDeviceAddressRegionKHR hit{};
+		VkStridedDeviceAddressRegionKHR callable{};
+	};
+
+	void CreatePipelineLayout();
+
+	void CreateStorageImages();
+
+	void DestroyStorageImages();
+
+	void CreateStorageImage(
+	        VkFormat format, VkImageUsageFlags usage, VkImage &image, Allocation &allocation, VkImageView &imageView
+	);
+
+	void CreateShaderBindingTable();
+
+	// Linear half floats, the blit converts to whatever the target format is (sRGB for the swap chain)
+	static constexpr VkFormat STORAGE_FORMAT{VK_FORMAT_R16G16B16A16_SFLOAT};
+	static constexpr VkFormat ACCUMULATION_FORMAT{VK_FORMAT_R32G32B32A32_SFLOAT};
+	static constexpr uint32_t RAY_GEN_GROUP_COUNT{1};
+	static constexpr uint32_t MISS_GROUP_COUNT{1};
+	static constexpr uint32_t HIT_GROUP_COUNT{1};
+	// The hit shader needs to know the index width and where the geometry is
+	static constexpr VkShaderStageFlags PUSH_CONSTANT_STAGES{
+	        VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR
+	};
+
+	VkDevice                                        m_Device{};
+	MemoryAllocator                                *m_pAllocator{};
+	const RayTracingFunctions                      *m_pFunctions{};
+	BindlessTable                                  *m_pBindlessTable{};
+	DeletionQueue                                  *m_pDeletionQueue{};
+	VkPhysicalDeviceRayTracingPipelinePropertiesKHR m_PipelineProperties{};
+	VkExtent2D                                      m_Extent{};
+	VkPipelineLayout                                m_PipelineLayout{};
+	std::shared_future<VkPipeline>                  m_PipelineFuture{};
+	VkPipeline                                      m_Pipeline{};
+	VkImage                                         m_StorageImage{};
+	Allocation                                      m_StorageImageAllocation{};
+	VkImageView                                     m_StorageImageView{};
+	VkImageLayout                                   m_StorageImageLayout{VK_IMAGE_LAYOUT_UNDEFINED};
+	VkImage                                         m_AccumulationImage{};
+	Allocation                                      m_AccumulationImageAllocation{};
+	VkImageView                                     m_AccumulationImageView{};
+	ProgressiveAccumulation                         m_Accumulation{};
+	// Everything but the sample index, which Record fills in
+	PushConstants                                   m_PushConstants{};
+	VkBuffer                                        m_ShaderBindingTable{};
+	Allocation                                      m_ShaderBindingTableAllocation{};
+	ShaderBindingTableRegions                       m_Regions{};
+};
+
+
+#endif//PORTAL2RAYTRACED_RAYTRACINGPASS_H
@@ -0,0 +1,109 @@
+#include "Scene.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+	constexpr uint32_t INSTANCED_SCENE_INSTANCE_COUNT{10'000};
+	constexpr uint32_t MESH_SCENE_RESOLUTION{255};
+}// namespace
+
+Scene Scene::Create(std::string_view name) {
+	if (name == "quad")
+		return CreateQuad();
+
+	if (name == "instances")
+		return CreateInstancedQuads(INSTANCED_SCENE_INSTANCE_COUNT);
+
+	if (name == "mesh")
+		return CreateGridMesh(MESH_SCENE_RESOLUTION);
+
+	throw std::invalid_argument{"Unknown scene: " + std::string{name}};
+}
+
+Scene Scene::CreateQuad() {
+	Scene scene{};
+	scene.name     = "quad";
+	scene.vertices = {
+	        Vertex{{-0.5f, -0.5f, 0.0f}, {1.0f, 0.0f, 0.0f}}, Vertex{{0.5f, -0.5f, 0.0f}, {0.0f, 1.0f, 0.0f}},
+	        Vertex{{0.5f, 0.5f, 0.0f}, {0.0f, 0.0f, 1.0f}}, Vertex{{-0.5f, 0.5f, 0.0f}, {1.0f, 1.0f, 1.0f}}
+	};
+	scene.indices = {0, 1, 2, 2, 3, 0};
+
+	return scene;
+}
+
+Scene Scene::CreateInstancedQuads(uint32_t instanceCount) {
+	Scene scene{CreateQuad()};
+	scene.name          = "instances";
+	scene.instanceCount = instanceCount;
+
+	return scene;
+}
+
+Scene Scene::CreateGridMesh(uint32_t resolution) {
+	// (resolution + 1)^2 vertices have to be addressable with uint16_t indices
+	resolution = std::clamp(resolution, 1u, 255u);
+
+	const uint32_t verticesPerRow{resolution + 1};
+	const float    cellSize{1.8f / static_cast<float>(resolution)};
+
+	Scene scene{};
+	scene.name = "mesh";
+	scene.vertices.reserve(static_cast<size_t>(verticesPerRow) * verticesPerRow);
+	scene.indices.reserve(static_cast<size_t>(resolution) * resolution * 6);
+
+	for (uint32_t y{0}; y < verticesPerRow; ++y) {
+		for (uint32_t x{0}; x < verticesPerRow; ++x) {
+			const float u{static_cast<float>(x) / static_cast<float>(resolution)};
+			const float v{static_cast<float>(y) / static_cast<float>(resolution)};
+
+			scene.vertices.push_back(Vertex{
+			        {-0.9f + static_cast<float>(x) * cellSize, -0.9f + static_cast<float>(y) * cellSize, 0.f},
+			        {u, v, 1.f - u * v}
+			});
+		}
+	}
+
+	// Same winding as the quad so back face culling keeps working
+	for (uint32_t y{0}; y < resolution; ++y) {
+		for (uint32_t x{0}; x < resolution; ++x) {
+			const auto topLeft{static_cast<uint16_t>(y * verticesPerRow + x)};
+			const auto topRight{static_cast<uint16_t>(topLeft + 1)};
+			const auto bottomLeft{static_cast<uint16_t>(topLeft + verticesPerRow)};
+			const auto bottomRight{static_cast<uint16_t>(bottomLeft + 1)};
+
+			scene.indices.insert(
+			        scene.indices.end(), {topLeft, topRight, bottomRight, bottomRight, bottomLeft, topLeft}
+			);
+		}
+	}
+
+	return scene;
+}
+
+uint32_t Scene::GetGridSize() const noexcept {
+	return static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(instanceCount))));
+}
+
+VkTransformMatrixKHR Scene::GetInstanceTransform(uint32_t instance, float time) const noexcept {
+	const uint32_t gridSize{GetGridSize()};
+	const float    cellSize{2.f / static_cast<float>(gridSize)};
+	const float    scale{cellSize * .5f};
+
+	const float centerX{-1.f + cellSize * (static_cast<float>(instance % gridSize) + .5f)};
+	const float phase{ANIMATION_PHASE_STEP * static_cast<float>(instance)};
+	const float offset{
+	        ANIMATION_AMPLITUDE * cellSize * (std::sin(ANIMATION_ANGULAR_SPEED * time + phase) - std::sin(phase))
+	};
+	const float centerY{-1.f + cellSize * (static_cast<float>(instance / gridSize) + .5f) + offset};
+
+	VkTransformMatrixKHR transform{};
+	transform.matrix[0][0] = scale;
+	transform.matrix[0][3] = centerX;
+	transform.matrix[1][1] = scale;
+	transform.matrix[1][3] = centerY;
+	transform.matrix[2][2] = 1.f;
+
+	return transform;
+}
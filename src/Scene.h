@@ -0,0 +1,146 @@
+#ifndef PORTAL2RAYTRACED_SCENE_H
+#define PORTAL2RAYTRACED_SCENE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm\glm.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Positions are 3D so loaded meshes keep their depth, z in [-1, 1] decides occlusion in every renderer
+struct Vertex {
+	glm::vec3 pos{};
+	glm::vec3 color{};
+
+	constexpr static VkVertexInputBindingDescription GetBindingDescription();
+
+	constexpr static std::array<VkVertexInputAttributeDescription, 2> GetAttributeDescriptions();
+};
+
+constexpr VkVertexInputBindingDescription Vertex::GetBindingDescription() {
+	VkVertexInputBindingDescription bindingDescription{};
+	bindingDescription.binding   = 0;
+	bindingDescription.stride    = sizeof(Vertex);
+	bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+	return bindingDescription;
+}
+
+constexpr std::array<VkVertexInputAttributeDescription, 2> Vertex::GetAttributeDescriptions() {
+	std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
+	attributeDescriptions[0].binding  = 0;
+	attributeDescriptions[0].location = 0;
+	attributeDescriptions[0].format   = VK_FORMAT_R32G32B32_SFLOAT;
+	attributeDescriptions[0].offset   = offsetof(Vertex, pos);
+
+	attributeDescriptions[1].binding  = 0;
+	attributeDescriptions[1].location = 1;
+	attributeDescriptions[1].format   = VK_FORMAT_R32G32B32_SFLOAT;
+	attributeDescriptions[1].offset   = offsetof(Vertex, color);
+
+	return attributeDescriptions;
+}
+
+// Matches the push constant block in shader.vert, instances are laid out on a gridSize x gridSize grid. time is the
+// animation time of Scene::GetInstanceTransform.
+struct InstanceGridPushConstants {
+	uint32_t gridSize{1};
+	float    time{};
+};
+
+// Vertex and index streams of a scene without owning them. They view either a Scene's vectors or the mapping of a
+// cooked scene, so both upload and trace from the same place.
+struct SceneStreams {
+	std::span<const Vertex> vertices{};
+	// At most one of them is non-empty, as in Scene
+	std::span<const uint16_t> indices{};
+	std::span<const uint32_t> wideIndices{};
+
+	[[nodiscard]]
+	bool HasWideIndices() const noexcept {
+		return !wideIndices.empty();
+	}
+
+	[[nodiscard]]
+	size_t GetIndexCount() const noexcept {
+		return HasWideIndices() ? wideIndices.size() : indices.size();
+	}
+
+	[[nodiscard]]
+	uint32_t GetIndex(size_t i) const noexcept {
+		return HasWideIndices() ? wideIndices[i] : indices[i];
+	}
+
+	[[nodiscard]]
+	const void *GetIndexData() const noexcept {
+		return HasWideIndices() ? static_cast<const void *>(wideIndices.data()) : indices.data();
+	}
+
+	[[nodiscard]]
+	VkIndexType GetIndexType() const noexcept {
+		return HasWideIndices() ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16;
+	}
+
+	[[nodiscard]]
+	VkDeviceSize GetVertexBufferSize() const noexcept {
+		return vertices.size_bytes();
+	}
+
+	[[nodiscard]]
+	VkDeviceSize GetIndexBufferSize() const noexcept {
+		return HasWideIndices() ? wideIndices.size_bytes() : indices.size_bytes();
+	}
+};
+
+// Geometry for one of the built-in scenes or a mesh from MeshLoader. The built-in ones are generated, so runs are
+// reproducible on every machine.
+struct Scene {
+	std::string         name{};
+	std::vector<Vertex> vertices{};
+	// 16-bit as long as every vertex is addressable with them, larger meshes fill wideIndices and leave this empty
+	std::vector<uint16_t> indices{};
+	std::vector<uint32_t> wideIndices{};
+	uint32_t              instanceCount{1};
+
+	static constexpr std::array<std::string_view, 3> NAMES{"quad", "instances", "mesh"};
+	static constexpr size_t                          MAX_NARROW_VERTEX_COUNT{size_t{1} << 16};
+	// Instance animation, shader.vert repeats these. The amplitude is a fraction of the cell size
+	static constexpr float ANIMATION_AMPLITUDE{.25f};
+	static constexpr float ANIMATION_ANGULAR_SPEED{3.f};
+	static constexpr float ANIMATION_PHASE_STEP{.7f};
+
+	// Throws std::invalid_argument for names that are not in NAMES.
+	[[nodiscard]]
+	static Scene Create(std::string_view name);
+
+	[[nodiscard]]
+	static Scene CreateQuad();
+
+	[[nodiscard]]
+	static Scene CreateInstancedQuads(uint32_t instanceCount);
+
+	// A single indexed grid of resolution x resolution cells, resolution is capped so indices stay 16-bit.
+	[[nodiscard]]
+	static Scene CreateGridMesh(uint32_t resolution);
+
+	[[nodiscard]]
+	uint32_t GetGridSize() const noexcept;
+
+	// Same placement shader.vert applies to gl_InstanceIndex, as a row-major 3x4 matrix. A non-zero time in seconds
+	// bobs every instance up and down inside its cell, out of phase with its neighbours. At 0 it is the static layout.
+	[[nodiscard]]
+	VkTransformMatrixKHR GetInstanceTransform(uint32_t instance, float time = 0.f) const noexcept;
+
+	// Valid until the vectors are changed or the Scene is destroyed
+	[[nodiscard]]
+	SceneStreams GetStreams() const noexcept {
+		return {vertices, indices, wideIndices};
+	}
+};
+
+
+#endif//PORTAL2RAYTRACED_SCENE_H
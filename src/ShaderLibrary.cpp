@@ -0,0 +1,37 @@
+#include "ShaderLibrary.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+void ShaderLibrary::Init(std::optional<std::filesystem::path> overrideDirectory) {
+	m_OverrideDirectory = std::move(overrideDirectory);
+
+	if (m_OverrideDirectory.has_value()) {
+		std::cout << "Shader override directory: " << m_OverrideDirectory->string() << '\n';
+	}
+}
+
+std::span<const uint32_t> ShaderLibrary::GetCode(std::string_view name) {
+	if (m_OverrideDirectory.has_value()) {
+		std::lock_guard lock{m_Mutex};
+
+		if (const auto it{m_Overrides.find(name)}; it != m_Overrides.end())
+			return it->second.As<uint32_t>();
+
+		if (const std::filesystem::path path{*m_OverrideDirectory / name}; std::filesystem::exists(path)) {
+			const auto [it, inserted]{m_Overrides.emplace(std::string{name}, MappedFile{path})};
+			return it->second.As<uint32_t>();
+		}
+	}
+
+	const auto embeddedShaders{GetEmbeddedShaders()};
+	const auto shaderIterator{std::find_if(
+	        embeddedShaders.begin(), embeddedShaders.end(),
+	        [name](const EmbeddedShader &shader) { return shader.name == name; }
+	)};
+
+	if (shaderIterator == embeddedShaders.end())
+		throw std::runtime_error{"Unknown shader: " + std::string{name}};
+
+	return shaderIterator->code;
+}
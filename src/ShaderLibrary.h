@@ -0,0 +1,39 @@
+#ifndef PORTAL2RAYTRACED_SHADERLIBRARY_H
+#define PORTAL2RAYTRACED_SHADERLIBRARY_H
+
+#include "MappedFile.h"
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+struct EmbeddedShader {
+	std::string_view          name{};
+	std::span<const uint32_t> code{};
+};
+
+// Defined in the EmbeddedShaders.cpp that CMake generates from every shader in shaders/.
+[[nodiscard]]
+std::span<const EmbeddedShader> GetEmbeddedShaders() noexcept;
+
+// Hands out SPIR-V straight from the executable's read-only data. When an override directory is set, a .spv file
+// in there takes precedence and is memory-mapped, which allows iterating on shaders without rebuilding.
+class ShaderLibrary final {
+public:
+	void Init(std::optional<std::filesystem::path> overrideDirectory);
+
+	[[nodiscard]]
+	std::span<const uint32_t> GetCode(std::string_view name);
+
+private:
+	std::optional<std::filesystem::path>           m_OverrideDirectory{};
+	std::map<std::string, MappedFile, std::less<>> m_Overrides{};
+	std::mutex                                     m_Mutex{};
+};
+
+
+#endif//PORTAL2RAYTRACED_SHADERLIBRARY_H
@@ -0,0 +1,37 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threadCount) {
+	m_Workers.reserve(threadCount);
+
+	for (unsigned int i{0}; i < threadCount; ++i) { m_Workers.emplace_back(&ThreadPool::WorkerLoop, this); }
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard lock{m_Mutex};
+		m_Stopping = true;
+	}
+
+	m_JobAvailable.notify_all();
+
+	for (auto &worker: m_Workers) { worker.join(); }
+}
+
+void ThreadPool::WorkerLoop() {
+	while (true) {
+		std::function<void()> job{};
+
+		{
+			std::unique_lock lock{m_Mutex};
+			m_JobAvailable.wait(lock, [this] { return m_Stopping || !m_Jobs.empty(); });
+
+			if (m_Jobs.empty())
+				return;
+
+			job = std::move(m_Jobs.front());
+			m_Jobs.pop();
+		}
+
+		job();
+	}
+}
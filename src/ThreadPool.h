@@ -0,0 +1,61 @@
+#ifndef PORTAL2RAYTRACED_THREADPOOL_H
+#define PORTAL2RAYTRACED_THREADPOOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of workers draining a FIFO job queue. Jobs run in submission order, so a job may block on the future of
+// any job submitted before it without deadlocking the pool.
+class ThreadPool final {
+public:
+	explicit ThreadPool(unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency()));
+
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	template<typename Function>
+	[[nodiscard]]
+	std::future<std::invoke_result_t<Function>> Submit(Function &&function) {
+		using Result = std::invoke_result_t<Function>;
+
+		auto pTask{std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function))};
+		std::future<Result> future{pTask->get_future()};
+
+		{
+			std::lock_guard lock{m_Mutex};
+			m_Jobs.emplace([pTask] { (*pTask)(); });
+		}
+
+		m_JobAvailable.notify_one();
+
+		return future;
+	}
+
+	[[nodiscard]]
+	size_t GetThreadCount() const noexcept {
+		return m_Workers.size();
+	}
+
+private:
+	void WorkerLoop();
+
+	std::vector<std::thread>          m_Workers{};
+	std::queue<std::function<void()>> m_Jobs{};
+	std::mutex                        m_Mutex{};
+	std::condition_variable           m_JobAvailable{};
+	bool                              m_Stopping{false};
+};
+
+
+#endif//PORTAL2RAYTRACED_THREADPOOL_H
@@ -0,0 +1,214 @@
+#include "TileScheduler.h"
+#include <chrono>
+
+std::ostream &operator<<(std::ostream &ostream, const TileStatistics &statistics) {
+	return ostream << "Tiles: " << statistics.tileCount << " (" << statistics.stolenCount << " stolen, "
+	               << statistics.cancelledCount << " cancelled), mean " << statistics.meanMilliseconds << " ms, max "
+	               << statistics.maxMilliseconds << " ms, imbalance " << statistics.imbalance;
+}
+
+TileScheduler::TileScheduler(unsigned int threadCount) {
+	m_Queues.reserve(threadCount);
+	for (unsigned int i{0}; i < threadCount; ++i) { m_Queues.emplace_back(std::make_unique<WorkerQueue>()); }
+
+	m_Workers.reserve(threadCount);
+	for (uint32_t i{0}; i < threadCount; ++i) { m_Workers.emplace_back(&TileScheduler::WorkerLoop, this, i); }
+}
+
+TileScheduler::~TileScheduler() {
+	{
+		std::lock_guard lock{m_Mutex};
+		m_Stopping = true;
+	}
+
+	m_WorkAvailable.notify_all();
+
+	for (auto &worker: m_Workers) { worker.join(); }
+}
+
+bool TileScheduler::Run(uint32_t width, uint32_t height, uint32_t tileSize, const TileFunction &function) {
+	m_Cancelled = false;
+	CreateTiles(width, height, tileSize);
+
+	const auto tileCount{static_cast<uint32_t>(m_TileTimings.size())};
+	if (tileCount == 0) {
+		GatherStatistics();
+		return true;
+	}
+
+	m_pFunction      = &function;
+	m_RemainingTiles = tileCount;
+
+	// A worker still leaving the previous Run's loop can take a tile the moment it is pushed, so the counters are
+	// reset before the first one is
+	for (const std::unique_ptr<WorkerQueue> &pQueue: m_Queues) {
+		pQueue->busyMilliseconds.store(0.0, std::memory_order_relaxed);
+		pQueue->stolenCount.store(0, std::memory_order_relaxed);
+	}
+
+	// Every worker starts on its own contiguous stretch of the Morton curve
+	const auto queueCount{static_cast<uint32_t>(m_Queues.size())};
+	for (uint32_t thread{0}; thread < queueCount; ++thread) {
+		WorkerQueue &queue{*m_Queues[thread]};
+		std::lock_guard lock{queue.mutex};
+
+		const uint32_t first{static_cast<uint32_t>(static_cast<uint64_t>(tileCount) * thread / queueCount)};
+		const uint32_t last{static_cast<uint32_t>(static_cast<uint64_t>(tileCount) * (thread + 1) / queueCount)};
+		for (uint32_t tile{first}; tile < last; ++tile) { queue.tiles.push_back(tile); }
+	}
+
+	{
+		std::lock_guard lock{m_Mutex};
+		++m_Generation;
+	}
+
+	m_WorkAvailable.notify_all();
+
+	{
+		std::unique_lock lock{m_Mutex};
+		m_WorkDone.wait(lock, [this] { return m_RemainingTiles == 0; });
+	}
+
+	GatherStatistics();
+
+	return !m_Cancelled;
+}
+
+void TileScheduler::Cancel() noexcept {
+	m_Cancelled = true;
+}
+
+void TileScheduler::WorkerLoop(uint32_t thread) {
+	uint64_t seenGeneration{0};
+
+	while (true) {
+		{
+			std::unique_lock lock{m_Mutex};
+			m_WorkAvailable.wait(lock, [this, seenGeneration] {
+				return m_Stopping || m_Generation != seenGeneration;
+			});
+
+			if (m_Stopping)
+				return;
+
+			seenGeneration = m_Generation;
+		}
+
+		uint32_t tile{};
+		while (TakeTile(thread, tile)) { RunTile(thread, tile); }
+	}
+}
+
+bool TileScheduler::TakeTile(uint32_t thread, uint32_t &tile) {
+	{
+		WorkerQueue &queue{*m_Queues[thread]};
+		std::lock_guard lock{queue.mutex};
+
+		if (!queue.tiles.empty()) {
+			tile = queue.tiles.front();
+			queue.tiles.pop_front();
+			return true;
+		}
+	}
+
+	// Stealing from the back takes the tiles furthest away from where the victim is working
+	const auto queueCount{static_cast<uint32_t>(m_Queues.size())};
+	for (uint32_t offset{1}; offset < queueCount; ++offset) {
+		WorkerQueue &victim{*m_Queues[(thread + offset) % queueCount]};
+		std::lock_guard lock{victim.mutex};
+
+		if (victim.tiles.empty())
+			continue;
+
+		tile = victim.tiles.back();
+		victim.tiles.pop_back();
+		m_Queues[thread]->stolenCount.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	return false;
+}
+
+void TileScheduler::RunTile(uint32_t thread, uint32_t tile) {
+	TileTiming &timing{m_TileTimings[tile]};
+
+	if (!m_Cancelled) {
+		const auto tileStart{std::chrono::steady_clock::now()};
+		(*m_pFunction)(timing.tile, thread);
+
+		const std::chrono::duration<double, std::milli> tileTime{std::chrono::steady_clock::now() - tileStart};
+		timing.thread       = thread;
+		timing.milliseconds = tileTime.count();
+		timing.completed    = true;
+
+		m_Queues[thread]->busyMilliseconds.fetch_add(tileTime.count(), std::memory_order_relaxed);
+	}
+
+	if (m_RemainingTiles.fetch_sub(1) == 1) {
+		std::lock_guard lock{m_Mutex};
+		m_WorkDone.notify_one();
+	}
+}
+
+void TileScheduler::CreateTiles(uint32_t width, uint32_t height, uint32_t tileSize) {
+	m_TileTimings.clear();
+
+	for (uint32_t y{0}; y < height; y += tileSize) {
+		for (uint32_t x{0}; x < width; x += tileSize) {
+			TileTiming &timing{m_TileTimings.emplace_back()};
+			timing.tile = Tile{x, y, std::min(tileSize, width - x), std::min(tileSize, height - y)};
+		}
+	}
+
+	std::sort(
+	        m_TileTimings.begin(), m_TileTimings.end(),
+	        [tileSize](const TileTiming &a, const TileTiming &b) {
+		        return GetMortonCode(a.tile.x / tileSize, a.tile.y / tileSize) <
+		               GetMortonCode(b.tile.x / tileSize, b.tile.y / tileSize);
+	        }
+	);
+}
+
+void TileScheduler::GatherStatistics() {
+	m_Statistics           = {};
+	m_Statistics.tileCount = static_cast<uint32_t>(m_TileTimings.size());
+
+	uint32_t completedCount{0};
+	double   totalMilliseconds{0.0};
+	for (const TileTiming &timing: m_TileTimings) {
+		if (!timing.completed) {
+			++m_Statistics.cancelledCount;
+			continue;
+		}
+
+		++completedCount;
+		totalMilliseconds += timing.milliseconds;
+		m_Statistics.maxMilliseconds = std::max(m_Statistics.maxMilliseconds, timing.milliseconds);
+	}
+
+	double maxBusyMilliseconds{0.0};
+	for (const std::unique_ptr<WorkerQueue> &pQueue: m_Queues) {
+		m_Statistics.stolenCount += pQueue->stolenCount.load(std::memory_order_relaxed);
+		maxBusyMilliseconds = std::max(maxBusyMilliseconds, pQueue->busyMilliseconds.load(std::memory_order_relaxed));
+	}
+
+	const double meanBusyMilliseconds{totalMilliseconds / static_cast<double>(m_Queues.size())};
+
+	m_Statistics.meanMilliseconds = completedCount == 0 ? 0.0 : totalMilliseconds / completedCount;
+	m_Statistics.imbalance        = meanBusyMilliseconds > 0.0 ? maxBusyMilliseconds / meanBusyMilliseconds : 1.0;
+}
+
+uint32_t TileScheduler::GetMortonCode(uint32_t x, uint32_t y) noexcept {
+	// Spreads the lower 16 bits apart so x and y can be interleaved
+	const auto spreadBits{[](uint32_t value) {
+		value &= 0x0000FFFF;
+		value = (value | value << 8) & 0x00FF00FF;
+		value = (value | value << 4) & 0x0F0F0F0F;
+		value = (value | value << 2) & 0x33333333;
+		value = (value | value << 1) & 0x55555555;
+
+		return value;
+	}};
+
+	return spreadBits(x) | spreadBits(y) << 1;
+}
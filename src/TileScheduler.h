@@ -0,0 +1,122 @@
+#ifndef PORTAL2RAYTRACED_TILESCHEDULER_H
+#define PORTAL2RAYTRACED_TILESCHEDULER_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+struct Tile {
+	uint32_t x{};
+	uint32_t y{};
+	uint32_t width{};
+	uint32_t height{};
+};
+
+struct TileTiming {
+	Tile     tile{};
+	uint32_t thread{};
+	double   milliseconds{};
+	// Tiles skipped because of a Cancel never ran
+	bool completed{false};
+};
+
+struct TileStatistics {
+	uint32_t tileCount{};
+	uint32_t stolenCount{};
+	uint32_t cancelledCount{};
+	double   meanMilliseconds{};
+	double   maxMilliseconds{};
+	// Busiest thread's time over the mean per-thread time, 1 means the work was spread perfectly
+	double imbalance{};
+};
+
+std::ostream &operator<<(std::ostream &ostream, const TileStatistics &statistics);
+
+// Splits an image into square tiles and renders them on a fixed set of workers with one deque each. Tiles are
+// handed out in Morton order, each worker getting one contiguous run of it, so neighbouring tiles stay on the same
+// core. A worker pops from the front of its own deque and, once that is empty, steals from the back of the others.
+// Expensive regions therefore end up spread over every core instead of holding up the worker that got them.
+class TileScheduler final {
+public:
+	// Called concurrently from every worker, thread is the worker's index. Must not throw.
+	using TileFunction = std::function<void(const Tile &tile, uint32_t thread)>;
+
+	explicit TileScheduler(unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency()));
+
+	~TileScheduler();
+
+	TileScheduler(const TileScheduler &) = delete;
+
+	TileScheduler &operator=(const TileScheduler &) = delete;
+
+	// Blocks until every tile has run or been skipped, returns false when Cancel was called in between.
+	bool Run(uint32_t width, uint32_t height, uint32_t tileSize, const TileFunction &function);
+
+	// Callable from any thread. Tiles of the current Run that have not started yet are skipped, the ones already
+	// running still finish.
+	void Cancel() noexcept;
+
+	// One entry per tile of the last Run, in Morton order.
+	[[nodiscard]]
+	const std::vector<TileTiming> &GetTileTimings() const noexcept {
+		return m_TileTimings;
+	}
+
+	[[nodiscard]]
+	const TileStatistics &GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+
+	[[nodiscard]]
+	uint32_t GetThreadCount() const noexcept {
+		return static_cast<uint32_t>(m_Workers.size());
+	}
+
+private:
+	struct WorkerQueue {
+		std::mutex           mutex{};
+		std::deque<uint32_t> tiles{};
+		// Only added to by the owning worker, outside of mutex. Atomic because Run resets them while that worker may
+		// still be leaving the previous Run's loop.
+		std::atomic<double>   busyMilliseconds{};
+		std::atomic<uint32_t> stolenCount{};
+	};
+
+	void WorkerLoop(uint32_t thread);
+
+	// Own deque first, then the other workers' in order, returns false once every deque is empty
+	bool TakeTile(uint32_t thread, uint32_t &tile);
+
+	void RunTile(uint32_t thread, uint32_t tile);
+
+	void CreateTiles(uint32_t width, uint32_t height, uint32_t tileSize);
+
+	void GatherStatistics();
+
+	[[nodiscard]]
+	static uint32_t GetMortonCode(uint32_t x, uint32_t y) noexcept;
+
+	std::vector<std::thread>                  m_Workers{};
+	std::vector<std::unique_ptr<WorkerQueue>> m_Queues{};
+	std::vector<TileTiming>                   m_TileTimings{};
+	const TileFunction                       *m_pFunction{};
+	std::mutex                                m_Mutex{};
+	std::condition_variable                   m_WorkAvailable{};
+	std::condition_variable                   m_WorkDone{};
+	uint64_t                                  m_Generation{0};
+	bool                                      m_Stopping{false};
+	std::atomic<uint32_t>                     m_RemainingTiles{0};
+	std::atomic<bool>                         m_Cancelled{false};
+	TileStatistics                            m_Statistics{};
+};
+
+
+#endif//PORTAL2RAYTRACED_TILESCHEDULER_H
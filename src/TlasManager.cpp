@@ -0,0 +1,183 @@
+#include "TlasManager.h"
+#include "Alignment.h"
+#include <algorithm>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+std::ostream &operator<<(std::ostream &ostream, const TlasStatistics &statistics) {
+	return ostream << "TLAS: " << statistics.instanceCount << " instances, " << statistics.rebuildCount
+	               << " rebuilds, " << statistics.refitCount << " refits";
+}
+
+void TlasManager::Init(
+        VkPhysicalDevice physicalDevice, VkDevice device, MemoryAllocator &allocator,
+        const RayTracingFunctions &functions, uint32_t maxInstanceCount
+) {
+	m_Device           = device;
+	m_pAllocator       = &allocator;
+	m_pFunctions       = &functions;
+	m_MaxInstanceCount = maxInstanceCount;
+
+	m_Instances.reserve(maxInstanceCount);
+
+	// Sized for the maximum instance count up front, so adding instances never reallocates the TLAS
+	VkAccelerationStructureGeometryKHR geometry{};
+	geometry.sType                              = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+	geometry.geometryType                       = VK_GEOMETRY_TYPE_INSTANCES_KHR;
+	geometry.geometry.instances.sType           = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
+	geometry.geometry.instances.arrayOfPointers = VK_FALSE;
+
+	const VkAccelerationStructureBuildGeometryInfoKHR buildInfo{
+	        GetBuildInfo(geometry, VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR)
+	};
+
+	VkAccelerationStructureBuildSizesInfoKHR sizes{};
+	sizes.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
+	m_pFunctions->vkGetAccelerationStructureBuildSizesKHR(
+	        m_Device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &buildInfo, &m_MaxInstanceCount, &sizes
+	);
+
+	m_Tlas = CreateAccelerationStructure(
+	        m_Device, *m_pAllocator, *m_pFunctions, VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR,
+	        sizes.accelerationStructureSize
+	);
+
+	VkPhysicalDeviceAccelerationStructurePropertiesKHR accelerationStructureProperties{};
+	accelerationStructureProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR;
+
+	VkPhysicalDeviceProperties2 properties{};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &accelerationStructureProperties;
+	vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+	// Builds and refits run one after the other on the graphics queue, so they can share one scratch buffer
+	const VkDeviceSize scratchAlignment{accelerationStructureProperties.minAccelerationStructureScratchOffsetAlignment};
+	m_pAllocator->CreateBuffer(
+	        std::max(sizes.buildScratchSize, sizes.updateScratchSize) + scratchAlignment,
+	        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+	        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_ScratchBuffer, m_ScratchAllocation
+	);
+
+	m_ScratchAddress = AlignUp(m_pAllocator->GetDeviceAddress(m_ScratchBuffer), scratchAlignment);
+}
+
+void TlasManager::Cleanup() {
+	DestroyAccelerationStructure(m_Device, *m_pAllocator, *m_pFunctions, m_Tlas);
+	m_pAllocator->DestroyBuffer(m_ScratchBuffer, m_ScratchAllocation);
+
+	m_Instances.clear();
+}
+
+uint32_t TlasManager::AddInstance(
+        const AccelerationStructure &blas, const VkTransformMatrixKHR &transform, uint32_t customIndex, uint8_t mask
+) {
+	if (m_Instances.size() >= m_MaxInstanceCount)
+		throw std::runtime_error{"TLAS instance limit of " + std::to_string(m_MaxInstanceCount) + " reached"};
+
+	VkAccelerationStructureInstanceKHR instance{};
+	instance.transform                              = transform;
+	instance.instanceCustomIndex                    = customIndex;
+	instance.mask                                   = mask;
+	instance.instanceShaderBindingTableRecordOffset = 0;
+	instance.flags                                  = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
+	instance.accelerationStructureReference         = blas.deviceAddress;
+
+	m_Instances.emplace_back(instance);
+	m_NeedsRebuild             = true;
+	m_Statistics.instanceCount = static_cast<uint32_t>(m_Instances.size());
+
+	return m_Statistics.instanceCount - 1;
+}
+
+void TlasManager::SetTransform(uint32_t instance, const VkTransformMatrixKHR &transform) {
+	m_Instances.at(instance).transform = transform;
+	m_TransformsDirty                  = true;
+}
+
+bool TlasManager::Record(VkCommandBuffer commandBuffer, FrameRingBuffer &frameRing) {
+	if (!m_NeedsRebuild && !m_TransformsDirty)
+		return false;
+
+	// Host coherent, the submit of this command buffer makes the write visible to the build
+	const FrameAllocation instanceData{frameRing.WriteArray(
+	        std::span<const VkAccelerationStructureInstanceKHR>{m_Instances},
+	        FrameDataUsage::AccelerationStructureInput
+	)};
+
+	const bool rebuild{m_NeedsRebuild || m_RefitsSinceRebuild >= MAX_REFITS_BEFORE_REBUILD};
+
+	VkAccelerationStructureGeometryKHR geometry{};
+	geometry.sType        = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+	geometry.geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR;
+
+	VkAccelerationStructureGeometryInstancesDataKHR &instances{geometry.geometry.instances};
+	instances.sType              = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
+	instances.arrayOfPointers    = VK_FALSE;
+	instances.data.deviceAddress = instanceData.deviceAddress;
+
+	const VkBuildAccelerationStructureModeKHR mode{
+	        rebuild ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR : VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR
+	};
+
+	VkAccelerationStructureBuildGeometryInfoKHR buildInfo{GetBuildInfo(geometry, mode)};
+	buildInfo.srcAccelerationStructure  = rebuild ? VK_NULL_HANDLE : m_Tlas.handle;
+	buildInfo.dstAccelerationStructure  = m_Tlas.handle;
+	buildInfo.scratchData.deviceAddress = m_ScratchAddress;
+
+	VkAccelerationStructureBuildRangeInfoKHR range{};
+	range.primitiveCount = static_cast<uint32_t>(m_Instances.size());
+
+	const VkAccelerationStructureBuildRangeInfoKHR *pRange{&range};
+
+	// The previous frame may still be tracing against the TLAS, and its build used the same scratch memory
+	VkMemoryBarrier beforeBuildBarrier{};
+	beforeBuildBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	beforeBuildBarrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	beforeBuildBarrier.dstAccessMask =
+	        VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	vkCmdPipelineBarrier(
+	        commandBuffer,
+	        VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+	        VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &beforeBuildBarrier, 0, nullptr, 0, nullptr
+	);
+
+	m_pFunctions->vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &buildInfo, &pRange);
+
+	VkMemoryBarrier afterBuildBarrier{};
+	afterBuildBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	afterBuildBarrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	afterBuildBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+	vkCmdPipelineBarrier(
+	        commandBuffer, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+	        VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1,
+	        &afterBuildBarrier, 0, nullptr, 0, nullptr
+	);
+
+	if (rebuild) {
+		++m_Statistics.rebuildCount;
+		m_RefitsSinceRebuild = 0;
+	} else {
+		++m_Statistics.refitCount;
+		++m_RefitsSinceRebuild;
+	}
+
+	m_NeedsRebuild    = false;
+	m_TransformsDirty = false;
+
+	return true;
+}
+
+VkAccelerationStructureBuildGeometryInfoKHR TlasManager::GetBuildInfo(
+        const VkAccelerationStructureGeometryKHR &geometry, VkBuildAccelerationStructureModeKHR mode
+) {
+	VkAccelerationStructureBuildGeometryInfoKHR buildInfo{};
+	buildInfo.sType         = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+	buildInfo.type          = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
+	buildInfo.flags         = BUILD_FLAGS;
+	buildInfo.mode          = mode;
+	buildInfo.geometryCount = 1;
+	buildInfo.pGeometries   = &geometry;
+
+	return buildInfo;
+}
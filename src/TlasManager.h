@@ -0,0 +1,98 @@
+#ifndef PORTAL2RAYTRACED_TLASMANAGER_H
+#define PORTAL2RAYTRACED_TLASMANAGER_H
+
+#include "AccelerationStructure.h"
+#include "FrameRingBuffer.h"
+#include "MemoryAllocator.h"
+#include "RayTracingFunctions.h"
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+struct TlasStatistics {
+	uint32_t instanceCount{};
+	uint32_t rebuildCount{};
+	uint32_t refitCount{};
+};
+
+std::ostream &operator<<(std::ostream &ostream, const TlasStatistics &statistics);
+
+// Owns the scene's top-level acceleration structure. Instances live on the CPU and are copied into the frame's region
+// of the FrameRingBuffer whenever something changed. Transform-only changes are refitted in place, adding or
+// removing instances, or too many refits in a row, trigger a full rebuild. Builds are recorded into the frame's own
+// command buffer, so the CPU never waits on them.
+class TlasManager final {
+public:
+	TlasManager() = default;
+
+	TlasManager(const TlasManager &) = delete;
+
+	TlasManager &operator=(const TlasManager &) = delete;
+
+	void Init(
+	        VkPhysicalDevice physicalDevice, VkDevice device, MemoryAllocator &allocator,
+	        const RayTracingFunctions &functions, uint32_t maxInstanceCount
+	);
+
+	void Cleanup();
+
+	[[nodiscard]]
+	uint32_t AddInstance(
+	        const AccelerationStructure &blas, const VkTransformMatrixKHR &transform, uint32_t customIndex = 0,
+	        uint8_t mask = 0xFF
+	);
+
+	void SetTransform(uint32_t instance, const VkTransformMatrixKHR &transform);
+
+	// Builds or refits the TLAS if anything changed since the last frame. Has to be recorded outside of a render pass,
+	// after frameRing began this frame, which has to allow acceleration structure inputs. Returns whether it recorded
+	// a build, i.e. whether the scene rays see has changed.
+	bool Record(VkCommandBuffer commandBuffer, FrameRingBuffer &frameRing);
+
+	// Bytes Record takes from the frame ring at most
+	[[nodiscard]]
+	static VkDeviceSize GetFrameDataSize(uint32_t maxInstanceCount) noexcept {
+		return sizeof(VkAccelerationStructureInstanceKHR) * maxInstanceCount;
+	}
+
+	[[nodiscard]]
+	const AccelerationStructure &Get() const noexcept {
+		return m_Tlas;
+	}
+
+	[[nodiscard]]
+	const TlasStatistics &GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+
+private:
+	[[nodiscard]]
+	static VkAccelerationStructureBuildGeometryInfoKHR GetBuildInfo(
+	        const VkAccelerationStructureGeometryKHR &geometry, VkBuildAccelerationStructureModeKHR mode
+	);
+
+	// Refitting keeps the original tree topology, after this many refits it is rebuilt to restore trace performance
+	static constexpr uint32_t                             MAX_REFITS_BEFORE_REBUILD{120};
+	static constexpr VkBuildAccelerationStructureFlagsKHR BUILD_FLAGS{
+	        VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
+	        VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR
+	};
+
+	VkDevice                                        m_Device{};
+	MemoryAllocator                                *m_pAllocator{};
+	const RayTracingFunctions                      *m_pFunctions{};
+	uint32_t                                        m_MaxInstanceCount{};
+	std::vector<VkAccelerationStructureInstanceKHR> m_Instances{};
+	AccelerationStructure                           m_Tlas{};
+	VkBuffer                                        m_ScratchBuffer{};
+	Allocation                                      m_ScratchAllocation{};
+	VkDeviceAddress                                 m_ScratchAddress{};
+	bool                                            m_TransformsDirty{false};
+	bool                                            m_NeedsRebuild{true};
+	uint32_t                                        m_RefitsSinceRebuild{};
+	TlasStatistics                                  m_Statistics{};
+};
+
+
+#endif//PORTAL2RAYTRACED_TLASMANAGER_H
@@ -0,0 +1,338 @@
+#include "UploadManager.h"
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vulkan/vk_enum_string_helper.h>
+
+void UploadManager::Init(
+        VkDevice device, MemoryAllocator &allocator, uint32_t transferFamily, VkQueue transferQueue,
+        uint32_t graphicsFamily, VkQueue graphicsQueue
+) {
+	m_Device         = device;
+	m_pAllocator     = &allocator;
+	m_TransferFamily = transferFamily;
+	m_TransferQueue  = transferQueue;
+	m_GraphicsFamily = graphicsFamily;
+	m_GraphicsQueue  = graphicsQueue;
+
+	VkCommandPoolCreateInfo commandPoolCreateInfo{};
+	commandPoolCreateInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	commandPoolCreateInfo.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	commandPoolCreateInfo.queueFamilyIndex = m_TransferFamily;
+
+	if (const VkResult result{vkCreateCommandPool(m_Device, &commandPoolCreateInfo, nullptr, &m_TransferCommandPool)};
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to create transfer command pool: "} + string_VkResult(result)};
+	}
+
+	if (NeedsOwnershipTransfer()) {
+		commandPoolCreateInfo.queueFamilyIndex = m_GraphicsFamily;
+
+		if (const VkResult result{
+		            vkCreateCommandPool(m_Device, &commandPoolCreateInfo, nullptr, &m_GraphicsCommandPool)
+		    };
+		    result != VK_SUCCESS) {
+			throw std::runtime_error{
+			        std::string{"Failed to create upload acquire command pool: "} + string_VkResult(result)
+			};
+		}
+	}
+
+	VkSemaphoreTypeCreateInfo semaphoreTypeInfo{};
+	semaphoreTypeInfo.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	semaphoreTypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	semaphoreTypeInfo.initialValue  = 0;
+
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &semaphoreTypeInfo;
+
+	if (const VkResult result{vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &m_Timeline)};
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to create upload timeline semaphore: "} + string_VkResult(result)};
+	}
+}
+
+void UploadManager::Cleanup() {
+	if (m_NextTicket > 1)
+		Wait(m_NextTicket - 1);
+
+	CollectGarbage();
+	DestroyBatch(m_PendingBatch);
+	m_PendingCopies.clear();
+
+	vkDestroySemaphore(m_Device, m_Timeline, nullptr);
+
+	if (m_GraphicsCommandPool != VK_NULL_HANDLE)
+		vkDestroyCommandPool(m_Device, m_GraphicsCommandPool, nullptr);
+
+	vkDestroyCommandPool(m_Device, m_TransferCommandPool, nullptr);
+}
+
+UploadTicket UploadManager::Enqueue(
+        VkBuffer dstBuffer, VkDeviceSize dstOffset, const void *pData, VkDeviceSize size,
+        VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask
+) {
+	StagingBuffer staging{};
+	m_pAllocator->CreateBuffer(
+	        size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+	        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging.buffer,
+	        staging.allocation
+	);
+
+	memcpy(staging.allocation.pMapped, pData, size);
+
+	PendingCopy copy{};
+	copy.srcBuffer        = staging.buffer;
+	copy.dstBuffer        = dstBuffer;
+	copy.region.srcOffset = 0;
+	copy.region.dstOffset = dstOffset;
+	copy.region.size      = size;
+	copy.dstStageMask     = dstStageMask;
+	copy.dstAccessMask    = dstAccessMask;
+
+	m_PendingBatch.stagingBuffers.emplace_back(staging);
+	m_PendingCopies.emplace_back(copy);
+
+	return m_NextTicket;
+}
+
+UploadTicket UploadManager::Flush() {
+	if (m_PendingCopies.empty())
+		return m_NextTicket - 1;
+
+	Batch batch{std::move(m_PendingBatch)};
+	m_PendingBatch = {};
+	batch.ticket   = m_NextTicket++;
+
+	batch.transferCommandBuffer = BeginCommandBuffer(m_TransferCommandPool);
+	RecordTransfer(batch.transferCommandBuffer);
+
+	if (const VkResult result{vkEndCommandBuffer(batch.transferCommandBuffer)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to record upload command buffer: "} + string_VkResult(result)};
+	}
+
+	std::array<uint64_t, 1> signalValues{batch.ticket};
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+	timelineInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.signalSemaphoreValueCount = signalValues.size();
+	timelineInfo.pSignalSemaphoreValues    = signalValues.data();
+
+	VkSubmitInfo transferSubmitInfo{};
+	transferSubmitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	transferSubmitInfo.commandBufferCount = 1;
+	transferSubmitInfo.pCommandBuffers    = &batch.transferCommandBuffer;
+
+	if (!NeedsOwnershipTransfer()) {
+		transferSubmitInfo.pNext                = &timelineInfo;
+		transferSubmitInfo.signalSemaphoreCount = 1;
+		transferSubmitInfo.pSignalSemaphores    = &m_Timeline;
+
+		if (const VkResult result{vkQueueSubmit(m_TransferQueue, 1, &transferSubmitInfo, VK_NULL_HANDLE)};
+		    result != VK_SUCCESS) {
+			throw std::runtime_error{std::string{"Failed to submit upload batch: "} + string_VkResult(result)};
+		}
+	} else {
+		// The transfer queue releases the buffers, the graphics queue acquires them and then marks the ticket done
+		VkSemaphoreCreateInfo semaphoreInfo{};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+		if (const VkResult result{vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &batch.ownershipSemaphore)};
+		    result != VK_SUCCESS) {
+			throw std::runtime_error{
+			        std::string{"Failed to create upload ownership semaphore: "} + string_VkResult(result)
+			};
+		}
+
+		transferSubmitInfo.signalSemaphoreCount = 1;
+		transferSubmitInfo.pSignalSemaphores    = &batch.ownershipSemaphore;
+
+		if (const VkResult result{vkQueueSubmit(m_TransferQueue, 1, &transferSubmitInfo, VK_NULL_HANDLE)};
+		    result != VK_SUCCESS) {
+			throw std::runtime_error{std::string{"Failed to submit upload batch: "} + string_VkResult(result)};
+		}
+
+		batch.acquireCommandBuffer = BeginCommandBuffer(m_GraphicsCommandPool);
+		RecordAcquire(batch.acquireCommandBuffer);
+
+		if (const VkResult result{vkEndCommandBuffer(batch.acquireCommandBuffer)}; result != VK_SUCCESS) {
+			throw std::runtime_error{
+			        std::string{"Failed to record upload acquire command buffer: "} + string_VkResult(result)
+			};
+		}
+
+		std::array<uint64_t, 1>             waitValues{0};
+		std::array<VkPipelineStageFlags, 1> waitStages{VK_PIPELINE_STAGE_ALL_COMMANDS_BIT};
+		timelineInfo.waitSemaphoreValueCount = waitValues.size();
+		timelineInfo.pWaitSemaphoreValues    = waitValues.data();
+
+		VkSubmitInfo acquireSubmitInfo{};
+		acquireSubmitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		acquireSubmitInfo.pNext                = &timelineInfo;
+		acquireSubmitInfo.waitSemaphoreCount   = 1;
+		acquireSubmitInfo.pWaitSemaphores      = &batch.ownershipSemaphore;
+		acquireSubmitInfo.pWaitDstStageMask    = waitStages.data();
+		acquireSubmitInfo.commandBufferCount   = 1;
+		acquireSubmitInfo.pCommandBuffers      = &batch.acquireCommandBuffer;
+		acquireSubmitInfo.signalSemaphoreCount = 1;
+		acquireSubmitInfo.pSignalSemaphores    = &m_Timeline;
+
+		if (const VkResult result{vkQueueSubmit(m_GraphicsQueue, 1, &acquireSubmitInfo, VK_NULL_HANDLE)};
+		    result != VK_SUCCESS) {
+			throw std::runtime_error{std::string{"Failed to submit upload acquire: "} + string_VkResult(result)};
+		}
+	}
+
+	m_PendingCopies.clear();
+
+	const UploadTicket ticket{batch.ticket};
+	m_InFlightBatches.emplace_back(std::move(batch));
+
+	return ticket;
+}
+
+bool UploadManager::IsComplete(UploadTicket ticket) const {
+	uint64_t value{};
+	if (const VkResult result{vkGetSemaphoreCounterValue(m_Device, m_Timeline, &value)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to query upload progress: "} + string_VkResult(result)};
+	}
+
+	return value >= ticket;
+}
+
+void UploadManager::Wait(UploadTicket ticket) {
+	if (ticket >= m_NextTicket)
+		Flush();
+
+	VkSemaphoreWaitInfo waitInfo{};
+	waitInfo.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores    = &m_Timeline;
+	waitInfo.pValues        = &ticket;
+
+	if (const VkResult result{vkWaitSemaphores(m_Device, &waitInfo, UINT64_MAX)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to wait for upload: "} + string_VkResult(result)};
+	}
+}
+
+void UploadManager::CollectGarbage() {
+	uint64_t completedValue{};
+	if (const VkResult result{vkGetSemaphoreCounterValue(m_Device, m_Timeline, &completedValue)};
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to query upload progress: "} + string_VkResult(result)};
+	}
+
+	while (!m_InFlightBatches.empty() && m_InFlightBatches.front().ticket <= completedValue) {
+		DestroyBatch(m_InFlightBatches.front());
+		m_InFlightBatches.pop_front();
+	}
+}
+
+VkCommandBuffer UploadManager::BeginCommandBuffer(VkCommandPool commandPool) {
+	VkCommandBufferAllocateInfo allocateInfo{};
+	allocateInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocateInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandPool        = commandPool;
+	allocateInfo.commandBufferCount = 1;
+
+	VkCommandBuffer commandBuffer;
+	if (const VkResult result{vkAllocateCommandBuffers(m_Device, &allocateInfo, &commandBuffer)};
+	    result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to allocate upload command buffer: "} + string_VkResult(result)};
+	}
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	if (const VkResult result{vkBeginCommandBuffer(commandBuffer, &beginInfo)}; result != VK_SUCCESS) {
+		throw std::runtime_error{std::string{"Failed to begin upload command buffer: "} + string_VkResult(result)};
+	}
+
+	return commandBuffer;
+}
+
+void UploadManager::RecordTransfer(VkCommandBuffer commandBuffer) {
+	std::vector<VkBufferMemoryBarrier> barriers{};
+	barriers.reserve(m_PendingCopies.size());
+
+	VkPipelineStageFlags dstStageMask{};
+
+	for (const auto &copy: m_PendingCopies) {
+		vkCmdCopyBuffer(commandBuffer, copy.srcBuffer, copy.dstBuffer, 1, &copy.region);
+
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType         = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.buffer        = copy.dstBuffer;
+		barrier.offset        = copy.region.dstOffset;
+		barrier.size          = copy.region.size;
+
+		if (NeedsOwnershipTransfer()) {
+			// Release half of the queue family ownership transfer, dstAccessMask is ignored here
+			barrier.dstAccessMask       = 0;
+			barrier.srcQueueFamilyIndex = m_TransferFamily;
+			barrier.dstQueueFamilyIndex = m_GraphicsFamily;
+		} else {
+			barrier.dstAccessMask       = copy.dstAccessMask;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			dstStageMask |= copy.dstStageMask;
+		}
+
+		barriers.emplace_back(barrier);
+	}
+
+	if (NeedsOwnershipTransfer())
+		dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+
+	vkCmdPipelineBarrier(
+	        commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStageMask, 0, 0, nullptr, barriers.size(),
+	        barriers.data(), 0, nullptr
+	);
+}
+
+void UploadManager::RecordAcquire(VkCommandBuffer commandBuffer) {
+	std::vector<VkBufferMemoryBarrier> barriers{};
+	barriers.reserve(m_PendingCopies.size());
+
+	VkPipelineStageFlags dstStageMask{};
+
+	for (const auto &copy: m_PendingCopies) {
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcAccessMask       = 0;
+		barrier.dstAccessMask       = copy.dstAccessMask;
+		barrier.srcQueueFamilyIndex = m_TransferFamily;
+		barrier.dstQueueFamilyIndex = m_GraphicsFamily;
+		barrier.buffer              = copy.dstBuffer;
+		barrier.offset              = copy.region.dstOffset;
+		barrier.size                = copy.region.size;
+
+		dstStageMask |= copy.dstStageMask;
+		barriers.emplace_back(barrier);
+	}
+
+	vkCmdPipelineBarrier(
+	        commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dstStageMask, 0, 0, nullptr, barriers.size(),
+	        barriers.data(), 0, nullptr
+	);
+}
+
+void UploadManager::DestroyBatch(Batch &batch) {
+	for (auto &staging: batch.stagingBuffers) { m_pAllocator->DestroyBuffer(staging.buffer, staging.allocation); }
+	batch.stagingBuffers.clear();
+
+	if (batch.transferCommandBuffer != VK_NULL_HANDLE)
+		vkFreeCommandBuffers(m_Device, m_TransferCommandPool, 1, &batch.transferCommandBuffer);
+
+	if (batch.acquireCommandBuffer != VK_NULL_HANDLE)
+		vkFreeCommandBuffers(m_Device, m_GraphicsCommandPool, 1, &batch.acquireCommandBuffer);
+
+	if (batch.ownershipSemaphore != VK_NULL_HANDLE)
+		vkDestroySemaphore(m_Device, batch.ownershipSemaphore, nullptr);
+
+	batch = {};
+}
@@ -0,0 +1,112 @@
+#ifndef PORTAL2RAYTRACED_UPLOADMANAGER_H
+#define PORTAL2RAYTRACED_UPLOADMANAGER_H
+
+#include "MemoryAllocator.h"
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Value of the upload timeline semaphore that is reached once a batch has landed on the graphics queue.
+using UploadTicket = uint64_t;
+
+class UploadManager final {
+public:
+	UploadManager() = default;
+
+	UploadManager(const UploadManager &) = delete;
+
+	UploadManager &operator=(const UploadManager &) = delete;
+
+	void Init(
+	        VkDevice device, MemoryAllocator &allocator, uint32_t transferFamily, VkQueue transferQueue,
+	        uint32_t graphicsFamily, VkQueue graphicsQueue
+	);
+
+	void Cleanup();
+
+	// Copies `size` bytes into a staging buffer right away, the device copy is recorded on the next Flush.
+	// dstStageMask/dstAccessMask describe how the graphics queue will consume the buffer afterwards.
+	[[nodiscard]]
+	UploadTicket Enqueue(
+	        VkBuffer dstBuffer, VkDeviceSize dstOffset, const void *pData, VkDeviceSize size,
+	        VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask
+	);
+
+	// Submits everything enqueued so far as a single batch and returns its ticket.
+	UploadTicket Flush();
+
+	[[nodiscard]]
+	bool IsComplete(UploadTicket ticket) const;
+
+	void Wait(UploadTicket ticket);
+
+	// Ticket of the last Flush, 0 before the first one. Together with GetTimeline it lets a submission wait for the
+	// uploads on the GPU instead of the CPU.
+	[[nodiscard]]
+	UploadTicket GetLastTicket() const noexcept {
+		return m_NextTicket - 1;
+	}
+
+	[[nodiscard]]
+	VkSemaphore GetTimeline() const noexcept {
+		return m_Timeline;
+	}
+
+	// Releases the staging memory and command buffers of batches the GPU has finished with.
+	void CollectGarbage();
+
+private:
+	struct PendingCopy {
+		VkBuffer             srcBuffer{};
+		VkBuffer             dstBuffer{};
+		VkBufferCopy         region{};
+		VkPipelineStageFlags dstStageMask{};
+		VkAccessFlags        dstAccessMask{};
+	};
+
+	struct StagingBuffer {
+		VkBuffer   buffer{};
+		Allocation allocation{};
+	};
+
+	struct Batch {
+		UploadTicket               ticket{};
+		std::vector<StagingBuffer> stagingBuffers{};
+		VkCommandBuffer            transferCommandBuffer{};
+		VkCommandBuffer            acquireCommandBuffer{};
+		VkSemaphore                ownershipSemaphore{};
+	};
+
+	[[nodiscard]]
+	bool NeedsOwnershipTransfer() const noexcept {
+		return m_TransferFamily != m_GraphicsFamily;
+	}
+
+	[[nodiscard]]
+	VkCommandBuffer BeginCommandBuffer(VkCommandPool commandPool);
+
+	void RecordTransfer(VkCommandBuffer commandBuffer);
+
+	void RecordAcquire(VkCommandBuffer commandBuffer);
+
+	void DestroyBatch(Batch &batch);
+
+	VkDevice         m_Device{};
+	MemoryAllocator *m_pAllocator{};
+	uint32_t         m_TransferFamily{};
+	uint32_t         m_GraphicsFamily{};
+	VkQueue          m_TransferQueue{};
+	VkQueue          m_GraphicsQueue{};
+	VkCommandPool    m_TransferCommandPool{};
+	VkCommandPool    m_GraphicsCommandPool{};
+	VkSemaphore      m_Timeline{};
+
+	Batch                    m_PendingBatch{};
+	std::vector<PendingCopy> m_PendingCopies{};
+	std::deque<Batch>        m_InFlightBatches{};
+	UploadTicket             m_NextTicket{1};
+};
+
+
+#endif//PORTAL2RAYTRACED_UPLOADMANAGER_H
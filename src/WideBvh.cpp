@@ -0,0 +1,499 @@
+#include "WideBvh.h"
+#include "WideBvhTraversal.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <span>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PORTAL2RAYTRACED_X86_64
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// Defined in WideBvhAvx2.cpp, the only translation unit compiled with AVX2 enabled
+bool TraverseWideBvhAvx2(
+        const WideBvhNode *pNodes, const TriangleBlock *pBlocks, const Ray &ray, RayHit &hit, bool anyHit
+) noexcept;
+
+[[nodiscard]]
+bool IsWideBvhAvx2Compiled() noexcept;
+
+namespace {
+	class ScalarKernel final {
+	public:
+		explicit ScalarKernel(const Ray &ray)
+		    : m_Origin{ray.origin}
+		    , m_Direction{ray.direction}
+		    , m_InverseDirection{
+		              GetSafeInverse<ScalarKernel>(ray.direction.x), GetSafeInverse<ScalarKernel>(ray.direction.y),
+		              GetSafeInverse<ScalarKernel>(ray.direction.z)
+		      } {
+		}
+
+		uint32_t IntersectChildren(const WideBvhNode &node, float tMax, float *pDistances) const noexcept {
+			const bool nearIsMinX{m_InverseDirection.x >= 0.f};
+			const bool nearIsMinY{m_InverseDirection.y >= 0.f};
+			const bool nearIsMinZ{m_InverseDirection.z >= 0.f};
+
+			const float *const pNearX{nearIsMinX ? node.minX : node.maxX};
+			const float *const pNearY{nearIsMinY ? node.minY : node.maxY};
+			const float *const pNearZ{nearIsMinZ ? node.minZ : node.maxZ};
+			const float *const pFarX{nearIsMinX ? node.maxX : node.minX};
+			const float *const pFarY{nearIsMinY ? node.maxY : node.minY};
+			const float *const pFarZ{nearIsMinZ ? node.maxZ : node.minZ};
+
+			uint32_t mask{0};
+			for (uint32_t slot{0}; slot < WIDE_BVH_WIDTH; ++slot) {
+				const float nearX{(pNearX[slot] - m_Origin.x) * m_InverseDirection.x};
+				const float nearY{(pNearY[slot] - m_Origin.y) * m_InverseDirection.y};
+				const float nearZ{(pNearZ[slot] - m_Origin.z) * m_InverseDirection.z};
+				const float farX{(pFarX[slot] - m_Origin.x) * m_InverseDirection.x};
+				const float farY{(pFarY[slot] - m_Origin.y) * m_InverseDirection.y};
+				const float farZ{(pFarZ[slot] - m_Origin.z) * m_InverseDirection.z};
+
+				const float entry{std::max(std::max(nearX, nearY), std::max(nearZ, 0.f))};
+				const float exit{std::min(std::min(farX, farY), std::min(farZ, tMax))};
+
+				pDistances[slot] = entry;
+				if (entry <= exit)
+					mask |= 1u << slot;
+			}
+
+			return mask;
+		}
+
+		bool IntersectBlock(const TriangleBlock &block, const Ray &ray, RayHit &hit) const noexcept {
+			bool found{false};
+
+			for (uint32_t lane{0}; lane < WIDE_BVH_WIDTH; ++lane) {
+				const glm::vec3 edge1{block.edge1X[lane], block.edge1Y[lane], block.edge1Z[lane]};
+				const glm::vec3 edge2{block.edge2X[lane], block.edge2Y[lane], block.edge2Z[lane]};
+				const glm::vec3 p{glm::cross(m_Direction, edge2)};
+				const float     determinant{glm::dot(edge1, p)};
+
+				if (determinant > -DETERMINANT_EPSILON && determinant < DETERMINANT_EPSILON)
+					continue;
+
+				const float     inverseDeterminant{1.f / determinant};
+				const glm::vec3 s{m_Origin - glm::vec3{block.v0X[lane], block.v0Y[lane], block.v0Z[lane]}};
+				const float     u{glm::dot(s, p) * inverseDeterminant};
+				const glm::vec3 q{glm::cross(s, edge1)};
+				const float     v{glm::dot(m_Direction, q) * inverseDeterminant};
+				const float     distance{glm::dot(edge2, q) * inverseDeterminant};
+
+				if (u < 0.f || u > 1.f || v < 0.f || u + v > 1.f || distance <= ray.tMin || distance >= hit.distance)
+					continue;
+
+				hit.distance = distance;
+				hit.triangle = block.triangle[lane];
+				hit.u        = u;
+				hit.v        = v;
+				found        = true;
+			}
+
+			return found;
+		}
+
+	private:
+		static constexpr float DETERMINANT_EPSILON{1e-12f};
+
+		glm::vec3 m_Origin;
+		glm::vec3 m_Direction;
+		glm::vec3 m_InverseDirection;
+	};
+
+#ifdef PORTAL2RAYTRACED_X86_64
+	// SSE2 is part of x86-64 itself, so this kernel needs neither compiler flags nor a CPU check. Every node and
+	// block is processed as two halves of four lanes.
+	class Sse2Kernel final {
+	public:
+		explicit Sse2Kernel(const Ray &ray) {
+			const float inverseX{GetSafeInverse<Sse2Kernel>(ray.direction.x)};
+			const float inverseY{GetSafeInverse<Sse2Kernel>(ray.direction.y)};
+			const float inverseZ{GetSafeInverse<Sse2Kernel>(ray.direction.z)};
+
+			m_NearIsMinX = inverseX >= 0.f;
+			m_NearIsMinY = inverseY >= 0.f;
+			m_NearIsMinZ = inverseZ >= 0.f;
+
+			m_OriginX    = _mm_set1_ps(ray.origin.x);
+			m_OriginY    = _mm_set1_ps(ray.origin.y);
+			m_OriginZ    = _mm_set1_ps(ray.origin.z);
+			m_DirectionX = _mm_set1_ps(ray.direction.x);
+			m_DirectionY = _mm_set1_ps(ray.direction.y);
+			m_DirectionZ = _mm_set1_ps(ray.direction.z);
+			m_InverseX   = _mm_set1_ps(inverseX);
+			m_InverseY   = _mm_set1_ps(inverseY);
+			m_InverseZ   = _mm_set1_ps(inverseZ);
+		}
+
+		uint32_t IntersectChildren(const WideBvhNode &node, float tMax, float *pDistances) const noexcept {
+			const float *const pNearX{m_NearIsMinX ? node.minX : node.maxX};
+			const float *const pNearY{m_NearIsMinY ? node.minY : node.maxY};
+			const float *const pNearZ{m_NearIsMinZ ? node.minZ : node.maxZ};
+			const float *const pFarX{m_NearIsMinX ? node.maxX : node.minX};
+			const float *const pFarY{m_NearIsMinY ? node.maxY : node.minY};
+			const float *const pFarZ{m_NearIsMinZ ? node.maxZ : node.minZ};
+
+			const __m128 zero{_mm_setzero_ps()};
+			const __m128 maxDistance{_mm_set1_ps(tMax)};
+
+			uint32_t mask{0};
+			for (uint32_t half{0}; half < WIDE_BVH_WIDTH; half += 4) {
+				const __m128 nearX{_mm_mul_ps(_mm_sub_ps(_mm_load_ps(pNearX + half), m_OriginX), m_InverseX)};
+				const __m128 nearY{_mm_mul_ps(_mm_sub_ps(_mm_load_ps(pNearY + half), m_OriginY), m_InverseY)};
+				const __m128 nearZ{_mm_mul_ps(_mm_sub_ps(_mm_load_ps(pNearZ + half), m_OriginZ), m_InverseZ)};
+				const __m128 farX{_mm_mul_ps(_mm_sub_ps(_mm_load_ps(pFarX + half), m_OriginX), m_InverseX)};
+				const __m128 farY{_mm_mul_ps(_mm_sub_ps(_mm_load_ps(pFarY + half), m_OriginY), m_InverseY)};
+				const __m128 farZ{_mm_mul_ps(_mm_sub_ps(_mm_load_ps(pFarZ + half), m_OriginZ), m_InverseZ)};
+
+				const __m128 entry{_mm_max_ps(_mm_max_ps(nearX, nearY), _mm_max_ps(nearZ, zero))};
+				const __m128 exit{_mm_min_ps(_mm_min_ps(farX, farY), _mm_min_ps(farZ, maxDistance))};
+
+				_mm_storeu_ps(pDistances + half, entry);
+				mask |= static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(entry, exit))) << half;
+			}
+
+			return mask;
+		}
+
+		bool IntersectBlock(const TriangleBlock &block, const Ray &ray, RayHit &hit) const noexcept {
+			alignas(16) float distances[WIDE_BVH_WIDTH];
+			alignas(16) float us[WIDE_BVH_WIDTH];
+			alignas(16) float vs[WIDE_BVH_WIDTH];
+
+			const __m128 zero{_mm_setzero_ps()};
+			const __m128 one{_mm_set1_ps(1.f)};
+			const __m128 signMask{_mm_set1_ps(-0.f)};
+			const __m128 epsilon{_mm_set1_ps(DETERMINANT_EPSILON)};
+			const __m128 minDistance{_mm_set1_ps(ray.tMin)};
+			const __m128 maxDistance{_mm_set1_ps(hit.distance)};
+
+			uint32_t mask{0};
+			for (uint32_t half{0}; half < WIDE_BVH_WIDTH; half += 4) {
+				const __m128 edge1X{_mm_load_ps(block.edge1X + half)};
+				const __m128 edge1Y{_mm_load_ps(block.edge1Y + half)};
+				const __m128 edge1Z{_mm_load_ps(block.edge1Z + half)};
+				const __m128 edge2X{_mm_load_ps(block.edge2X + half)};
+				const __m128 edge2Y{_mm_load_ps(block.edge2Y + half)};
+				const __m128 edge2Z{_mm_load_ps(block.edge2Z + half)};
+
+				const __m128 pX{MultiplySubtract(m_DirectionY, edge2Z, m_DirectionZ, edge2Y)};
+				const __m128 pY{MultiplySubtract(m_DirectionZ, edge2X, m_DirectionX, edge2Z)};
+				const __m128 pZ{MultiplySubtract(m_DirectionX, edge2Y, m_DirectionY, edge2X)};
+				const __m128 determinant{Dot(edge1X, edge1Y, edge1Z, pX, pY, pZ)};
+				const __m128 inverseDeterminant{_mm_div_ps(one, determinant)};
+
+				const __m128 sX{_mm_sub_ps(m_OriginX, _mm_load_ps(block.v0X + half))};
+				const __m128 sY{_mm_sub_ps(m_OriginY, _mm_load_ps(block.v0Y + half))};
+				const __m128 sZ{_mm_sub_ps(m_OriginZ, _mm_load_ps(block.v0Z + half))};
+				const __m128 u{_mm_mul_ps(Dot(sX, sY, sZ, pX, pY, pZ), inverseDeterminant)};
+
+				const __m128 qX{MultiplySubtract(sY, edge1Z, sZ, edge1Y)};
+				const __m128 qY{MultiplySubtract(sZ, edge1X, sX, edge1Z)};
+				const __m128 qZ{MultiplySubtract(sX, edge1Y, sY, edge1X)};
+				const __m128 directionDotQ{Dot(m_DirectionX, m_DirectionY, m_DirectionZ, qX, qY, qZ)};
+				const __m128 v{_mm_mul_ps(directionDotQ, inverseDeterminant)};
+				const __m128 distance{_mm_mul_ps(Dot(edge2X, edge2Y, edge2Z, qX, qY, qZ), inverseDeterminant)};
+
+				__m128 valid{_mm_cmpge_ps(_mm_andnot_ps(signMask, determinant), epsilon)};
+				valid = _mm_and_ps(valid, _mm_cmpge_ps(u, zero));
+				valid = _mm_and_ps(valid, _mm_cmple_ps(u, one));
+				valid = _mm_and_ps(valid, _mm_cmpge_ps(v, zero));
+				valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u, v), one));
+				valid = _mm_and_ps(valid, _mm_cmpgt_ps(distance, minDistance));
+				valid = _mm_and_ps(valid, _mm_cmplt_ps(distance, maxDistance));
+
+				_mm_store_ps(distances + half, distance);
+				_mm_store_ps(us + half, u);
+				_mm_store_ps(vs + half, v);
+				mask |= static_cast<uint32_t>(_mm_movemask_ps(valid)) << half;
+			}
+
+			if (mask == 0)
+				return false;
+
+			for (uint32_t lane{0}; lane < WIDE_BVH_WIDTH; ++lane) {
+				if ((mask & 1u << lane) == 0 || distances[lane] >= hit.distance)
+					continue;
+
+				hit.distance = distances[lane];
+				hit.triangle = block.triangle[lane];
+				hit.u        = us[lane];
+				hit.v        = vs[lane];
+			}
+
+			return true;
+		}
+
+	private:
+		// a * b - c * d, one component of a cross product
+		[[nodiscard]]
+		static __m128 MultiplySubtract(__m128 a, __m128 b, __m128 c, __m128 d) noexcept {
+			return _mm_sub_ps(_mm_mul_ps(a, b), _mm_mul_ps(c, d));
+		}
+
+		[[nodiscard]]
+		static __m128 Dot(__m128 aX, __m128 aY, __m128 aZ, __m128 bX, __m128 bY, __m128 bZ) noexcept {
+			return _mm_add_ps(_mm_add_ps(_mm_mul_ps(aX, bX), _mm_mul_ps(aY, bY)), _mm_mul_ps(aZ, bZ));
+		}
+
+		static constexpr float DETERMINANT_EPSILON{1e-12f};
+
+		bool   m_NearIsMinX{};
+		bool   m_NearIsMinY{};
+		bool   m_NearIsMinZ{};
+		__m128 m_OriginX{};
+		__m128 m_OriginY{};
+		__m128 m_OriginZ{};
+		__m128 m_DirectionX{};
+		__m128 m_DirectionY{};
+		__m128 m_DirectionZ{};
+		__m128 m_InverseX{};
+		__m128 m_InverseY{};
+		__m128 m_InverseZ{};
+	};
+#endif
+
+	template<typename Kernel>
+	bool Traverse(
+	        const WideBvhNode *pNodes, const TriangleBlock *pBlocks, const Ray &ray, RayHit &hit, bool anyHit
+	) noexcept {
+		return anyHit ? TraverseWideBvh<Kernel, true>(pNodes, pBlocks, ray, hit)
+		              : TraverseWideBvh<Kernel, false>(pNodes, pBlocks, ray, hit);
+	}
+
+	[[nodiscard]]
+	float GetSurfaceArea(const BvhNode &node) noexcept {
+		const glm::vec3 extent{node.boundsMax - node.boundsMin};
+
+		return 2.f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+	}
+}// namespace
+
+std::ostream &operator<<(std::ostream &ostream, const WideBvhStatistics &statistics) {
+	return ostream << "Wide BVH: " << statistics.nodeCount << " nodes, " << statistics.blockCount
+	               << " triangle blocks (" << statistics.blockOccupancy * 100.0 << "% occupied) collapsed in "
+	               << statistics.buildMilliseconds << " ms, "
+	               << WideBvh::SIMD_LEVEL_NAMES[static_cast<size_t>(statistics.simdLevel)] << " kernels";
+}
+
+WideBvh::WideBvh() {
+	SetSimdLevel(SimdLevel::Avx2);
+}
+
+void WideBvh::Build(const Bvh &bvh) {
+	const auto buildStart{std::chrono::steady_clock::now()};
+
+	m_Nodes.clear();
+	m_Blocks.clear();
+
+	const std::span<const BvhNode> binaryNodes{bvh.GetNodes()};
+
+	if (!binaryNodes.empty()) {
+		// Children always come after their parent, so walking backwards visits them first
+		m_SubtreeTriangleCounts.resize(binaryNodes.size());
+		m_SubtreeFirstTriangles.resize(binaryNodes.size());
+		for (size_t i{binaryNodes.size()}; i-- > 0;) {
+			const BvhNode &node{binaryNodes[i]};
+
+			if (node.triangleCount > 0) {
+				m_SubtreeTriangleCounts[i] = node.triangleCount;
+				m_SubtreeFirstTriangles[i] = node.leftFirst;
+			} else {
+				m_SubtreeTriangleCounts[i] =
+				        m_SubtreeTriangleCounts[node.leftFirst] + m_SubtreeTriangleCounts[node.leftFirst + 1];
+				m_SubtreeFirstTriangles[i] = m_SubtreeFirstTriangles[node.leftFirst];
+			}
+		}
+
+		Collapse(bvh, 0);
+	}
+
+	m_SubtreeTriangleCounts = {};
+	m_SubtreeFirstTriangles = {};
+
+	const std::chrono::duration<double, std::milli> buildTime{std::chrono::steady_clock::now() - buildStart};
+	const size_t                                    laneCount{m_Blocks.size() * WIDE_BVH_WIDTH};
+
+	m_Statistics.nodeCount         = static_cast<uint32_t>(m_Nodes.size());
+	m_Statistics.blockCount        = static_cast<uint32_t>(m_Blocks.size());
+	m_Statistics.blockOccupancy    = laneCount == 0 ? 0.0 : static_cast<double>(bvh.GetTriangles().size()) / laneCount;
+	m_Statistics.buildMilliseconds = buildTime.count();
+}
+
+bool WideBvh::Intersect(const Ray &ray, RayHit &hit) const noexcept {
+	if (m_Nodes.empty())
+		return false;
+
+	return m_pTraverse(m_Nodes.data(), m_Blocks.data(), ray, hit, false);
+}
+
+bool WideBvh::IsOccluded(const Ray &ray) const noexcept {
+	if (m_Nodes.empty())
+		return false;
+
+	RayHit hit{};
+	return m_pTraverse(m_Nodes.data(), m_Blocks.data(), ray, hit, true);
+}
+
+SimdLevel WideBvh::SetSimdLevel(SimdLevel simdLevel) noexcept {
+	m_Statistics.simdLevel = std::min(simdLevel, DetectSimdLevel());
+	m_pTraverse            = GetTraverseFunction(m_Statistics.simdLevel);
+
+	return m_Statistics.simdLevel;
+}
+
+SimdLevel WideBvh::DetectSimdLevel() noexcept {
+#ifdef PORTAL2RAYTRACED_X86_64
+	if (!IsWideBvhAvx2Compiled())
+		return SimdLevel::Sse2;
+
+#ifdef _MSC_VER
+	std::array<int, 4> registers{};
+	__cpuid(registers.data(), 1);
+
+	// The OS has to save the YMM registers on context switches too, not just the CPU support them
+	const bool osSavesYmm{(registers[2] & 1 << 27) != 0 && (_xgetbv(0) & 0x6) == 0x6};
+	const bool fma{(registers[2] & 1 << 12) != 0};
+
+	__cpuidex(registers.data(), 7, 0);
+	const bool avx2{(registers[1] & 1 << 5) != 0};
+
+	return osSavesYmm && fma && avx2 ? SimdLevel::Avx2 : SimdLevel::Sse2;
+#else
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ? SimdLevel::Avx2 : SimdLevel::Sse2;
+#endif
+#else
+	return SimdLevel::Scalar;
+#endif
+}
+
+uint32_t WideBvh::Collapse(const Bvh &bvh, uint32_t binaryNode) {
+	const std::span<const BvhNode> binaryNodes{bvh.GetNodes()};
+
+	const auto nodeIndex{static_cast<uint32_t>(m_Nodes.size())};
+	m_Nodes.emplace_back();
+
+	// A binary leaf at the root still needs a wide node around it
+	std::array<uint32_t, WIDE_BVH_WIDTH> children{};
+	uint32_t                             childCount{0};
+	if (binaryNodes[binaryNode].triangleCount > 0) {
+		children[childCount++] = binaryNode;
+	} else {
+		children[childCount++] = binaryNodes[binaryNode].leftFirst;
+		children[childCount++] = binaryNodes[binaryNode].leftFirst + 1;
+	}
+
+	// Pull grandchildren up until the node is full, always opening the child with the largest surface area
+	const auto isOpenable{[&](uint32_t child) {
+		return binaryNodes[child].triangleCount == 0 && m_SubtreeTriangleCounts[child] > WIDE_BVH_WIDTH;
+	}};
+
+	while (childCount < WIDE_BVH_WIDTH) {
+		uint32_t bestSlot{WIDE_BVH_WIDTH};
+		float    bestArea{-1.f};
+		for (uint32_t slot{0}; slot < childCount; ++slot) {
+			if (isOpenable(children[slot]) && GetSurfaceArea(binaryNodes[children[slot]]) > bestArea) {
+				bestSlot = slot;
+				bestArea = GetSurfaceArea(binaryNodes[children[slot]]);
+			}
+		}
+
+		if (bestSlot == WIDE_BVH_WIDTH)
+			break;
+
+		const uint32_t opened{children[bestSlot]};
+		children[bestSlot]     = binaryNodes[opened].leftFirst;
+		children[childCount++] = binaryNodes[opened].leftFirst + 1;
+	}
+
+	for (uint32_t slot{0}; slot < WIDE_BVH_WIDTH; ++slot) {
+		WideBvhNode &node{m_Nodes[nodeIndex]};
+
+		if (slot >= childCount) {
+			node.minX[slot] = node.minY[slot] = node.minZ[slot] = std::numeric_limits<float>::infinity();
+			node.maxX[slot] = node.maxY[slot] = node.maxZ[slot] = -std::numeric_limits<float>::infinity();
+			node.child[slot]                                    = 0;
+			node.blockCount[slot]                               = 0;
+			continue;
+		}
+
+		const BvhNode &child{binaryNodes[children[slot]]};
+		node.minX[slot] = child.boundsMin.x;
+		node.minY[slot] = child.boundsMin.y;
+		node.minZ[slot] = child.boundsMin.z;
+		node.maxX[slot] = child.boundsMax.x;
+		node.maxY[slot] = child.boundsMax.y;
+		node.maxZ[slot] = child.boundsMax.z;
+
+		// Small subtrees become a single leaf, their triangles are contiguous and fit into one block
+		if (child.triangleCount > 0 || m_SubtreeTriangleCounts[children[slot]] <= WIDE_BVH_WIDTH) {
+			AddLeaf(bvh, children[slot], node, slot);
+			continue;
+		}
+
+		// Collapse grows m_Nodes, so node must not be used past this call
+		const uint32_t childNode{Collapse(bvh, children[slot])};
+		m_Nodes[nodeIndex].child[slot]      = childNode;
+		m_Nodes[nodeIndex].blockCount[slot] = 0;
+	}
+
+	return nodeIndex;
+}
+
+void WideBvh::AddLeaf(const Bvh &bvh, uint32_t binaryNode, WideBvhNode &node, uint32_t slot) {
+	const std::span<const BvhTriangle> triangles{bvh.GetTriangles()};
+	const std::span<const uint32_t>    triangleIndices{bvh.GetTriangleIndices()};
+
+	const uint32_t first{m_SubtreeFirstTriangles[binaryNode]};
+	const uint32_t count{m_SubtreeTriangleCounts[binaryNode]};
+
+	node.child[slot]      = static_cast<uint32_t>(m_Blocks.size());
+	node.blockCount[slot] = (count + WIDE_BVH_WIDTH - 1) / WIDE_BVH_WIDTH;
+
+	for (uint32_t blockStart{0}; blockStart < count; blockStart += WIDE_BVH_WIDTH) {
+		TriangleBlock &block{m_Blocks.emplace_back()};
+
+		for (uint32_t lane{0}; lane < WIDE_BVH_WIDTH; ++lane) {
+			if (blockStart + lane >= count) {
+				block.v0X[lane] = block.v0Y[lane] = block.v0Z[lane] = 0.f;
+				block.edge1X[lane] = block.edge1Y[lane] = block.edge1Z[lane] = 0.f;
+				block.edge2X[lane] = block.edge2Y[lane] = block.edge2Z[lane] = 0.f;
+				block.triangle[lane]                                         = std::numeric_limits<uint32_t>::max();
+				continue;
+			}
+
+			const BvhTriangle &triangle{triangles[first + blockStart + lane]};
+			const glm::vec3    edge1{triangle.v1 - triangle.v0};
+			const glm::vec3    edge2{triangle.v2 - triangle.v0};
+
+			block.v0X[lane]      = triangle.v0.x;
+			block.v0Y[lane]      = triangle.v0.y;
+			block.v0Z[lane]      = triangle.v0.z;
+			block.edge1X[lane]   = edge1.x;
+			block.edge1Y[lane]   = edge1.y;
+			block.edge1Z[lane]   = edge1.z;
+			block.edge2X[lane]   = edge2.x;
+			block.edge2Y[lane]   = edge2.y;
+			block.edge2Z[lane]   = edge2.z;
+			block.triangle[lane] = triangleIndices[first + blockStart + lane];
+		}
+	}
+}
+
+WideBvh::TraverseFunction WideBvh::GetTraverseFunction(SimdLevel simdLevel) noexcept {
+	switch (simdLevel) {
+#ifdef PORTAL2RAYTRACED_X86_64
+		case SimdLevel::Avx2:
+			return TraverseWideBvhAvx2;
+		case SimdLevel::Sse2:
+			return Traverse<Sse2Kernel>;
+#endif
+		default:
+			return Traverse<ScalarKernel>;
+	}
+}
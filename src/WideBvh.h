@@ -0,0 +1,116 @@
+#ifndef PORTAL2RAYTRACED_WIDEBVH_H
+#define PORTAL2RAYTRACED_WIDEBVH_H
+
+#include "Bvh.h"
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+static constexpr uint32_t WIDE_BVH_WIDTH{8};
+
+// Child bounds as structure of arrays, so one node is tested against a ray with a single pass of 8-wide (or two
+// 4-wide) SIMD operations. Plain arrays instead of std::array, the kernels load them straight into registers.
+// Leaf children have blockCount > 0 and reference blockCount triangle blocks starting at child, inner children have
+// blockCount 0 and child is a node index. Unused slots have inverted bounds, which no ray ever hits.
+struct alignas(32) WideBvhNode {
+	float    minX[WIDE_BVH_WIDTH];
+	float    minY[WIDE_BVH_WIDTH];
+	float    minZ[WIDE_BVH_WIDTH];
+	float    maxX[WIDE_BVH_WIDTH];
+	float    maxY[WIDE_BVH_WIDTH];
+	float    maxZ[WIDE_BVH_WIDTH];
+	uint32_t child[WIDE_BVH_WIDTH];
+	uint32_t blockCount[WIDE_BVH_WIDTH];
+};
+
+// Up to WIDE_BVH_WIDTH triangles as v0 plus both edges, what Möller-Trumbore needs. Padding lanes have zero edges,
+// which the determinant test always rejects.
+struct alignas(32) TriangleBlock {
+	float    v0X[WIDE_BVH_WIDTH];
+	float    v0Y[WIDE_BVH_WIDTH];
+	float    v0Z[WIDE_BVH_WIDTH];
+	float    edge1X[WIDE_BVH_WIDTH];
+	float    edge1Y[WIDE_BVH_WIDTH];
+	float    edge1Z[WIDE_BVH_WIDTH];
+	float    edge2X[WIDE_BVH_WIDTH];
+	float    edge2Y[WIDE_BVH_WIDTH];
+	float    edge2Z[WIDE_BVH_WIDTH];
+	uint32_t triangle[WIDE_BVH_WIDTH];
+};
+
+enum class SimdLevel {
+	Scalar,
+	Sse2,
+	Avx2
+};
+
+struct WideBvhStatistics {
+	uint32_t nodeCount{};
+	uint32_t blockCount{};
+	// Share of triangle block lanes holding an actual triangle
+	double    blockOccupancy{};
+	double    buildMilliseconds{};
+	SimdLevel simdLevel{SimdLevel::Scalar};
+};
+
+std::ostream &operator<<(std::ostream &ostream, const WideBvhStatistics &statistics);
+
+// 8-wide BVH collapsed from a binary SAH Bvh. Traversal picks the widest kernel the CPU supports at runtime, the
+// scalar kernel works everywhere and produces the same hits up to floating-point rounding. The AVX2 kernel's fused
+// multiply-adds round differently, so a ray grazing a box or triangle edge can go either way between the two.
+class WideBvh final {
+public:
+	WideBvh();
+
+	WideBvh(const WideBvh &) = delete;
+
+	WideBvh &operator=(const WideBvh &) = delete;
+
+	void Build(const Bvh &bvh);
+
+	// Same contract as Bvh::Intersect.
+	[[nodiscard]]
+	bool Intersect(const Ray &ray, RayHit &hit) const noexcept;
+
+	[[nodiscard]]
+	bool IsOccluded(const Ray &ray) const noexcept;
+
+	// Levels the CPU does not support fall back to the best one it does, returns the level actually used.
+	SimdLevel SetSimdLevel(SimdLevel simdLevel) noexcept;
+
+	[[nodiscard]]
+	const WideBvhStatistics &GetStatistics() const noexcept {
+		return m_Statistics;
+	}
+
+	[[nodiscard]]
+	static SimdLevel DetectSimdLevel() noexcept;
+
+	static constexpr std::array<std::string_view, 3> SIMD_LEVEL_NAMES{"scalar", "sse2", "avx2"};
+
+private:
+	using TraverseFunction = bool (*)(
+	        const WideBvhNode *pNodes, const TriangleBlock *pBlocks, const Ray &ray, RayHit &hit, bool anyHit
+	) noexcept;
+
+	// Returns the index of the wide node created for the binary node
+	uint32_t Collapse(const Bvh &bvh, uint32_t binaryNode);
+
+	void AddLeaf(const Bvh &bvh, uint32_t binaryNode, WideBvhNode &node, uint32_t slot);
+
+	[[nodiscard]]
+	static TraverseFunction GetTraverseFunction(SimdLevel simdLevel) noexcept;
+
+	std::vector<WideBvhNode>   m_Nodes{};
+	std::vector<TriangleBlock> m_Blocks{};
+	TraverseFunction           m_pTraverse{};
+	WideBvhStatistics          m_Statistics{};
+	// Per binary node, only needed while building
+	std::vector<uint32_t> m_SubtreeTriangleCounts{};
+	std::vector<uint32_t> m_SubtreeFirstTriangles{};
+};
+
+
+#endif//PORTAL2RAYTRACED_WIDEBVH_H
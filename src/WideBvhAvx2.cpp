@@ -0,0 +1,178 @@
+#include "WideBvhTraversal.h"
+
+// The only translation unit built with AVX2 and FMA enabled (see CMakeLists.txt). WideBvh only calls into it after
+// DetectSimdLevel confirmed the CPU supports both, nothing in here may be reachable from any other kernel.
+#ifdef __AVX2__
+#include <immintrin.h>
+
+namespace {
+	class Avx2Kernel final {
+	public:
+		explicit Avx2Kernel(const Ray &ray) {
+			const float inverseX{GetSafeInverse<Avx2Kernel>(ray.direction.x)};
+			const float inverseY{GetSafeInverse<Avx2Kernel>(ray.direction.y)};
+			const float inverseZ{GetSafeInverse<Avx2Kernel>(ray.direction.z)};
+
+			m_NearIsMinX = inverseX >= 0.f;
+			m_NearIsMinY = inverseY >= 0.f;
+			m_NearIsMinZ = inverseZ >= 0.f;
+
+			m_OriginX    = _mm256_set1_ps(ray.origin.x);
+			m_OriginY    = _mm256_set1_ps(ray.origin.y);
+			m_OriginZ    = _mm256_set1_ps(ray.origin.z);
+			m_DirectionX = _mm256_set1_ps(ray.direction.x);
+			m_DirectionY = _mm256_set1_ps(ray.direction.y);
+			m_DirectionZ = _mm256_set1_ps(ray.direction.z);
+			m_InverseX   = _mm256_set1_ps(inverseX);
+			m_InverseY   = _mm256_set1_ps(inverseY);
+			m_InverseZ   = _mm256_set1_ps(inverseZ);
+
+			// (plane - origin) * inverse as one fused plane * inverse - origin * inverse
+			m_ScaledOriginX = _mm256_set1_ps(ray.origin.x * inverseX);
+			m_ScaledOriginY = _mm256_set1_ps(ray.origin.y * inverseY);
+			m_ScaledOriginZ = _mm256_set1_ps(ray.origin.z * inverseZ);
+		}
+
+		uint32_t IntersectChildren(const WideBvhNode &node, float tMax, float *pDistances) const noexcept {
+			const __m256 nearX{_mm256_fmsub_ps(
+			        _mm256_load_ps(m_NearIsMinX ? node.minX : node.maxX), m_InverseX, m_ScaledOriginX
+			)};
+			const __m256 nearY{_mm256_fmsub_ps(
+			        _mm256_load_ps(m_NearIsMinY ? node.minY : node.maxY), m_InverseY, m_ScaledOriginY
+			)};
+			const __m256 nearZ{_mm256_fmsub_ps(
+			        _mm256_load_ps(m_NearIsMinZ ? node.minZ : node.maxZ), m_InverseZ, m_ScaledOriginZ
+			)};
+			const __m256 farX{_mm256_fmsub_ps(
+			        _mm256_load_ps(m_NearIsMinX ? node.maxX : node.minX), m_InverseX, m_ScaledOriginX
+			)};
+			const __m256 farY{_mm256_fmsub_ps(
+			        _mm256_load_ps(m_NearIsMinY ? node.maxY : node.minY), m_InverseY, m_ScaledOriginY
+			)};
+			const __m256 farZ{_mm256_fmsub_ps(
+			        _mm256_load_ps(m_NearIsMinZ ? node.maxZ : node.minZ), m_InverseZ, m_ScaledOriginZ
+			)};
+
+			const __m256 entry{_mm256_max_ps(_mm256_max_ps(nearX, nearY), _mm256_max_ps(nearZ, _mm256_setzero_ps()))};
+			const __m256 exit{_mm256_min_ps(_mm256_min_ps(farX, farY), _mm256_min_ps(farZ, _mm256_set1_ps(tMax)))};
+
+			_mm256_storeu_ps(pDistances, entry);
+
+			return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(entry, exit, _CMP_LE_OQ)));
+		}
+
+		bool IntersectBlock(const TriangleBlock &block, const Ray &ray, RayHit &hit) const noexcept {
+			const __m256 one{_mm256_set1_ps(1.f)};
+			const __m256 zero{_mm256_setzero_ps()};
+
+			const __m256 edge1X{_mm256_load_ps(block.edge1X)};
+			const __m256 edge1Y{_mm256_load_ps(block.edge1Y)};
+			const __m256 edge1Z{_mm256_load_ps(block.edge1Z)};
+			const __m256 edge2X{_mm256_load_ps(block.edge2X)};
+			const __m256 edge2Y{_mm256_load_ps(block.edge2Y)};
+			const __m256 edge2Z{_mm256_load_ps(block.edge2Z)};
+
+			const __m256 pX{MultiplySubtract(m_DirectionY, edge2Z, m_DirectionZ, edge2Y)};
+			const __m256 pY{MultiplySubtract(m_DirectionZ, edge2X, m_DirectionX, edge2Z)};
+			const __m256 pZ{MultiplySubtract(m_DirectionX, edge2Y, m_DirectionY, edge2X)};
+			const __m256 determinant{Dot(edge1X, edge1Y, edge1Z, pX, pY, pZ)};
+			const __m256 inverseDeterminant{_mm256_div_ps(one, determinant)};
+
+			const __m256 sX{_mm256_sub_ps(m_OriginX, _mm256_load_ps(block.v0X))};
+			const __m256 sY{_mm256_sub_ps(m_OriginY, _mm256_load_ps(block.v0Y))};
+			const __m256 sZ{_mm256_sub_ps(m_OriginZ, _mm256_load_ps(block.v0Z))};
+			const __m256 u{_mm256_mul_ps(Dot(sX, sY, sZ, pX, pY, pZ), inverseDeterminant)};
+
+			const __m256 qX{MultiplySubtract(sY, edge1Z, sZ, edge1Y)};
+			const __m256 qY{MultiplySubtract(sZ, edge1X, sX, edge1Z)};
+			const __m256 qZ{MultiplySubtract(sX, edge1Y, sY, edge1X)};
+			const __m256 directionDotQ{Dot(m_DirectionX, m_DirectionY, m_DirectionZ, qX, qY, qZ)};
+			const __m256 v{_mm256_mul_ps(directionDotQ, inverseDeterminant)};
+			const __m256 distance{_mm256_mul_ps(Dot(edge2X, edge2Y, edge2Z, qX, qY, qZ), inverseDeterminant)};
+
+			const __m256 absoluteDeterminant{_mm256_andnot_ps(_mm256_set1_ps(-0.f), determinant)};
+
+			__m256 valid{_mm256_cmp_ps(absoluteDeterminant, _mm256_set1_ps(DETERMINANT_EPSILON), _CMP_GE_OQ)};
+			valid = _mm256_and_ps(valid, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+			valid = _mm256_and_ps(valid, _mm256_cmp_ps(u, one, _CMP_LE_OQ));
+			valid = _mm256_and_ps(valid, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+			valid = _mm256_and_ps(valid, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+			valid = _mm256_and_ps(valid, _mm256_cmp_ps(distance, _mm256_set1_ps(ray.tMin), _CMP_GT_OQ));
+			valid = _mm256_and_ps(valid, _mm256_cmp_ps(distance, _mm256_set1_ps(hit.distance), _CMP_LT_OQ));
+
+			const auto mask{static_cast<uint32_t>(_mm256_movemask_ps(valid))};
+			if (mask == 0)
+				return false;
+
+			alignas(32) float distances[WIDE_BVH_WIDTH];
+			alignas(32) float us[WIDE_BVH_WIDTH];
+			alignas(32) float vs[WIDE_BVH_WIDTH];
+			_mm256_store_ps(distances, distance);
+			_mm256_store_ps(us, u);
+			_mm256_store_ps(vs, v);
+
+			for (uint32_t lane{0}; lane < WIDE_BVH_WIDTH; ++lane) {
+				if ((mask & 1u << lane) == 0 || distances[lane] >= hit.distance)
+					continue;
+
+				hit.distance = distances[lane];
+				hit.triangle = block.triangle[lane];
+				hit.u        = us[lane];
+				hit.v        = vs[lane];
+			}
+
+			return true;
+		}
+
+	private:
+		// a * b - c * d, one component of a cross product
+		[[nodiscard]]
+		static __m256 MultiplySubtract(__m256 a, __m256 b, __m256 c, __m256 d) noexcept {
+			return _mm256_fmsub_ps(a, b, _mm256_mul_ps(c, d));
+		}
+
+		[[nodiscard]]
+		static __m256 Dot(__m256 aX, __m256 aY, __m256 aZ, __m256 bX, __m256 bY, __m256 bZ) noexcept {
+			return _mm256_fmadd_ps(aX, bX, _mm256_fmadd_ps(aY, bY, _mm256_mul_ps(aZ, bZ)));
+		}
+
+		static constexpr float DETERMINANT_EPSILON{1e-12f};
+
+		bool   m_NearIsMinX{};
+		bool   m_NearIsMinY{};
+		bool   m_NearIsMinZ{};
+		__m256 m_OriginX{};
+		__m256 m_OriginY{};
+		__m256 m_OriginZ{};
+		__m256 m_DirectionX{};
+		__m256 m_DirectionY{};
+		__m256 m_DirectionZ{};
+		__m256 m_InverseX{};
+		__m256 m_InverseY{};
+		__m256 m_InverseZ{};
+		__m256 m_ScaledOriginX{};
+		__m256 m_ScaledOriginY{};
+		__m256 m_ScaledOriginZ{};
+	};
+}// namespace
+
+bool TraverseWideBvhAvx2(
+        const WideBvhNode *pNodes, const TriangleBlock *pBlocks, const Ray &ray, RayHit &hit, bool anyHit
+) noexcept {
+	return anyHit ? TraverseWideBvh<Avx2Kernel, true>(pNodes, pBlocks, ray, hit)
+	              : TraverseWideBvh<Avx2Kernel, false>(pNodes, pBlocks, ray, hit);
+}
+
+bool IsWideBvhAvx2Compiled() noexcept {
+	return true;
+}
+#else
+// Compiler or target without AVX2, DetectSimdLevel never reports it so this is never called
+bool TraverseWideBvhAvx2(const WideBvhNode *, const TriangleBlock *, const Ray &, RayHit &, bool) noexcept {
+	return false;
+}
+
+bool IsWideBvhAvx2Compiled() noexcept {
+	return false;
+}
+#endif
@@ -0,0 +1,102 @@
+#ifndef PORTAL2RAYTRACED_WIDEBVHTRAVERSAL_H
+#define PORTAL2RAYTRACED_WIDEBVHTRAVERSAL_H
+
+#include "WideBvh.h"
+#include <cstdint>
+
+// Shared by the WideBvh kernels only. Everything in here is a template over the kernel, so translation units built
+// with wider instruction sets never emit code another kernel could end up linked against.
+//
+// A kernel is constructed from the ray and provides
+//   uint32_t IntersectChildren(const WideBvhNode &node, float tMax, float *pDistances) const noexcept
+// returning a bit per child slot the ray enters before tMax, with the entry distance written to pDistances, and
+//   bool IntersectBlock(const TriangleBlock &block, const Ray &ray, RayHit &hit) const noexcept
+// which behaves like Bvh::IntersectTriangle for every lane of the block.
+
+// Zero direction components are nudged away from zero, so slab tests never compute 0 * inf. Kernels pick the near
+// slab by the sign of the result. Deliberately plain comparisons, the std math functions are not templates over the
+// kernel.
+template<typename Kernel>
+float GetSafeInverse(float component) noexcept {
+	constexpr float MIN_DIRECTION_COMPONENT{1e-30f};
+
+	if (component > MIN_DIRECTION_COMPONENT || component < -MIN_DIRECTION_COMPONENT)
+		return 1.f / component;
+
+	return component < 0.f ? -1.f / MIN_DIRECTION_COMPONENT : 1.f / MIN_DIRECTION_COMPONENT;
+}
+
+template<typename Kernel, bool AnyHit>
+bool TraverseWideBvh(const WideBvhNode *pNodes, const TriangleBlock *pBlocks, const Ray &ray, RayHit &hit) noexcept {
+	struct StackEntry {
+		uint32_t node;
+		float    distance;
+	};
+
+	// Every level pops one node and pushes at most all of its children
+	constexpr uint32_t STACK_SIZE{(WIDE_BVH_WIDTH - 1) * Bvh::MAX_DEPTH + 1};
+
+	const Kernel kernel{ray};
+
+	StackEntry stack[STACK_SIZE];
+	uint32_t   stackSize{0};
+	bool       found{false};
+
+	hit.distance       = ray.tMax;
+	stack[stackSize++] = StackEntry{0, 0.f};
+
+	while (stackSize > 0) {
+		const StackEntry entry{stack[--stackSize]};
+
+		// A closer hit has been found since this node was pushed
+		if (entry.distance > hit.distance)
+			continue;
+
+		const WideBvhNode &node{pNodes[entry.node]};
+
+		float          distances[WIDE_BVH_WIDTH];
+		const uint32_t mask{kernel.IntersectChildren(node, hit.distance, distances)};
+
+		StackEntry innerChildren[WIDE_BVH_WIDTH];
+		uint32_t   innerChildCount{0};
+
+		for (uint32_t slot{0}; slot < WIDE_BVH_WIDTH; ++slot) {
+			if ((mask & 1u << slot) == 0)
+				continue;
+
+			if (node.blockCount[slot] == 0) {
+				innerChildren[innerChildCount++] = StackEntry{node.child[slot], distances[slot]};
+				continue;
+			}
+
+			for (uint32_t block{node.child[slot]}; block < node.child[slot] + node.blockCount[slot]; ++block) {
+				if (!kernel.IntersectBlock(pBlocks[block], ray, hit))
+					continue;
+
+				found = true;
+
+				if constexpr (AnyHit)
+					return true;
+			}
+		}
+
+		// Insertion sort by descending distance, so the nearest child is pushed last and popped first
+		for (uint32_t i{1}; i < innerChildCount; ++i) {
+			const StackEntry child{innerChildren[i]};
+
+			uint32_t j{i};
+			for (; j > 0 && innerChildren[j - 1].distance < child.distance; --j) {
+				innerChildren[j] = innerChildren[j - 1];
+			}
+
+			innerChildren[j] = child;
+		}
+
+		for (uint32_t i{0}; i < innerChildCount; ++i) { stack[stackSize++] = innerChildren[i]; }
+	}
+
+	return found;
+}
+
+
+#endif//PORTAL2RAYTRACED_WIDEBVHTRAVERSAL_H
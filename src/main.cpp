@@ -1,10 +1,24 @@
 #include "Application.h"
 #include <iostream>
 
-int main() {
-	Application application{};
+int main(int argc, char **argv) {
+	ApplicationConfig config{};
 
 	try {
+		config = ApplicationConfig::Parse(argc, argv);
+	} catch (const std::invalid_argument &exception) {
+		std::cerr << exception.what() << '\n' << ApplicationConfig::USAGE;
+		return EXIT_FAILURE;
+	}
+
+	if (config.showHelp) {
+		std::cout << ApplicationConfig::USAGE;
+		return EXIT_SUCCESS;
+	}
+
+	// Loading the scene happens in the constructor, a missing or malformed file throws from there
+	try {
+		Application application{std::move(config)};
 		application.Run();
 	} catch (const std::exception &exception) {
 		std::cerr << exception.what() << '\n';
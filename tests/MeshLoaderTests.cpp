@@ -0,0 +1,255 @@
+#include "MeshLoader.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// OBJ and glTF parsing corner cases of MeshLoader, every case writes a small file into the temp directory and loads it.
+namespace {
+	// Throws with message unless condition holds, the runner reports it as the case's failure
+	void Expect(bool condition, std::string_view message) {
+		if (!condition)
+			throw std::runtime_error{std::string{message}};
+	}
+
+	// ctest may run several copies of the executable at once, so every file gets a name no other run picks
+	std::filesystem::path GetUniqueTempPath(std::string_view name, std::string_view extension) {
+		static const uint32_t        runId{std::random_device{}()};
+		static std::atomic<uint32_t> fileCounter{0};
+
+		return std::filesystem::temp_directory_path() /
+		       (std::string{name} + '_' + std::to_string(runId) + '_' + std::to_string(fileCounter++) +
+		        std::string{extension});
+	}
+
+	Scene LoadFile(ThreadPool &threadPool, std::string_view name, std::string_view extension, std::string_view bytes) {
+		const std::filesystem::path path{GetUniqueTempPath(name, extension)};
+		{
+			std::ofstream file{path, std::ios::binary};
+			file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+		}
+
+		MeshLoader loader{threadPool};
+		Scene      scene{};
+		try {
+			scene = loader.Load(path);
+		} catch (...) {
+			std::filesystem::remove(path);
+			throw;
+		}
+
+		std::filesystem::remove(path);
+		return scene;
+	}
+
+	Scene LoadObjText(ThreadPool &threadPool, std::string_view name, std::string_view text) {
+		return LoadFile(threadPool, name, ".obj", text);
+	}
+
+	void AppendUint32(std::string &bytes, uint32_t value) {
+		char encoded[sizeof(value)];
+		memcpy(encoded, &value, sizeof(value));
+		bytes.append(encoded, sizeof(encoded));
+	}
+
+	// Wraps json and binary into the two chunks of a .glb, both padded to four bytes as the format requires
+	Scene LoadGlb(ThreadPool &threadPool, std::string_view name, std::string json, std::string binary) {
+		json.resize((json.size() + 3) & ~size_t{3}, ' ');
+		binary.resize((binary.size() + 3) & ~size_t{3}, '\0');
+
+		std::string bytes{};
+		AppendUint32(bytes, 0x46546C67);// "glTF"
+		AppendUint32(bytes, 2);
+		AppendUint32(bytes, static_cast<uint32_t>(12 + 8 + json.size() + 8 + binary.size()));
+		AppendUint32(bytes, static_cast<uint32_t>(json.size()));
+		AppendUint32(bytes, 0x4E4F534A);// "JSON"
+		bytes += json;
+		AppendUint32(bytes, static_cast<uint32_t>(binary.size()));
+		AppendUint32(bytes, 0x004E4942);// "BIN\0"
+		bytes += binary;
+
+		return LoadFile(threadPool, name, ".glb", bytes);
+	}
+
+	// An OBJ with vertexCount vertices along the x axis and a single face using the first two and the last one
+	std::string MakeObjWithVertices(size_t vertexCount) {
+		std::string text{};
+		for (size_t i{0}; i < vertexCount; ++i) { text += "v " + std::to_string(i) + " 0 0\n"; }
+
+		return text + "f 1 2 " + std::to_string(vertexCount) + '\n';
+	}
+
+	void TestVertexW(ThreadPool &threadPool) {
+		const Scene scene{LoadObjText(
+		        threadPool, "mesh_loader_vertex_w",
+		        "v 0 0 0 1\n"
+		        "v 1 0 0 1.0\n"
+		        "v 0 1 0 0.5\n"
+		        "f 1 2 3\n"
+		)};
+
+		Expect(scene.vertices.size() == 3, "expected 3 vertices");
+		Expect(scene.GetStreams().GetIndexCount() == 3, "expected 1 triangle");
+	}
+
+	void TestVertexColors(ThreadPool &threadPool) {
+		const Scene scene{LoadObjText(
+		        threadPool, "mesh_loader_vertex_colors",
+		        "v 0 0 0 0.25 0.5 0.75\n"
+		        "v 1 0 0 0.25 0.5 0.75\n"
+		        "v 0 1 0 0.25 0.5 0.75\n"
+		        "f 1 2 3\n"
+		)};
+
+		Expect(scene.vertices.size() == 3, "expected 3 vertices");
+		Expect(scene.vertices[0].color.r == .25f && scene.vertices[0].color.g == .5f &&
+		               scene.vertices[0].color.b == .75f,
+		       "expected the vertex color to be kept");
+	}
+
+	void TestInlineComments(ThreadPool &threadPool) {
+		const Scene scene{LoadObjText(
+		        threadPool, "mesh_loader_inline_comments",
+		        "# a quad\n"
+		        "v 0 0 0 # corner\n"
+		        "v 1 0 0\n"
+		        "v 1 1 0\n"
+		        "v 0 1 0\n"
+		        "f 1 2 3 4 # becomes two triangles\n"
+		        "f 1 2 3#no space\n"
+		)};
+
+		Expect(scene.vertices.size() == 4, "expected 4 vertices");
+		Expect(scene.GetStreams().GetIndexCount() == 9, "expected 3 triangles");
+	}
+
+	// Every triangle keeps the first corner, winding is flipped for the raster pipeline, so a b c is stored as a c b
+	void TestPolygonFan(ThreadPool &threadPool) {
+		const Scene scene{LoadObjText(
+		        threadPool, "mesh_loader_polygon_fan",
+		        "v 0 0 0\n"
+		        "v 1 0 0\n"
+		        "v 2 1 0\n"
+		        "v 1 2 0\n"
+		        "v 0 1 0\n"
+		        "f 1 2 3 4 5\n"
+		)};
+
+		const std::vector<uint32_t> expected{0, 2, 1, 0, 3, 2, 0, 4, 3};
+		Expect(scene.GetStreams().GetIndexCount() == expected.size(), "expected the pentagon to become 3 triangles");
+		for (size_t i{0}; i < expected.size(); ++i) {
+			Expect(scene.GetStreams().GetIndex(i) == expected[i], "expected a fan around the first corner");
+		}
+	}
+
+	// Negative indices count back from the last vertex read before the face, not from the end of the file
+	void TestNegativeIndices(ThreadPool &threadPool) {
+		const Scene scene{LoadObjText(
+		        threadPool, "mesh_loader_negative_indices",
+		        "v 0 0 0\n"
+		        "v 1 0 0\n"
+		        "v 0 1 0\n"
+		        "f -3 -2 -1\n"
+		        "v 1 1 0\n"
+		        "f -3/1 -2//1 -1/1/1\n"
+		)};
+
+		const std::vector<uint32_t> expected{0, 2, 1, 1, 3, 2};
+		Expect(scene.GetStreams().GetIndexCount() == expected.size(), "expected 2 triangles");
+		for (size_t i{0}; i < expected.size(); ++i) {
+			Expect(scene.GetStreams().GetIndex(i) == expected[i], "expected negative indices relative to the face");
+		}
+	}
+
+	// 16-bit indices address exactly MAX_NARROW_VERTEX_COUNT vertices, one more needs 32-bit ones
+	void TestIndexPromotion(ThreadPool &threadPool) {
+		const Scene narrow{LoadObjText(
+		        threadPool, "mesh_loader_narrow_indices", MakeObjWithVertices(Scene::MAX_NARROW_VERTEX_COUNT)
+		)};
+		Expect(!narrow.GetStreams().HasWideIndices(), "expected 16-bit indices at the limit");
+		Expect(narrow.GetStreams().GetIndex(1) == Scene::MAX_NARROW_VERTEX_COUNT - 1,
+		       "expected the last vertex to be addressable");
+
+		const Scene wide{LoadObjText(
+		        threadPool, "mesh_loader_wide_indices", MakeObjWithVertices(Scene::MAX_NARROW_VERTEX_COUNT + 1)
+		)};
+		Expect(wide.GetStreams().HasWideIndices(), "expected 32-bit indices past the limit");
+		Expect(wide.indices.empty(), "expected the 16-bit indices to stay empty");
+		Expect(wide.GetStreams().GetIndex(1) == Scene::MAX_NARROW_VERTEX_COUNT,
+		       "expected the last vertex to be addressable");
+	}
+
+	// One triangle with 16-bit indices, placed twice by two nodes, so the second copy's indices are offset
+	void TestGlb(ThreadPool &threadPool) {
+		const float    positions[]{0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f, 0.f};
+		const uint16_t indices[]{0, 1, 2};
+
+		std::string binary(sizeof(positions) + sizeof(indices), '\0');
+		memcpy(binary.data(), positions, sizeof(positions));
+		memcpy(binary.data() + sizeof(positions), indices, sizeof(indices));
+
+		const Scene scene{LoadGlb(
+		        threadPool, "mesh_loader_glb",
+		        R"({"asset":{"version":"2.0"},"buffers":[{"byteLength":44}],)"
+		        R"("bufferViews":[{"buffer":0,"byteLength":36},{"buffer":0,"byteOffset":36,"byteLength":6}],)"
+		        R"("accessors":[{"bufferView":0,"componentType":5126,"count":3,"type":"VEC3"},)"
+		        R"({"bufferView":1,"componentType":5123,"count":3,"type":"SCALAR"}],)"
+		        R"("meshes":[{"primitives":[{"attributes":{"POSITION":0},"indices":1}]}],)"
+		        R"("nodes":[{"mesh":0},{"mesh":0,"translation":[2,0,0]}],"scenes":[{"nodes":[0,1]}]})",
+		        binary
+		)};
+
+		const std::vector<uint32_t> expected{0, 2, 1, 3, 5, 4};
+		Expect(scene.vertices.size() == 6, "expected both nodes to add their vertices");
+		Expect(!scene.GetStreams().HasWideIndices(), "expected 16-bit indices");
+		Expect(scene.GetStreams().GetIndexCount() == expected.size(), "expected 2 triangles");
+		for (size_t i{0}; i < expected.size(); ++i) {
+			Expect(scene.GetStreams().GetIndex(i) == expected[i], "expected the second node's indices to be offset");
+		}
+
+		// Fitting scales both copies alike, so the offset stays twice the triangle's width
+		const float width{scene.vertices[1].pos.x - scene.vertices[0].pos.x};
+		const float offset{scene.vertices[3].pos.x - scene.vertices[0].pos.x};
+		Expect(std::abs(offset - 2.f * width) < 1e-5f, "expected the node translation to be applied");
+	}
+}// namespace
+
+int main() {
+	ThreadPool threadPool{};
+
+	const std::vector<std::pair<std::string_view, std::function<void(ThreadPool &)>>> cases{
+	        {"vertex w", TestVertexW},
+	        {"vertex colors", TestVertexColors},
+	        {"inline comments", TestInlineComments},
+	        {"polygon fan", TestPolygonFan},
+	        {"negative indices", TestNegativeIndices},
+	        {"index promotion", TestIndexPromotion},
+	        {"glb", TestGlb},
+	};
+
+	int failures{0};
+	for (const auto &[name, test]: cases) {
+		try {
+			test(threadPool);
+			std::cout << "passed: " << name << '\n';
+		} catch (const std::exception &exception) {
+			std::cerr << "FAILED: " << name << ": " << exception.what() << '\n';
+			++failures;
+		}
+	}
+
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
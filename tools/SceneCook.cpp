@@ -0,0 +1,66 @@
+#include "CookedScene.h"
+#include "CpuRenderer.h"
+#include "MeshLoader.h"
+#include "Scene.h"
+#include "ThreadPool.h"
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Offline half of the cooked scene format: loads a scene the slow way once, builds the CPU renderer's BVH over it and
+// writes both into a file the application maps at startup instead.
+namespace {
+	constexpr std::string_view USAGE{
+	        "Usage: scene_cook <scene> <output>\n"
+	        "  <scene>     quad, instances, mesh or a .obj/.glb file\n"
+	        "  <output>    cooked scene to write, load it with --scene <output>\n"
+	};
+}// namespace
+
+int main(int argc, char **argv) {
+	if (argc == 2 && (std::string_view{argv[1]} == "--help" || std::string_view{argv[1]} == "-h")) {
+		std::cout << USAGE;
+		return EXIT_SUCCESS;
+	}
+
+	if (argc != 3) {
+		std::cerr << USAGE;
+		return EXIT_FAILURE;
+	}
+
+	const std::string_view      sceneName{argv[1]};
+	const std::filesystem::path outputPath{argv[2]};
+
+	if (!CookedScene::IsCookedSceneFile(outputPath)) {
+		std::cerr << "Output has to end in " << CookedScene::EXTENSION << ", the application picks the loader by it\n";
+		return EXIT_FAILURE;
+	}
+
+	try {
+		Scene scene{};
+		if (MeshLoader::IsMeshFile(sceneName)) {
+			ThreadPool threadPool{};
+			MeshLoader loader{threadPool};
+			scene = loader.Load(sceneName);
+
+			std::cout << loader.GetStatistics() << '\n';
+		} else {
+			scene = Scene::Create(sceneName);
+		}
+
+		Bvh bvh{};
+		bvh.Build(CpuRenderer::GetSceneTriangles(scene));
+		std::cout << bvh.GetStatistics() << '\n';
+
+		CookedScene::Write(outputPath, scene, bvh);
+		std::cout << CookedScene{outputPath}.GetStatistics() << '\n';
+	} catch (const std::exception &exception) {
+		std::cerr << exception.what() << '\n';
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}